@@ -0,0 +1,136 @@
+// Copyright (c) Meta Platforms, Inc. and affiliates.
+
+#include "AnimNode_TrackedHand.h"
+
+#include "Animation/AnimInstance.h"
+#include "Animation/AnimInstanceProxy.h"
+
+void FAnimNode_TrackedHand::Initialize_AnyThread(const FAnimationInitializeContext& Context)
+{
+	FAnimNode_Base::Initialize_AnyThread(Context);
+	Source.Initialize(Context);
+
+	CustomPoseWeight = 0.f;
+}
+
+void FAnimNode_TrackedHand::CacheBones_AnyThread(const FAnimationCacheBonesContext& Context)
+{
+	Source.CacheBones(Context);
+
+	// the required bones change with the LOD, so compact pose indices have to be resolved again
+	BuildRetargetPlan(Context.AnimInstanceProxy->GetRequiredBones());
+}
+
+void FAnimNode_TrackedHand::PreUpdate(const UAnimInstance* InAnimInstance)
+{
+	if (PoseProxy.IsValid())
+	{
+		return;
+	}
+
+	// the hand input creates its proxy in BeginPlay, keep looking until it does
+	if (auto const* Owner = InAnimInstance->GetOwningActor())
+	{
+		TInlineComponentArray<UCameraHandInput*> HandInputs(Owner);
+		for (auto const* HandInput : HandInputs)
+		{
+			if (HandInput->GetHand() == Hand && HandInput->GetPoseProxy().IsValid())
+			{
+				PoseProxy = HandInput->GetPoseProxy();
+				break;
+			}
+		}
+	}
+}
+
+void FAnimNode_TrackedHand::Update_AnyThread(const FAnimationUpdateContext& Context)
+{
+	GetEvaluateGraphExposedInputs().Execute(Context);
+	Source.Update(Context);
+
+	if (!PoseProxy.IsValid())
+	{
+		return;
+	}
+
+	PoseProxy->ReadPose(Pose);
+	if (PoseProxy->ReadBoneMap(BoneMap))
+	{
+		BuildRetargetPlan(Context.AnimInstanceProxy->GetRequiredBones());
+	}
+
+	auto const TargetWeight = Pose.bHasCustomGesture ? 1.f : 0.f;
+	CustomPoseWeight = CustomPoseBlendSpeed > 0.f
+		? FMath::FInterpConstantTo(CustomPoseWeight, TargetWeight, Context.GetDeltaTime(), CustomPoseBlendSpeed)
+		: TargetWeight;
+}
+
+void FAnimNode_TrackedHand::Evaluate_AnyThread(FPoseContext& Output)
+{
+	Source.Evaluate(Output);
+
+	if (Pose.Sequence == 0 || !FAnimWeight::IsRelevant(Alpha))
+	{
+		return;
+	}
+
+	for (auto const& Retarget : RetargetPlan)
+	{
+		auto Rotation = Pose.BoneRotations[Retarget.SourceBone];
+
+		// bones whose digit is masked out of the custom gesture stay tracked
+		auto const bIsCustomPosed = Retarget.DigitMask == 0 || (Retarget.DigitMask & ~Pose.DigitsMaskedFromCustomGesture) != 0;
+		if (bIsCustomPosed && CustomPoseWeight > 0.f)
+		{
+			Rotation = FQuat::Slerp(Rotation, Pose.CustomRotations[Retarget.SourceBone], CustomPoseWeight);
+		}
+
+		Rotation = Retarget.RotationOffset * Rotation;
+		Rotation.Normalize();
+
+		auto const Tracked = FTransform(Rotation, Retarget.Translation, Retarget.Scale);
+		auto& BoneTransform = Output.Pose[FCompactPoseBoneIndex(Retarget.BoneIndex)];
+		if (FAnimWeight::IsFullWeight(Alpha))
+		{
+			BoneTransform = Tracked;
+		}
+		else
+		{
+			BoneTransform.BlendWith(Tracked, Alpha);
+		}
+	}
+}
+
+void FAnimNode_TrackedHand::GatherDebugData(FNodeDebugData& DebugData)
+{
+	auto DebugLine = DebugData.GetNodeName(this);
+	DebugLine += FString::Printf(TEXT("(Sample: %d, Custom Pose: %.2f)"), Pose.Sequence, CustomPoseWeight);
+	DebugData.AddDebugItem(DebugLine);
+
+	Source.GatherDebugData(DebugData);
+}
+
+void FAnimNode_TrackedHand::BuildRetargetPlan(FBoneContainer const& RequiredBones)
+{
+	RetargetPlan.Reset(BoneMap.Mappings.Num());
+
+	auto const& RefSkeleton = RequiredBones.GetReferenceSkeleton();
+	for (auto const& BoneMapping : BoneMap.Mappings)
+	{
+		auto const MeshBoneIndex = RefSkeleton.FindBoneIndex(BoneMapping.BoneName);
+		if (MeshBoneIndex == INDEX_NONE)
+		{
+			continue;
+		}
+
+		// bones can be stripped by the current LOD
+		auto const CompactBoneIndex = RequiredBones.MakeCompactPoseIndex(FMeshPoseBoneIndex(MeshBoneIndex));
+		if (CompactBoneIndex == INDEX_NONE)
+		{
+			continue;
+		}
+
+		RetargetPlan.Add(UCameraHandInput::MakeBoneRetarget(BoneMapping, CompactBoneIndex.GetInt(), MeshBoneIndex == 0,
+			RequiredBones.GetRefPoseTransform(CompactBoneIndex), BoneMap.bIsLeft, BoneMap.bOpenXRRootFixup));
+	}
+}
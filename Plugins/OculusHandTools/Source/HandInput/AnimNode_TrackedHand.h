@@ -0,0 +1,59 @@
+// Copyright (c) Meta Platforms, Inc. and affiliates.
+
+#pragma once
+
+#include "Animation/AnimNodeBase.h"
+#include "CameraHandInput.h"
+#include "TrackedHandPoseProxy.h"
+
+#include "AnimNode_TrackedHand.generated.h"
+
+/**
+ * Poses a skeletal hand with the filtered bone rotations of the owner's CameraHandInput (with bPublishPoseForAnimGraph
+ * enabled), blending custom poses in and out. Runs during parallel animation evaluation, so the hand takes part in
+ * update rate optimizations and animation budgeting like any other animated mesh.
+ */
+USTRUCT(BlueprintInternalUseOnly)
+struct HANDINPUT_API FAnimNode_TrackedHand : public FAnimNode_Base
+{
+	GENERATED_BODY()
+
+	UPROPERTY(EditAnywhere, Category = Links)
+	FPoseLink Source;
+
+	/// which of the owner's CameraHandInput components to read the pose from
+	UPROPERTY(EditAnywhere, Category = "Tracked Hand")
+	EOculusXRHandType Hand = EOculusXRHandType::HandLeft;
+
+	/// how fast custom poses blend in and out (1/s), 0 to switch instantly
+	UPROPERTY(EditAnywhere, Category = "Tracked Hand", meta = (PinHiddenByDefault))
+	float CustomPoseBlendSpeed = 10.f;
+
+	UPROPERTY(EditAnywhere, Category = "Tracked Hand", meta = (PinShownByDefault))
+	float Alpha = 1.f;
+
+	// FAnimNode_Base
+	virtual void Initialize_AnyThread(const FAnimationInitializeContext& Context) override;
+	virtual void CacheBones_AnyThread(const FAnimationCacheBonesContext& Context) override;
+	virtual void Update_AnyThread(const FAnimationUpdateContext& Context) override;
+	virtual void Evaluate_AnyThread(FPoseContext& Output) override;
+	virtual void GatherDebugData(FNodeDebugData& DebugData) override;
+	virtual bool HasPreUpdate() const override { return true; }
+	virtual void PreUpdate(const UAnimInstance* InAnimInstance) override;
+	// ~FAnimNode_Base
+
+private:
+	void BuildRetargetPlan(FBoneContainer const& RequiredBones);
+
+	// found on the game thread in PreUpdate, only read from worker threads afterwards
+	TSharedPtr<FTrackedHandPoseProxy, ESPMode::ThreadSafe> PoseProxy;
+
+	// copies of the proxy data, owned by the animation worker
+	FTrackedHandPose Pose;
+	FTrackedHandBoneMap BoneMap;
+
+	// retarget steps indexed by compact pose bone index
+	TArray<FHandBoneRetarget> RetargetPlan;
+
+	float CustomPoseWeight = 0.f;
+};
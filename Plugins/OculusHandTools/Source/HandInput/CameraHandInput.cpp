@@ -5,9 +5,11 @@
 #include "OculusXRInputFunctionLibrary.h"
 #include "Components/PoseableMeshComponent.h"
 #include "HandPose.h"
+#include "HandPoseCache.h"
 #include "IXRTrackingSystem.h"
 #include "OculusXRHandComponent.h"
 #include "QuatUtil.h"
+#include "TrackedHandPoseProxy.h"
 
 #define ConvertBoneToFinger UOculusXRInputFunctionLibrary::ConvertBoneToFinger
 #define GetFingerTrackingConfidence UOculusXRInputFunctionLibrary::GetFingerTrackingConfidence
@@ -18,6 +20,42 @@ namespace {
 		const FName SystemName(TEXT("OpenXR"));
 		return GEngine->XRSystem.IsValid() && (GEngine->XRSystem->GetSystemName() == SystemName);
 	}
+
+	// the thumb and every finger, from the bone attached to the wrist to the tip
+	EOculusXRBone const PinchChainBones[5][5] =
+	{
+		{EOculusXRBone::Thumb_0, EOculusXRBone::Thumb_1, EOculusXRBone::Thumb_2, EOculusXRBone::Thumb_3, EOculusXRBone::Thumb_Tip},
+		{EOculusXRBone::Index_1, EOculusXRBone::Index_2, EOculusXRBone::Index_3, EOculusXRBone::Index_Tip, EOculusXRBone::Invalid},
+		{EOculusXRBone::Middle_1, EOculusXRBone::Middle_2, EOculusXRBone::Middle_3, EOculusXRBone::Middle_Tip, EOculusXRBone::Invalid},
+		{EOculusXRBone::Ring_1, EOculusXRBone::Ring_2, EOculusXRBone::Ring_3, EOculusXRBone::Ring_Tip, EOculusXRBone::Invalid},
+		{EOculusXRBone::Pinky_0, EOculusXRBone::Pinky_1, EOculusXRBone::Pinky_2, EOculusXRBone::Pinky_3, EOculusXRBone::Pinky_Tip},
+	};
+
+	ERecognizedBone ToRecognizedBone(EOculusXRBone Bone)
+	{
+		switch (Bone)
+		{
+		case EOculusXRBone::Wrist_Root: return Wrist;
+		case EOculusXRBone::Thumb_0: return Thumb_0;
+		case EOculusXRBone::Thumb_1: return Thumb_1;
+		case EOculusXRBone::Thumb_2: return Thumb_2;
+		case EOculusXRBone::Thumb_3: return Thumb_3;
+		case EOculusXRBone::Index_1: return Index_1;
+		case EOculusXRBone::Index_2: return Index_2;
+		case EOculusXRBone::Index_3: return Index_3;
+		case EOculusXRBone::Middle_1: return Middle_1;
+		case EOculusXRBone::Middle_2: return Middle_2;
+		case EOculusXRBone::Middle_3: return Middle_3;
+		case EOculusXRBone::Ring_1: return Ring_1;
+		case EOculusXRBone::Ring_2: return Ring_2;
+		case EOculusXRBone::Ring_3: return Ring_3;
+		case EOculusXRBone::Pinky_0: return Pinky_0;
+		case EOculusXRBone::Pinky_1: return Pinky_1;
+		case EOculusXRBone::Pinky_2: return Pinky_2;
+		case EOculusXRBone::Pinky_3: return Pinky_3;
+		default: return static_cast<ERecognizedBone>(-1);
+		}
+	}
 }
 
 UCameraHandInput::UCameraHandInput(FObjectInitializer const& ObjectInitializer)
@@ -35,20 +73,58 @@ UCameraHandInput::UCameraHandInput(FObjectInitializer const& ObjectInitializer)
 	{
 		Quat = FQuat::Identity;
 	}
+	for (auto& Quat : BoneSampleRotations)
+	{
+		Quat = FQuat::Identity;
+	}
+	for (auto& Quat : RawLocalSpaceRotations)
+	{
+		Quat = FQuat::Identity;
+	}
+	for (auto& Quat : CustomPoseRotations)
+	{
+		Quat = FQuat::Identity;
+	}
+	for (auto& bPosed : CustomPoseBones)
+	{
+		bPosed = false;
+	}
+	BuildPinchChains();
 	for (auto& Time : BoneLastFrozenTimes)
 	{
 		Time = -99999;
 	}
+	for (auto& Stamp : BoneCacheWorldStamps)
+	{
+		Stamp = -1;
+	}
 }
 
 void UCameraHandInput::BeginPlay()
 {
 	Super::BeginPlay();
+
+	InitializeAxes();
+
+	if (bPublishPoseForAnimGraph)
+	{
+		PoseProxy = MakeShared<FTrackedHandPoseProxy, ESPMode::ThreadSafe>();
+		bPoseProxyBoneMapDirty = true;
+	}
 }
 
 void UCameraHandInput::SetHand(EControllerHand InHand)
 {
 	Hand = InHand == EControllerHand::Left ? EOculusXRHandType::HandLeft : EOculusXRHandType::HandRight;
+
+	// the root fixup depends on the hand
+	if (HandMesh)
+	{
+		BuildBoneRetargetPlan(BoneMap, Hand == EOculusXRHandType::HandLeft, BoneRetargetPlan);
+		BuildPinchChains();
+	}
+	bPoseProxyBoneMapDirty = true;
+	AppliedCustomPoseId = FHandPoseId();
 }
 
 void UCameraHandInput::SetUpBoneMap(UPoseableMeshComponent* HandMesh, TArray<FHandBoneMapping>& BoneMap)
@@ -81,6 +157,41 @@ void UCameraHandInput::SetUpBoneMap(UPoseableMeshComponent* HandMesh, TArray<FHa
 	}
 }
 
+void UCameraHandInput::BuildBoneRetargetPlan(TArray<FHandBoneMapping> const& BoneMap, bool IsLeft, TArray<FHandBoneRetarget>& Plan)
+{
+	// the XR system doesn't change at runtime, so resolve the root fixup once instead of per bone and frame
+	auto const bIsOpenXR = IsOpenXRSystem();
+
+	Plan.Reset(BoneMap.Num());
+	for (auto const& BoneMapping : BoneMap)
+	{
+		if (BoneMapping.BoneId < 0)
+		{
+			continue;
+		}
+
+		Plan.Add(MakeBoneRetarget(BoneMapping, BoneMapping.BoneId, BoneMapping.BoneId == 0, BoneMapping.ReferenceTransform,
+			IsLeft, bIsOpenXR));
+	}
+}
+
+FHandBoneRetarget UCameraHandInput::MakeBoneRetarget(FHandBoneMapping const& BoneMapping, int32 BoneIndex, bool bIsRootBone,
+	FTransform const& ReferenceTransform, bool IsLeft, bool bOpenXRRootFixup)
+{
+	FHandBoneRetarget Retarget;
+	Retarget.BoneIndex = BoneIndex;
+	Retarget.SourceBone = BoneMapping.MappedBone;
+	Retarget.RotationOffset = bOpenXRRootFixup && bIsRootBone
+		? (IsLeft ? LeftHandRootFixupRotationOpenXR : RightHandRootFixupRotationOpenXR)
+		: BoneMapping.RotationOffset;
+	Retarget.Translation = BoneMapping.MappedBone == EOculusXRBone::Wrist_Root
+		? FVector::ZeroVector
+		: ReferenceTransform.GetTranslation();
+	Retarget.Scale = ReferenceTransform.GetScale3D();
+	Retarget.DigitMask = static_cast<uint8>(BoneMapping.Digit);
+	return Retarget;
+}
+
 void UCameraHandInput::SetPoseableMeshComponent(UPoseableMeshComponent* PoseableMeshComponent)
 {
 	HandMesh = PoseableMeshComponent;
@@ -90,6 +201,10 @@ void UCameraHandInput::SetPoseableMeshComponent(UPoseableMeshComponent* Poseable
 		TEXT("SetPoseableMeshComponent failed")))
 	{
 		SetUpBoneMap(HandMesh, BoneMap);
+		BuildBoneRetargetPlan(BoneMap, GetHand() == EOculusXRHandType::HandLeft, BoneRetargetPlan);
+		BuildPinchChains();
+		AppliedCustomPoseId = FHandPoseId();
+		++BonePoseSequence;
 		GripBoneId = HandMesh->GetSkinnedAsset()->GetRefSkeleton().FindBoneIndex(GripBoneName);
 		OnInitializeMesh.Broadcast(this);
 	}
@@ -146,20 +261,36 @@ void UCameraHandInput::TickComponent(float DeltaTime, ELevelTick TickType,
 		return;
 	}
 
+	// the mesh refreshes its component-space transforms once per frame, so only the rotations written before this
+	// tick are visible in them
+	auto const VisibleBonePoseSequence = BonePoseSequence;
+
 	UpdateTracking();
+	ReadTrackingSample();
+	// the axes only depend on the raw skeleton and their ranges, so they can't change without a new sample or new ranges
+	auto const bAxisRangesChanged = UpdateAxisRanges();
+	if (bHasNewTrackingSample || bAxisRangesChanged)
+	{
+		UpdateAxes();
+	}
 	UpdateSkeleton();
 	if (bAlwaysUpdateGrab || IsTracked())
 	{
 		UpdateGrabInput();
 	}
-	UpdatePointingInput();
+	if (bPredictRelease && bHasNewTrackingSample)
+	{
+		UpdateReleasePrediction();
+	}
+	// pointing reads the pointing axis, so like the axes it only changes with a new sample or new ranges
+	if (bHasNewTrackingSample || bAxisRangesChanged)
+	{
+		UpdatePointingInput();
+	}
 
 	if (HandMesh)
 	{
-		for (auto&& BoneMapping : BoneMap)
-		{
-			BoneCache[BoneMapping.MappedBone] = HandMesh->GetSocketTransform(BoneMapping.BoneName);
-		}
+		UpdateBoneCache(VisibleBonePoseSequence);
 	}
 
 	/*
@@ -193,6 +324,7 @@ void UCameraHandInput::FilterBoneRotation(EOculusXRBone Bone, FQuat LastRotation
 	auto& LastFrozenTime = BoneLastFrozenTimes[Bone];
 
 	auto& LastVelocity = BoneVelocities[Bone];
+	auto& LastSampleRotation = BoneSampleRotations[Bone];
 	auto const Finger = ConvertBoneToFinger(Bone);
 
 	auto const ActualAngularDistance = LastRotation.AngularDistance(Rotation);
@@ -219,46 +351,99 @@ void UCameraHandInput::FilterBoneRotation(EOculusXRBone Bone, FQuat LastRotation
 			Rotation = Scale(LastVelocity, DeltaSeconds) * LastRotation;
 			LastVelocity = Scale(LastVelocity, BoneVelocityDamping);
 		}
-		else
+		else if (bHasNewTrackingSample && TrackingSampleDeltaTime > 0)
 		{
-			LastVelocity = Scale(Rotation * LastRotation.Inverse(), 1.0f / DeltaSeconds);
+			// measure the velocity between samples, frames without a new sample would read as a stopped bone
+			LastVelocity = Scale(Rotation * LastSampleRotation.Inverse(), 1.0f / TrackingSampleDeltaTime);
 		}
 	}
+
+	if (bHasNewTrackingSample)
+	{
+		LastSampleRotation = Rotation;
+	}
 }
 
-void UCameraHandInput::SetBoneRotation(UPoseableMeshComponent* HandMesh, FHandBoneMapping BoneMapping,
-	FQuat BoneRotation, bool IsLeft)
+void UCameraHandInput::ApplyBoneRetarget(FHandBoneRetarget const& Retarget, FQuat const& BoneRotation,
+	TArray<FTransform>& BoneSpaceTransforms)
 {
-	if (BoneMapping.BoneId == -1 || HandMesh == nullptr || HandMesh->BoneSpaceTransforms.Num() <= BoneMapping.BoneId)
+	if (!BoneSpaceTransforms.IsValidIndex(Retarget.BoneIndex))
 	{
 		return;
 	}
-	if (IsOpenXRSystem() && BoneMapping.BoneId == 0)
+
+	auto Rotation = Retarget.RotationOffset * BoneRotation;
+	Rotation.Normalize();
+	BoneSpaceTransforms[Retarget.BoneIndex] = FTransform(Rotation, Retarget.Translation, Retarget.Scale);
+}
+
+void UCameraHandInput::ReadTrackingSample()
+{
+	// the runtime hands back identical bone data until it has produced a new sample
+	bHasNewTrackingSample = false;
+	for (auto Index = 0; Index != static_cast<int>(EOculusXRBone::Bone_Max); Index += 1)
+	{
+		auto const Bone = static_cast<EOculusXRBone>(Index);
+		auto const Rotation = UOculusXRInputFunctionLibrary::GetBoneRotation(Hand, Bone);
+		if (Rotation != RawLocalSpaceRotations[Bone])
+		{
+			RawLocalSpaceRotations[Bone] = Rotation;
+			bHasNewTrackingSample = true;
+		}
+	}
+
+	if (bHasNewTrackingSample)
 	{
-		BoneMapping.RotationOffset = IsLeft ? LeftHandRootFixupRotationOpenXR : RightHandRootFixupRotationOpenXR;
+		auto const Now = GetWorld()->GetTimeSeconds();
+		TrackingSampleDeltaTime = LastTrackingSampleTime < 0 ? 0 : Now - LastTrackingSampleTime;
+		LastTrackingSampleTime = Now;
+		++TrackingSampleSequence;
 	}
-	
-	BoneRotation = BoneMapping.RotationOffset * BoneRotation;
-	BoneRotation.Normalize();
-	HandMesh->BoneSpaceTransforms[BoneMapping.BoneId] = FTransform(
-		BoneRotation,
-		BoneMapping.ReferenceTransform.GetTranslation(),
-		BoneMapping.ReferenceTransform.GetScale3D());
+}
+
+void UCameraHandInput::UpdateBoneCache(int32 PoseSequence)
+{
+	// the hand moves every frame, so world-space transforms are always invalidated
+	BoneCacheComponentToWorld = HandMesh->GetComponentTransform();
+	++BoneCacheWorldStamp;
+
+	if (PoseSequence == BoneCachePoseSequence)
+	{
+		return;
+	}
+	BoneCachePoseSequence = PoseSequence;
+
+	auto const& ComponentSpaceTransforms = HandMesh->GetComponentSpaceTransforms();
+	for (auto const& BoneMapping : BoneMap)
+	{
+		if (ComponentSpaceTransforms.IsValidIndex(BoneMapping.BoneId))
+		{
+			BoneCache[BoneMapping.MappedBone] = ComponentSpaceTransforms[BoneMapping.BoneId];
+		}
+	}
+	++BoneCacheSequence;
+}
 
-	if (BoneMapping.MappedBone == EOculusXRBone::Wrist_Root)
+FTransform UCameraHandInput::GetBoneTransformWorld(EOculusXRBone Bone)
+{
+	auto& Stamp = BoneCacheWorldStamps[Bone];
+	if (Stamp != BoneCacheWorldStamp)
 	{
-		HandMesh->BoneSpaceTransforms[BoneMapping.BoneId].SetLocation(FVector::ZeroVector);
+		BoneCacheWorld[Bone] = BoneCache[Bone] * BoneCacheComponentToWorld;
+		Stamp = BoneCacheWorldStamp;
 	}
+	return BoneCacheWorld[Bone];
 }
 
 void UCameraHandInput::UpdateSkeleton()
 {
-	if (!HandMesh)
+	if (!HandMesh && !PoseProxy)
 	{
 		return;
 	}
 
 	auto const bHasCustomGestureThisFrame = bHasCustomGesture;
+	auto bCustomGestureEndedThisFrame = false;
 	if (bHasCustomGesture)
 	{
 		// custom gestures have to be applied every frame, so reset the flag here
@@ -268,73 +453,96 @@ void UCameraHandInput::UpdateSkeleton()
 	else if (bHadCustomGestureLastFrame)
 	{
 		// reset the grip bone
-		auto&& Pose = HandMesh->GetSkinnedAsset()->GetRefSkeleton().GetRefBonePose();
-		if (ensureMsgf(Pose.IsValidIndex(GripBoneId), TEXT("GripBoneId is %i"), GripBoneId))
+		if (HandMesh)
 		{
-			HandMesh->BoneSpaceTransforms[GripBoneId] = Pose[GripBoneId];
+			auto&& Pose = HandMesh->GetSkinnedAsset()->GetRefSkeleton().GetRefBonePose();
+			if (ensureMsgf(Pose.IsValidIndex(GripBoneId), TEXT("GripBoneId is %i"), GripBoneId))
+			{
+				HandMesh->BoneSpaceTransforms[GripBoneId] = Pose[GripBoneId];
+			}
 		}
 		bHadCustomGestureLastFrame = false;
+		bCustomGestureEndedThisFrame = true;
 	}
 
+	// pinching releases held objects, so it is detected from the raw skeleton even when a custom gesture drives the hand
+	if (bUseSkeletonPinch && bHasNewTrackingSample)
+	{
+		UpdateSkeletonPinch();
+	}
+
+	// the raw bone rotations were already read by ReadTrackingSample, since we need them for gesture detection
+	// (eg. dropping) even when a custom gesture drives the whole hand
 	if (bHasCustomGestureThisFrame && DigitsMaskedFromCustomGesture == 0)
 	{
-		// get the bone rotations anyway, since we need them for gesture detection (eg. dropping)
-		for (auto Index = 0; Index != static_cast<int>(EOculusXRBone::Bone_Max); Index += 1)
+		if (PoseProxy)
 		{
-			auto const Bone = static_cast<EOculusXRBone>(Index);
-			auto const Rotation = UOculusXRInputFunctionLibrary::GetBoneRotation(Hand, Bone);
-			RawLocalSpaceRotations[Bone] = Rotation;
+			PublishPose(true);
 		}
-
 		return;
 	}
 
 	// Update finger rotations
+	auto bBonesChanged = false;
 	for (auto Index = 0; Index != static_cast<int>(EOculusXRBone::Bone_Max); Index += 1)
 	{
 		auto const Bone = static_cast<EOculusXRBone>(Index);
 		auto& LastRotation = BoneRotations[Bone];
-		auto Rotation = UOculusXRInputFunctionLibrary::GetBoneRotation(Hand, Bone);
-		RawLocalSpaceRotations[Bone] = Rotation;
+		auto Rotation = RawLocalSpaceRotations[Bone];
 		if (bBoneRotationFilteringEnabled)
 		{
 			FilterBoneRotation(Bone, LastRotation, Rotation);
 		}
+		bBonesChanged |= Rotation != LastRotation;
 		LastRotation = Rotation;
 	}
 
-	for (auto BoneMapping : BoneMap)
+	// without a new sample, a settled filter and no custom gesture the mesh already shows these rotations
+	if (bBonesChanged || bHasCustomGestureThisFrame || bCustomGestureEndedThisFrame)
 	{
-		if (BoneMapping.BoneId >= 0)
+		if (HandMesh)
 		{
-			// skip updating if we're in a custom gesture and the bone's digit isn't masked out
-			if (bHasCustomGestureThisFrame)
-			{
-				if (BoneMapping.Digit == EHandDigit::None)
-				{
-					continue;
-				}
-				if ((static_cast<uint8>(BoneMapping.Digit) & DigitsMaskedFromCustomGesture) != static_cast<uint8>(BoneMapping.Digit))
-				{
-					continue;
-				}
-			}
-
-			auto const BoneRotation = BoneRotations[BoneMapping.MappedBone];
-			
-			SetBoneRotation(HandMesh, BoneMapping, BoneRotation, GetHand() == EOculusXRHandType::HandLeft);
+			WriteBoneRotations(bHasCustomGestureThisFrame);
+		}
+		if (PoseProxy)
+		{
+			PublishPose(bHasCustomGestureThisFrame);
 		}
 	}
 
-	HandMesh->MarkRefreshTransformDirty();
-
-	if (bDynamicScalingEnabled)
+	if (HandMesh && bDynamicScalingEnabled)
 	{
 		auto const Scale = UOculusXRInputFunctionLibrary::GetHandScale(Hand);
 		HandMesh->SetRelativeScale3D(FVector(Scale));
 	}
 }
 
+void UCameraHandInput::WriteBoneRotations(bool bHasCustomGestureThisFrame)
+{
+	auto& BoneSpaceTransforms = HandMesh->BoneSpaceTransforms;
+	if (bHasCustomGestureThisFrame)
+	{
+		// only update the bones whose digit is masked out of the custom gesture
+		for (auto const& Retarget : BoneRetargetPlan)
+		{
+			if (Retarget.DigitMask != 0 && (Retarget.DigitMask & ~DigitsMaskedFromCustomGesture) == 0)
+			{
+				ApplyBoneRetarget(Retarget, BoneRotations[Retarget.SourceBone], BoneSpaceTransforms);
+			}
+		}
+	}
+	else
+	{
+		for (auto const& Retarget : BoneRetargetPlan)
+		{
+			ApplyBoneRetarget(Retarget, BoneRotations[Retarget.SourceBone], BoneSpaceTransforms);
+		}
+	}
+
+	HandMesh->MarkRefreshTransformDirty();
+	++BonePoseSequence;
+}
+
 void UCameraHandInput::UpdateGrabInput()
 {
 	// Hand pose grab input
@@ -351,6 +559,13 @@ void UCameraHandInput::UpdateGrabInput()
 		bIsInGrabPose = true;
 	}
 
+	if (bUseSkeletonPinch && (ResolvablePinchMask & 0b11) != 0)
+	{
+		// only look at the index and middle fingers, like the pinch axes
+		bIsPinching = (SkeletonPinchMask & 0b11) != 0;
+		return;
+	}
+
 	// pinch axis input
 	auto const HighestPinchValueThisFrame = GetHighestPinchValue();
 
@@ -372,6 +587,153 @@ void UCameraHandInput::UpdateGrabInput()
 	HighestPinchValueLastFrame = HighestPinchValueThisFrame;
 }
 
+void UCameraHandInput::UpdateReleasePrediction()
+{
+	// a new grip starts a new prediction
+	if (bIsInGrabPose && !bWasInGrabPoseForReleasePrediction)
+	{
+		ReleasePredictor.Reset();
+		PredictedReleaseTime = -1;
+	}
+	bWasInGrabPoseForReleasePrediction = bIsInGrabPose;
+
+	if (!bIsInGrabPose || PredictedReleaseTime >= 0 || !IsTracked() || !HandMesh)
+	{
+		return;
+	}
+
+	FReleasePredictor::FSettings Settings;
+	Settings.GripOpeningSpeed = ReleasePredictionGripOpeningSpeed;
+	Settings.MinHandSpeed = ReleasePredictionMinHandSpeed;
+	Settings.ReleaseThreshold = ReleaseThresholdForGrip;
+	Settings.MaxLeadTime = ReleasePredictionMaxLeadTime;
+
+	double ReleaseTime;
+	if (ReleasePredictor.AddSample(GetWorld()->GetTimeSeconds(), GetGrippingAxis(), HandMesh->GetComponentLocation(), Settings, ReleaseTime))
+	{
+		PredictedReleaseTime = ReleaseTime;
+		OnReleasePredicted.Broadcast(ReleaseTime);
+	}
+}
+
+void UCameraHandInput::BuildPinchChains()
+{
+	for (auto Chain = 0; Chain < 5; ++Chain)
+	{
+		auto Length = 0;
+		for (auto const Bone : PinchChainBones[Chain])
+		{
+			auto const PlanIndex = BoneRetargetPlan.IndexOfByPredicate(
+				[Bone](FHandBoneRetarget const& Retarget) { return Retarget.SourceBone == Bone; });
+			if (Bone == EOculusXRBone::Invalid || PlanIndex == INDEX_NONE)
+			{
+				// without the rest of the chain, the last mapped joint stands in for the tip
+				break;
+			}
+			PinchChains[Chain][Length++] = PlanIndex;
+		}
+		for (; Length < 5; ++Length)
+		{
+			PinchChains[Chain][Length] = INDEX_NONE;
+		}
+	}
+
+	// an unmapped chain leaves its tip at the wrist, which reads as a pinch against any other unmapped chain
+	ResolvablePinchMask = 0;
+	if (PinchChains[0][0] != INDEX_NONE)
+	{
+		for (auto Finger = 0; Finger < 4; ++Finger)
+		{
+			if (PinchChains[Finger + 1][0] != INDEX_NONE)
+			{
+				ResolvablePinchMask |= 1 << Finger;
+			}
+		}
+	}
+	SkeletonPinchMask &= ResolvablePinchMask;
+}
+
+void UCameraHandInput::UpdateSkeletonPinch()
+{
+	if (ResolvablePinchMask == 0)
+	{
+		return;
+	}
+
+	// forward kinematics from the wrist, in the unscaled space of the hand mesh
+	FVector Tips[5];
+	for (auto Chain = 0; Chain < 5; ++Chain)
+	{
+		auto ChainTransform = FTransform::Identity;
+		for (auto const PlanIndex : PinchChains[Chain])
+		{
+			if (PlanIndex == INDEX_NONE)
+			{
+				break;
+			}
+			auto const& Retarget = BoneRetargetPlan[PlanIndex];
+			auto Rotation = Retarget.RotationOffset * RawLocalSpaceRotations[Retarget.SourceBone];
+			Rotation.Normalize();
+			ChainTransform = FTransform(Rotation, Retarget.Translation, Retarget.Scale) * ChainTransform;
+		}
+		Tips[Chain] = ChainTransform.GetLocation();
+	}
+
+	// thumb to fingertip distances of the four fingers at once
+	alignas(16) float DeltaX[4], DeltaY[4], DeltaZ[4];
+	for (auto Finger = 0; Finger < 4; ++Finger)
+	{
+		auto const Delta = Tips[Finger + 1] - Tips[0];
+		DeltaX[Finger] = Delta.X;
+		DeltaY[Finger] = Delta.Y;
+		DeltaZ[Finger] = Delta.Z;
+	}
+	auto const X = VectorLoadAligned(DeltaX);
+	auto const Y = VectorLoadAligned(DeltaY);
+	auto const Z = VectorLoadAligned(DeltaZ);
+	auto const DistanceSquared = VectorMultiplyAdd(X, X, VectorMultiplyAdd(Y, Y, VectorMultiply(Z, Z)));
+
+	// the mesh is scaled to the hand, the thresholds are real distances
+	auto const HandScale = bDynamicScalingEnabled ? FMath::Max(UOculusXRInputFunctionLibrary::GetHandScale(Hand), UE_KINDA_SMALL_NUMBER) : 1.f;
+	auto const PinchDistance = SkeletonPinchDistance / HandScale;
+	auto const ReleaseDistance = FMath::Max(SkeletonPinchReleaseDistance, SkeletonPinchDistance) / HandScale;
+	auto const PinchedBits = VectorMaskBits(VectorCompareLT(DistanceSquared, VectorSetFloat1(PinchDistance * PinchDistance)));
+	auto const ReleasedBits = VectorMaskBits(VectorCompareGT(DistanceSquared, VectorSetFloat1(ReleaseDistance * ReleaseDistance)));
+
+	alignas(16) float Distances[4];
+	VectorStoreAligned(VectorSqrt(DistanceSquared), Distances);
+
+	// don't update fingers if they, or the thumb, have low confidence tracking or no tip
+	auto ConfidentBits = 0;
+	if (GetFingerTrackingConfidence(Hand, EOculusXRFinger::Thumb) != EOculusXRTrackingConfidence::Low)
+	{
+		for (auto Finger = 0; Finger < 4; ++Finger)
+		{
+			if ((ResolvablePinchMask & (1 << Finger)) != 0 &&
+				GetFingerTrackingConfidence(Hand, static_cast<EOculusXRFinger>(Finger + 1)) != EOculusXRTrackingConfidence::Low)
+			{
+				ConfidentBits |= 1 << Finger;
+				FingerPinchDistances[Finger] = Distances[Finger] * HandScale;
+			}
+		}
+	}
+
+	auto const NewMask = (SkeletonPinchMask | PinchedBits) & ~ReleasedBits;
+	SkeletonPinchMask = static_cast<uint8>((NewMask & ConfidentBits) | (SkeletonPinchMask & ~ConfidentBits));
+}
+
+bool UCameraHandInput::IsFingerPinching(EOculusXRFinger Finger) const
+{
+	auto const FingerIndex = static_cast<int32>(Finger) - 1;
+	return FingerIndex >= 0 && FingerIndex < 4 && (SkeletonPinchMask & (1 << FingerIndex)) != 0;
+}
+
+float UCameraHandInput::GetFingerPinchDistance(EOculusXRFinger Finger) const
+{
+	auto const FingerIndex = static_cast<int32>(Finger) - 1;
+	return FingerIndex >= 0 && FingerIndex < 4 ? FingerPinchDistances[FingerIndex] : 0.f;
+}
+
 void UCameraHandInput::UpdatePointingInput()
 {
 	bIsPointing = GetPointingAxis() > 0.5f;
@@ -457,104 +819,186 @@ void UCameraHandInput::UpdateMeshVisibility() const
 	}
 }
 
-// these are all a mess and we really need a generic (data-driven) system to handle this
-float UCameraHandInput::GetPointingAxis()
+void UCameraHandInput::InitializeAxes()
 {
-	auto const SummedJoints =
-		RawLocalSpaceRotations[EOculusXRBone::Index_1].GetNormalized().GetAngle() +
-		RawLocalSpaceRotations[EOculusXRBone::Index_2].GetNormalized().GetAngle() +
-		RawLocalSpaceRotations[EOculusXRBone::Index_3].GetNormalized().GetAngle();
+	auto MakeAxis = [](FName Name, FVector2D AngleRange, std::initializer_list<EOculusXRBone> Bones)
+	{
+		FHandAxisDefinition Axis;
+		Axis.Name = Name;
+		Axis.AngleRange = AngleRange;
+		for (auto const Bone : Bones)
+		{
+			Axis.Bones.Add(FHandAxisBone{Bone, 1.f});
+		}
+		return Axis;
+	};
 
-	return FMath::GetMappedRangeValueClamped(PointingAxisJointRotationRange, FVector2D(0.f, 1.f), SummedJoints);
+	TArray<FHandAxisDefinition> Axes;
+	Axes.Add(MakeAxis(TEXT("Pointing"), PointingAxisJointRotationRange, {
+		EOculusXRBone::Index_1, EOculusXRBone::Index_2, EOculusXRBone::Index_3}));
+	Axes.Add(MakeAxis(TEXT("Gripping"), GrippingAxisJointRotationRange, {
+		EOculusXRBone::Middle_1, EOculusXRBone::Middle_2, EOculusXRBone::Middle_3,
+		EOculusXRBone::Ring_1, EOculusXRBone::Ring_2, EOculusXRBone::Ring_3,
+		EOculusXRBone::Pinky_1, EOculusXRBone::Pinky_2, EOculusXRBone::Pinky_3}));
+	Axes.Last().ActivateThreshold = GrabThresholdForGrip;
+	Axes.Last().DeactivateThreshold = ReleaseThresholdForGrip;
+	Axes.Add(MakeAxis(TEXT("ThumbUp"), ThumbUpAxisJointRotationRange, {
+		EOculusXRBone::Thumb_0, EOculusXRBone::Thumb_1, EOculusXRBone::Thumb_2, EOculusXRBone::Thumb_3}));
+
+	PointingAxisIndex = 0;
+	GrippingAxisIndex = 1;
+	ThumbUpAxisIndex = 2;
+
+	if (AxisSet)
+	{
+		Axes.Append(AxisSet->Axes);
+	}
+	AxisEvaluator.Initialize(Axes);
 }
 
-float UCameraHandInput::GetGrippingAxis()
+bool UCameraHandInput::UpdateAxisRanges()
+{
+	// the built-in axes follow their properties, which may be changed at any time, eg. from blueprints
+	auto bChanged = AxisEvaluator.SetAngleRange(PointingAxisIndex, PointingAxisJointRotationRange);
+	bChanged |= AxisEvaluator.SetAngleRange(GrippingAxisIndex, GrippingAxisJointRotationRange);
+	bChanged |= AxisEvaluator.SetThresholds(GrippingAxisIndex, GrabThresholdForGrip, ReleaseThresholdForGrip);
+	bChanged |= AxisEvaluator.SetAngleRange(ThumbUpAxisIndex, ThumbUpAxisJointRotationRange);
+	return bChanged;
+}
+
+void UCameraHandInput::UpdateAxes()
 {
-	auto const SummedJoints =
-		RawLocalSpaceRotations[EOculusXRBone::Middle_1].GetNormalized().GetAngle() +
-		RawLocalSpaceRotations[EOculusXRBone::Middle_2].GetNormalized().GetAngle() +
-		RawLocalSpaceRotations[EOculusXRBone::Middle_3].GetNormalized().GetAngle() +
-		RawLocalSpaceRotations[EOculusXRBone::Ring_1].GetNormalized().GetAngle() +
-		RawLocalSpaceRotations[EOculusXRBone::Ring_2].GetNormalized().GetAngle() +
-		RawLocalSpaceRotations[EOculusXRBone::Ring_3].GetNormalized().GetAngle() +
-		RawLocalSpaceRotations[EOculusXRBone::Pinky_1].GetNormalized().GetAngle() +
-		RawLocalSpaceRotations[EOculusXRBone::Pinky_2].GetNormalized().GetAngle() +
-		RawLocalSpaceRotations[EOculusXRBone::Pinky_3].GetNormalized().GetAngle();
+	AxisEvaluator.Evaluate(RawLocalSpaceRotations);
 
-	return FMath::GetMappedRangeValueClamped(GrippingAxisJointRotationRange, FVector2D(0.f, 1.f), SummedJoints);
+	if (OnAxisStateChanged.IsBound())
+	{
+		for (auto const& StateChange : AxisEvaluator.GetStateChanges())
+		{
+			OnAxisStateChanged.Broadcast(AxisEvaluator.GetName(StateChange.AxisIndex), StateChange.bActive);
+		}
+	}
+}
+
+float UCameraHandInput::GetPointingAxis()
+{
+	return AxisEvaluator.GetValue(PointingAxisIndex);
+}
+
+float UCameraHandInput::GetGrippingAxis()
+{
+	return AxisEvaluator.GetValue(GrippingAxisIndex);
 }
 
 float UCameraHandInput::GetThumbUpAxis()
 {
-	auto const SummedJoints =
-		RawLocalSpaceRotations[EOculusXRBone::Thumb_0].GetNormalized().GetAngle() +
-		RawLocalSpaceRotations[EOculusXRBone::Thumb_1].GetNormalized().GetAngle() +
-		RawLocalSpaceRotations[EOculusXRBone::Thumb_2].GetNormalized().GetAngle() +
-		RawLocalSpaceRotations[EOculusXRBone::Thumb_3].GetNormalized().GetAngle();
+	return AxisEvaluator.GetValue(ThumbUpAxisIndex);
+}
 
-	return FMath::GetMappedRangeValueClamped(ThumbUpAxisJointRotationRange, FVector2D(0.f, 1.f), SummedJoints);
+float UCameraHandInput::GetAxisValue(FName AxisName) const
+{
+	return AxisEvaluator.GetValue(AxisEvaluator.FindAxis(AxisName));
+}
+
+bool UCameraHandInput::IsAxisActive(FName AxisName) const
+{
+	return AxisEvaluator.IsActive(AxisEvaluator.FindAxis(AxisName));
 }
 
 bool UCameraHandInput::ApplyPoseToMesh(
 	FString PoseString, UPoseableMeshComponent* HandMesh,
 	TArray<FHandBoneMapping> const& BoneMappings, bool IsLeft)
 {
-	auto BoneToRecognizedBone = [](EOculusXRBone Bone)
+	auto const* Pose = HandMesh ? FHandPoseCache::FindOrDecode(PoseString) : nullptr;
+	if (Pose == nullptr)
 	{
-		switch (Bone)
+		return false;
+	}
+
+	TArray<FHandBoneRetarget> Plan;
+	BuildBoneRetargetPlan(BoneMappings, IsLeft, Plan);
+	ApplyDecodedPose(*Pose, Plan, HandMesh->BoneSpaceTransforms);
+
+	HandMesh->RefreshBoneTransforms();
+	return true;
+}
+
+void UCameraHandInput::ApplyDecodedPose(FDecodedHandPose const& Pose, TArray<FHandBoneRetarget> const& Plan,
+	TArray<FTransform>& BoneSpaceTransforms)
+{
+	for (auto const& Retarget : Plan)
+	{
+		auto const Bone = ToRecognizedBone(Retarget.SourceBone);
+		if (Bone != static_cast<ERecognizedBone>(-1))
 		{
-		case EOculusXRBone::Wrist_Root: return Wrist;
-		case EOculusXRBone::Thumb_0: return Thumb_0;
-		case EOculusXRBone::Thumb_1: return Thumb_1;
-		case EOculusXRBone::Thumb_2: return Thumb_2;
-		case EOculusXRBone::Thumb_3: return Thumb_3;
-		case EOculusXRBone::Index_1: return Index_1;
-		case EOculusXRBone::Index_2: return Index_2;
-		case EOculusXRBone::Index_3: return Index_3;
-		case EOculusXRBone::Middle_1: return Middle_1;
-		case EOculusXRBone::Middle_2: return Middle_2;
-		case EOculusXRBone::Middle_3: return Middle_3;
-		case EOculusXRBone::Ring_1: return Ring_1;
-		case EOculusXRBone::Ring_2: return Ring_2;
-		case EOculusXRBone::Ring_3: return Ring_3;
-		case EOculusXRBone::Pinky_0: return Pinky_0;
-		case EOculusXRBone::Pinky_1: return Pinky_1;
-		case EOculusXRBone::Pinky_2: return Pinky_2;
-		case EOculusXRBone::Pinky_3: return Pinky_3;
-		default: return static_cast<ERecognizedBone>(-1);
+			ApplyBoneRetarget(Retarget, Bone == Wrist ? FQuat::Identity : Pose.Rotations[Bone], BoneSpaceTransforms);
 		}
-	};
+	}
+}
 
-	FHandPose Pose;
-	Pose.CustomEncodedPose = PoseString;
-	if (HandMesh == nullptr || Pose.Decode() == false)
+bool UCameraHandInput::SetPose(FString PoseString)
+{
+	return SetPoseById(FHandPoseCache::FindOrAdd(PoseString));
+}
+
+bool UCameraHandInput::SetPoseById(FHandPoseId PoseId)
+{
+	auto const* Pose = FHandPoseCache::Find(PoseId);
+	if (Pose == nullptr || (!HandMesh && !PoseProxy))
 	{
 		return false;
 	}
 
-	for (auto Mapping : BoneMappings)
+	// while the same pose is held, the mesh still shows it from the previous frame
+	auto const bIsPoseApplied = bHadCustomGestureLastFrame && AppliedCustomPoseId == PoseId;
+	if (HandMesh && !bIsPoseApplied)
 	{
-		auto const Bone = BoneToRecognizedBone(Mapping.MappedBone);
-		if (Bone != static_cast<ERecognizedBone>(-1))
+		ApplyDecodedPose(*Pose, BoneRetargetPlan, HandMesh->BoneSpaceTransforms);
+		HandMesh->MarkRefreshTransformDirty();
+		++BonePoseSequence;
+	}
+
+	if (PoseProxy && AppliedCustomPoseId != PoseId)
+	{
+		for (auto Index = 0; Index != static_cast<int>(EOculusXRBone::Bone_Max); Index += 1)
 		{
-			auto Rotator = Bone == Wrist ? FRotator::ZeroRotator : Pose.GetRotator(Bone);
-			SetBoneRotation(HandMesh, Mapping, Rotator.Quaternion(), IsLeft);
+			auto const Bone = static_cast<EOculusXRBone>(Index);
+			auto const PosedBone = ToRecognizedBone(Bone);
+			CustomPoseBones[Bone] = PosedBone != static_cast<ERecognizedBone>(-1);
+			CustomPoseRotations[Bone] = CustomPoseBones[Bone] && PosedBone != Wrist
+				? Pose->Rotations[PosedBone]
+				: FQuat::Identity;
 		}
 	}
 
-	HandMesh->RefreshBoneTransforms();
+	AppliedCustomPoseId = PoseId;
+	bHasCustomGesture = true;
 	return true;
 }
 
-bool UCameraHandInput::SetPose(FString PoseString)
+void UCameraHandInput::PublishPose(bool bHasCustomGestureThisFrame)
 {
-	if (ApplyPoseToMesh(PoseString, HandMesh, BoneMap, GetHand() == EOculusXRHandType::HandLeft))
+	if (bPoseProxyBoneMapDirty)
 	{
-		bHasCustomGesture = true;
-		return true;
+		PoseProxy->SetBoneMap(BoneMap, GetHand() == EOculusXRHandType::HandLeft, IsOpenXRSystem());
+		bPoseProxyBoneMapDirty = false;
 	}
 
-	return false;
+	PoseProxy->Publish([this, bHasCustomGestureThisFrame](FTrackedHandPose& Pose)
+	{
+		Pose.BoneRotations = BoneRotations;
+		Pose.bHasCustomGesture = bHasCustomGestureThisFrame;
+		Pose.DigitsMaskedFromCustomGesture = DigitsMaskedFromCustomGesture;
+
+		// keep the last custom pose after the gesture ends, so the anim node can blend out of it
+		if (bHasCustomGestureThisFrame)
+		{
+			for (auto Index = 0; Index != static_cast<int>(EOculusXRBone::Bone_Max); Index += 1)
+			{
+				auto const Bone = static_cast<EOculusXRBone>(Index);
+				Pose.CustomRotations[Bone] = CustomPoseBones[Bone] ? CustomPoseRotations[Bone] : BoneRotations[Bone];
+			}
+		}
+	});
 }
 
 #undef ConvertBoneToFinger
@@ -6,6 +6,9 @@
 
 #include "OculusXRInputFunctionLibrary.h"
 #include "EnumMap.h"
+#include "HandAxisEvaluator.h"
+#include "ReleasePredictor.h"
+#include "HandPoseCache.h"
 
 #include "CameraHandInput.generated.h"
 
@@ -18,6 +21,7 @@ namespace OculusInput
 
 class UPoseableMeshComponent;
 class UThrowingComponent;
+class FTrackedHandPoseProxy;
 class UHandComponentBase;
 
 UENUM(BlueprintType, meta = (Bitflags, UseEnumValuesAsMaskValuesInEditor = "true"))
@@ -57,6 +61,24 @@ struct HANDINPUT_API FHandBoneMapping
 	FTransform ReferenceTransform;
 };
 
+/** One precomputed posing step for a mapped bone, built from FHandBoneMapping by UCameraHandInput::BuildBoneRetargetPlan. */
+struct FHandBoneRetarget
+{
+	/// index into the mesh's BoneSpaceTransforms
+	int32 BoneIndex = INDEX_NONE;
+
+	EOculusXRBone SourceBone{};
+
+	/// mapping rotation offset, with the OpenXR root fixup already applied
+	FQuat RotationOffset = FQuat::Identity;
+
+	FVector Translation = FVector::ZeroVector;
+	FVector Scale = FVector::OneVector;
+
+	/// EHandDigit bit of the bone, 0 if it isn't part of a digit
+	uint8 DigitMask = 0;
+};
+
 UCLASS(meta = (BlueprintSpawnableComponent))
 class HANDINPUT_API UCameraHandInput : public UActorComponent, public IHandInput
 {
@@ -80,6 +102,13 @@ public:
 	UFUNCTION(BlueprintCallable)
 	static void SetUpBoneMap(UPoseableMeshComponent* HandMesh, UPARAM(ref) TArray<FHandBoneMapping>& BoneMap);
 
+	/// Flattens a bone map set up by SetUpBoneMap into the posing steps used every frame, skipping unresolved bones.
+	static void BuildBoneRetargetPlan(TArray<FHandBoneMapping> const& BoneMap, bool IsLeft, TArray<FHandBoneRetarget>& Plan);
+
+	/// Posing step for one mapping, writing to BoneIndex of a skeleton whose reference pose for the bone is ReferenceTransform.
+	static FHandBoneRetarget MakeBoneRetarget(FHandBoneMapping const& BoneMapping, int32 BoneIndex, bool bIsRootBone,
+		FTransform const& ReferenceTransform, bool IsLeft, bool bOpenXRRootFixup);
+
 	// IHandInput
 	UFUNCTION(BlueprintCallable)
 	virtual void SetHand(EControllerHand InHand) override;
@@ -136,6 +165,11 @@ public:
 	UPROPERTY(BlueprintReadWrite, Category = "Hand Input", Transient)
 	UPoseableMeshComponent* HandMesh = nullptr;
 
+	/// also publish the filtered pose for the Tracked Hand anim graph node, so a skeletal hand mesh can be posed
+	/// during parallel animation evaluation instead of through HandMesh
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Hand Input")
+	bool bPublishPoseForAnimGraph = false;
+
 	// grip release delay with good tracking
 	UPROPERTY(BlueprintReadOnly, EditAnywhere, Category = "Hand Input")
 	float GlobalDropDelay = 0.05f;
@@ -174,6 +208,38 @@ public:
 	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "Bone Data Filter")
 	bool bBoneRotationFilteringEnabled = true;
 
+	/// decide pinching from fingertip distances in the tracked skeleton instead of the pinch strength input axes,
+	/// in the same frame as the bone data (needs a hand mesh whose bone map includes the finger chains; fingers whose
+	/// chain, or the thumb's, isn't mapped never pinch, and the pinch axes are used when neither the index nor the
+	/// middle finger chain is)
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "Skeleton Pinch")
+	bool bUseSkeletonPinch = false;
+
+	/// thumb to fingertip distance (cm) below which a finger starts pinching
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "Skeleton Pinch")
+	float SkeletonPinchDistance = 1.5f;
+
+	/// thumb to fingertip distance (cm) above which a finger stops pinching
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "Skeleton Pinch")
+	float SkeletonPinchReleaseDistance = 3.f;
+
+	/// predict when a grip is let go in a throw, from the grip opening and the hand slowing down, ahead of the
+	/// gripping axis dropping below ReleaseThresholdForGrip (see OnReleasePredicted)
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "Release Prediction")
+	bool bPredictRelease = false;
+
+	/// how fast the gripping axis must be opening for a release to be predicted (axis units/s)
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "Release Prediction")
+	float ReleasePredictionGripOpeningSpeed = 3.f;
+
+	/// peak hand speed needed for a release to be predicted (cm/s), slower hands are placing rather than throwing
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "Release Prediction")
+	float ReleasePredictionMinHandSpeed = 100.f;
+
+	/// how far ahead of the latest tracking sample a release may be predicted (s)
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "Release Prediction")
+	float ReleasePredictionMaxLeadTime = 0.05f;
+
 	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "Hand Input")
 	FVector2D PointingAxisJointRotationRange = FVector2D(14.f, 18.f);
 
@@ -183,6 +249,24 @@ public:
 	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "Hand Input")
 	FVector2D ThumbUpAxisJointRotationRange = FVector2D(21.8f, 22.7f);
 
+	/// additional axes evaluated with the built-in Pointing, Gripping and ThumbUp axes on every tracking sample,
+	/// the axis ranges are read in BeginPlay
+	UPROPERTY(BlueprintReadOnly, EditAnywhere, Category = "Hand Input")
+	UHandAxisSet* AxisSet = nullptr;
+
+	DECLARE_DYNAMIC_MULTICAST_DELEGATE_TwoParams(FOnAxisStateChanged, FName, AxisName, bool, bActive);
+
+	/// called when an axis crosses its activate or deactivate threshold
+	UPROPERTY(BlueprintAssignable, Category = "Hand Input")
+	FOnAxisStateChanged OnAxisStateChanged;
+
+	DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FOnReleasePredicted, double, ReleaseTime);
+
+	/// called at most once per grip when a throw release is predicted, with the estimated world time of the release,
+	/// eg. for UThrowingComponent::GetThrowVectorAtTime
+	UPROPERTY(BlueprintAssignable, Category = "Release Prediction")
+	FOnReleasePredicted OnReleasePredicted;
+
 	DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FOnInitializeMesh, UCameraHandInput *, CameraHandInput);
 
 	UPROPERTY(BlueprintAssignable, Category = "Hand Input")
@@ -194,8 +278,27 @@ public:
 	UFUNCTION(BlueprintPure)
 	bool IsInGrabPose() const { return bIsInGrabPose; }
 
+	/// World time of the release predicted for the current or last grip, negative if none was predicted.
+	UFUNCTION(BlueprintPure)
+	double GetPredictedReleaseTime() const { return PredictedReleaseTime; }
+
+	/// Whether the skeleton pinch detector sees the finger pinching the thumb, see bUseSkeletonPinch.
 	UFUNCTION(BlueprintPure)
-	FTransform GetBoneTransformWorld(EOculusXRBone Bone) { return BoneCache[Bone]; }
+	bool IsFingerPinching(EOculusXRFinger Finger) const;
+
+	/// Thumb to fingertip distance (cm) measured by the skeleton pinch detector, see bUseSkeletonPinch.
+	UFUNCTION(BlueprintPure)
+	float GetFingerPinchDistance(EOculusXRFinger Finger) const;
+
+	UFUNCTION(BlueprintPure)
+	FTransform GetBoneTransformWorld(EOculusXRBone Bone);
+
+	UFUNCTION(BlueprintPure)
+	FTransform GetBoneTransformComponent(EOculusXRBone Bone) const { return BoneCache[Bone]; }
+
+	/// Counter incremented every time the cached bone transforms change, so gameplay can skip frames where the skeleton wasn't updated.
+	UFUNCTION(BlueprintPure)
+	int32 GetBoneCacheSequence() const { return BoneCacheSequence; }
 
 	UFUNCTION(BlueprintPure)
 	bool IsTracked() const;
@@ -209,9 +312,35 @@ public:
 	UFUNCTION(BlueprintPure)
 	float GetThumbUpAxis();
 
+	UFUNCTION(BlueprintPure)
+	float GetAxisValue(FName AxisName) const;
+
+	UFUNCTION(BlueprintPure)
+	bool IsAxisActive(FName AxisName) const;
+
+	/// Applies a custom pose for this frame, call it every frame the pose should be held.
 	UFUNCTION(BlueprintCallable)
 	bool SetPose(FString PoseString);
 
+	/// SetPose with a handle from GetHandPoseId, holding the pose then costs a lookup instead of decoding its string.
+	UFUNCTION(BlueprintCallable)
+	bool SetPoseById(FHandPoseId PoseId);
+
+	/// Counter incremented every time hand tracking delivers a new skeleton sample.
+	UFUNCTION(BlueprintPure)
+	int32 GetTrackingSampleSequence() const { return TrackingSampleSequence; }
+
+	/// Whether the skeleton data read this frame is a new tracking sample.
+	UFUNCTION(BlueprintPure)
+	bool HasNewTrackingSample() const { return bHasNewTrackingSample; }
+
+	/// Time between the two most recent tracking samples (s).
+	UFUNCTION(BlueprintPure)
+	float GetTrackingSampleDeltaTime() const { return TrackingSampleDeltaTime; }
+
+	/// Pose published for FAnimNode_TrackedHand, only valid after BeginPlay with bPublishPoseForAnimGraph enabled.
+	TSharedPtr<FTrackedHandPoseProxy, ESPMode::ThreadSafe> GetPoseProxy() const { return PoseProxy; }
+
 protected:
 	virtual void TickComponent(float DeltaTime, enum ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction) override;
 
@@ -224,8 +353,17 @@ private:
 	float TimeWhenTrackingLastGained = -1;
 
 	void FilterBoneRotation(EOculusXRBone Bone, FQuat LastRotation, FQuat& Rotation);
-	static void SetBoneRotation(UPoseableMeshComponent* HandMesh, FHandBoneMapping BoneMapping, FQuat BoneRotation, bool IsLeft);
+	static void ApplyBoneRetarget(FHandBoneRetarget const& Retarget, FQuat const& BoneRotation, TArray<FTransform>& BoneSpaceTransforms);
+	static void ApplyDecodedPose(FDecodedHandPose const& Pose, TArray<FHandBoneRetarget> const& Plan, TArray<FTransform>& BoneSpaceTransforms);
 	void UpdateSkeleton();
+	void WriteBoneRotations(bool bHasCustomGestureThisFrame);
+	void ReadTrackingSample();
+	void UpdateBoneCache(int32 PoseSequence);
+
+	int32 TrackingSampleSequence = 0;
+	bool bHasNewTrackingSample = false;
+	float LastTrackingSampleTime = -1;
+	float TrackingSampleDeltaTime = 0;
 
 	bool bInputIsInitialized = false;
 	void UpdateGrabInput();
@@ -237,27 +375,76 @@ private:
 	void FingerPinchUpdate(int FingerIndex, float Value);
 	float FingerPinchValues[4] = {0};
 	bool bIsPinching = false;
+
+	void BuildPinchChains();
+	void UpdateSkeletonPinch();
+
+	// retarget plan entries from the wrist to the tip of the thumb and each finger, INDEX_NONE terminated
+	int32 PinchChains[5][5];
+	// one bit per finger whose chain and the thumb's are mapped, index first
+	uint8 ResolvablePinchMask = 0;
+	float FingerPinchDistances[4] = {0};
+
+	// one bit per finger, index first
+	uint8 SkeletonPinchMask = 0;
 	float HighestPinchValueLastFrame = 0;
 	bool bIsInGrabPose = false;
 
+	void UpdateReleasePrediction();
+	FReleasePredictor ReleasePredictor;
+	bool bWasInGrabPoseForReleasePrediction = false;
+	double PredictedReleaseTime = -1;
+
 	void UpdatePointingInput();
 	bool bIsPointing = false;
 
+	void InitializeAxes();
+	void UpdateAxes();
+	bool UpdateAxisRanges();
+	FHandAxisEvaluator AxisEvaluator;
+	int32 PointingAxisIndex = INDEX_NONE;
+	int32 GrippingAxisIndex = INDEX_NONE;
+	int32 ThumbUpAxisIndex = INDEX_NONE;
+
 	int GripBoneId = -1;
 
+	TArray<FHandBoneRetarget> BoneRetargetPlan;
+
 	bool bHasCustomGesture = false;
 	bool bHadCustomGestureLastFrame = false;
 	uint8 DigitsMaskedFromCustomGesture = 0;
 
+	void PublishPose(bool bHasCustomGestureThisFrame);
+
+	TSharedPtr<FTrackedHandPoseProxy, ESPMode::ThreadSafe> PoseProxy;
+	bool bPoseProxyBoneMapDirty = false;
+
+	FHandPoseId AppliedCustomPoseId;
+
+	// custom pose rotations, only kept while publishing to the anim graph
+	TEnumMap<EOculusXRBone, FQuat> CustomPoseRotations;
+	TEnumMap<EOculusXRBone, bool> CustomPoseBones;
+
 	bool bForceMeshHidden = false;
 	void UpdateMeshVisibility() const;
 
-	// cache bone transforms from hand tracking for use by gameplay code
+	// incremented whenever bone rotations are written to the mesh
+	int32 BonePoseSequence = 0;
+
+	// cache component-space bone transforms from hand tracking for use by gameplay code,
+	// world-space transforms are only converted when asked for
 	TEnumMap<EOculusXRBone, FTransform> BoneCache;
+	int32 BoneCacheSequence = 0;
+	int32 BoneCachePoseSequence = -1;
+	TEnumMap<EOculusXRBone, FTransform> BoneCacheWorld;
+	TEnumMap<EOculusXRBone, int32> BoneCacheWorldStamps;
+	FTransform BoneCacheComponentToWorld;
+	int32 BoneCacheWorldStamp = 0;
 	TEnumMap<EOculusXRBone, FQuat> RawLocalSpaceRotations;
 
 	// cache bone rotations from hand tracking for smoothing
 	TEnumMap<EOculusXRBone, FQuat> BoneRotations;
 	TEnumMap<EOculusXRBone, FQuat> BoneVelocities;
+	TEnumMap<EOculusXRBone, FQuat> BoneSampleRotations;
 	TEnumMap<EOculusXRBone, float> BoneLastFrozenTimes;
 };
@@ -0,0 +1,91 @@
+// Copyright (c) Meta Platforms, Inc. and affiliates.
+
+#include "HandAxisEvaluator.h"
+
+void FHandAxisEvaluator::Initialize(TArray<FHandAxisDefinition> const& Definitions)
+{
+	Bones.Reset();
+	Axes.Reset(Definitions.Num());
+	Terms.Reset();
+
+	for (auto const& Definition : Definitions)
+	{
+		auto& Axis = Axes.AddDefaulted_GetRef();
+		Axis.Name = Definition.Name;
+		Axis.FirstTerm = Terms.Num();
+		Axis.NumTerms = Definition.Bones.Num();
+		Axis.AngleRange = Definition.AngleRange;
+		Axis.ActivateThreshold = Definition.ActivateThreshold;
+		Axis.DeactivateThreshold = FMath::Min(Definition.DeactivateThreshold, Definition.ActivateThreshold);
+
+		for (auto const& AxisBone : Definition.Bones)
+		{
+			Terms.Add(FTerm{Bones.AddUnique(AxisBone.Bone), AxisBone.Weight});
+		}
+	}
+
+	BoneAngles.SetNumZeroed(Bones.Num());
+	Values.SetNumZeroed(Axes.Num());
+	States.Init(false, Axes.Num());
+	StateChanges.Reset();
+}
+
+void FHandAxisEvaluator::Evaluate(TEnumMap<EOculusXRBone, FQuat> const& Rotations)
+{
+	for (auto Slot = 0; Slot < Bones.Num(); ++Slot)
+	{
+		BoneAngles[Slot] = Rotations[Bones[Slot]].GetNormalized().GetAngle();
+	}
+
+	StateChanges.Reset();
+	for (auto AxisIndex = 0; AxisIndex < Axes.Num(); ++AxisIndex)
+	{
+		auto const& Axis = Axes[AxisIndex];
+
+		auto SummedAngles = 0.f;
+		for (auto TermIndex = Axis.FirstTerm; TermIndex < Axis.FirstTerm + Axis.NumTerms; ++TermIndex)
+		{
+			SummedAngles += BoneAngles[Terms[TermIndex].BoneSlot] * Terms[TermIndex].Weight;
+		}
+
+		auto const Value = Values[AxisIndex] = FMath::GetMappedRangeValueClamped(Axis.AngleRange, FVector2D(0.f, 1.f), SummedAngles);
+
+		auto const bWasActive = States[AxisIndex];
+		auto const bIsActive = bWasActive ? Value >= Axis.DeactivateThreshold : Value > Axis.ActivateThreshold;
+		if (bIsActive != bWasActive)
+		{
+			States[AxisIndex] = bIsActive;
+			StateChanges.Add(FStateChange{AxisIndex, bIsActive});
+		}
+	}
+}
+
+bool FHandAxisEvaluator::SetAngleRange(int32 AxisIndex, FVector2D AngleRange)
+{
+	if (!Axes.IsValidIndex(AxisIndex) || Axes[AxisIndex].AngleRange == AngleRange)
+	{
+		return false;
+	}
+
+	Axes[AxisIndex].AngleRange = AngleRange;
+	return true;
+}
+
+bool FHandAxisEvaluator::SetThresholds(int32 AxisIndex, float ActivateThreshold, float DeactivateThreshold)
+{
+	DeactivateThreshold = FMath::Min(DeactivateThreshold, ActivateThreshold);
+	if (!Axes.IsValidIndex(AxisIndex) ||
+		(Axes[AxisIndex].ActivateThreshold == ActivateThreshold && Axes[AxisIndex].DeactivateThreshold == DeactivateThreshold))
+	{
+		return false;
+	}
+
+	Axes[AxisIndex].ActivateThreshold = ActivateThreshold;
+	Axes[AxisIndex].DeactivateThreshold = DeactivateThreshold;
+	return true;
+}
+
+int32 FHandAxisEvaluator::FindAxis(FName Name) const
+{
+	return Axes.IndexOfByPredicate([Name](FAxis const& Axis) { return Axis.Name == Name; });
+}
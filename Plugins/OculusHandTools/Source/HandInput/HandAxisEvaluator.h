@@ -0,0 +1,119 @@
+// Copyright (c) Meta Platforms, Inc. and affiliates.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Engine/DataAsset.h"
+#include "OculusXRInputFunctionLibrary.h"
+#include "EnumMap.h"
+
+#include "HandAxisEvaluator.generated.h"
+
+USTRUCT(BlueprintType)
+struct HANDINPUT_API FHandAxisBone
+{
+	GENERATED_BODY()
+
+	UPROPERTY(BlueprintReadOnly, EditAnywhere)
+	EOculusXRBone Bone{};
+
+	UPROPERTY(BlueprintReadOnly, EditAnywhere)
+	float Weight = 1.f;
+};
+
+/** An input axis derived from the hand skeleton: the weighted sum of bone rotation angles, mapped to 0..1. */
+USTRUCT(BlueprintType)
+struct HANDINPUT_API FHandAxisDefinition
+{
+	GENERATED_BODY()
+
+	UPROPERTY(BlueprintReadOnly, EditAnywhere)
+	FName Name;
+
+	UPROPERTY(BlueprintReadOnly, EditAnywhere)
+	TArray<FHandAxisBone> Bones;
+
+	/// summed bone angles (radians) that map to axis values 0 and 1
+	UPROPERTY(BlueprintReadOnly, EditAnywhere)
+	FVector2D AngleRange = FVector2D(0.f, 1.f);
+
+	/// axis value above which the axis becomes active
+	UPROPERTY(BlueprintReadOnly, EditAnywhere)
+	float ActivateThreshold = 0.5f;
+
+	/// axis value below which an active axis becomes inactive again
+	UPROPERTY(BlueprintReadOnly, EditAnywhere)
+	float DeactivateThreshold = 0.5f;
+};
+
+/** A set of hand axes, eg. per-finger curl or spread, evaluated by CameraHandInput. */
+UCLASS(BlueprintType)
+class HANDINPUT_API UHandAxisSet : public UPrimaryDataAsset
+{
+	GENERATED_BODY()
+
+public:
+	UPROPERTY(BlueprintReadOnly, EditAnywhere, Category = "Hand Axes")
+	TArray<FHandAxisDefinition> Axes;
+};
+
+/**
+ * Evaluates hand axes in a single pass over the skeleton. The angle of every referenced bone is computed once, however
+ * many axes use it, and all axis values land in one array so reading them costs nothing.
+ */
+class HANDINPUT_API FHandAxisEvaluator
+{
+public:
+	struct FStateChange
+	{
+		int32 AxisIndex;
+		bool bActive;
+	};
+
+	void Initialize(TArray<FHandAxisDefinition> const& Definitions);
+	void Evaluate(TEnumMap<EOculusXRBone, FQuat> const& Rotations);
+
+	/// Change the range or thresholds of an axis without resetting its state, eg. when they are tuned at runtime.
+	/// Return whether anything changed.
+	bool SetAngleRange(int32 AxisIndex, FVector2D AngleRange);
+	bool SetThresholds(int32 AxisIndex, float ActivateThreshold, float DeactivateThreshold);
+
+	/// Index of the first axis with this name, INDEX_NONE if there is none.
+	int32 FindAxis(FName Name) const;
+
+	int32 Num() const { return Axes.Num(); }
+	FName GetName(int32 AxisIndex) const { return Axes.IsValidIndex(AxisIndex) ? Axes[AxisIndex].Name : NAME_None; }
+	float GetValue(int32 AxisIndex) const { return Values.IsValidIndex(AxisIndex) ? Values[AxisIndex] : 0.f; }
+	bool IsActive(int32 AxisIndex) const { return States.IsValidIndex(AxisIndex) && States[AxisIndex]; }
+
+	/// Axes that crossed a threshold during the last Evaluate.
+	TArray<FStateChange> const& GetStateChanges() const { return StateChanges; }
+
+private:
+	struct FAxis
+	{
+		FName Name;
+		int32 FirstTerm = 0;
+		int32 NumTerms = 0;
+		FVector2D AngleRange;
+		float ActivateThreshold = 0.f;
+		float DeactivateThreshold = 0.f;
+	};
+
+	struct FTerm
+	{
+		int32 BoneSlot = 0;
+		float Weight = 0.f;
+	};
+
+	// distinct bones referenced by any axis, and their angles from the last evaluation
+	TArray<EOculusXRBone> Bones;
+	TArray<float> BoneAngles;
+
+	TArray<FAxis> Axes;
+	TArray<FTerm> Terms;
+
+	TArray<float> Values;
+	TArray<bool> States;
+	TArray<FStateChange> StateChanges;
+};
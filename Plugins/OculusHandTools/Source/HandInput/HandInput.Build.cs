@@ -15,6 +15,7 @@ public class HandInput : ModuleRules
 				"CoreUObject",
 				"Engine",
 				"InputCore",
+				"OculusHandPoseRecognition",
 				"OculusXRInput",
 				"HeadMountedDisplay"
 			}
@@ -22,7 +23,6 @@ public class HandInput : ModuleRules
 
 		PrivateDependencyModuleNames.AddRange(
 			new string[] {
-				"OculusHandPoseRecognition",
 				"OculusUtils"
 			}
 		);
@@ -0,0 +1,80 @@
+// Copyright (c) Meta Platforms, Inc. and affiliates.
+
+#include "ReleasePredictor.h"
+
+bool FReleasePredictor::AddSample(double Time, float GripAxis, FVector const& HandLocation, FSettings const& Settings,
+	double& OutReleaseTime)
+{
+	if (NumSamples > 0 && Time <= Times[NumSamples - 1])
+	{
+		return false;
+	}
+
+	if (NumSamples == MaxSamples)
+	{
+		for (auto i = 1; i < MaxSamples; ++i)
+		{
+			Times[i - 1] = Times[i];
+			GripAxes[i - 1] = GripAxes[i];
+			Locations[i - 1] = Locations[i];
+		}
+		--NumSamples;
+	}
+	Times[NumSamples] = Time;
+	GripAxes[NumSamples] = GripAxis;
+	Locations[NumSamples] = HandLocation;
+	++NumSamples;
+
+	if (NumSamples < MaxSamples)
+	{
+		return false;
+	}
+
+	// hand speeds between consecutive samples, the middle one must be the peak
+	double SpeedTimes[MaxSamples - 1];
+	double Speeds[MaxSamples - 1];
+	for (auto i = 0; i < MaxSamples - 1; ++i)
+	{
+		SpeedTimes[i] = (Times[i] + Times[i + 1]) / 2;
+		Speeds[i] = FVector::Dist(Locations[i], Locations[i + 1]) / (Times[i + 1] - Times[i]);
+	}
+	if (Speeds[1] < Settings.MinHandSpeed || Speeds[1] < Speeds[0] || Speeds[1] <= Speeds[2])
+	{
+		return false;
+	}
+
+	// least-squares slope of the gripping axis over the samples
+	auto MeanTime = 0.;
+	auto MeanGrip = 0.;
+	for (auto i = 0; i < MaxSamples; ++i)
+	{
+		MeanTime += Times[i] / MaxSamples;
+		MeanGrip += GripAxes[i] / MaxSamples;
+	}
+	auto Covariance = 0.;
+	auto Variance = 0.;
+	for (auto i = 0; i < MaxSamples; ++i)
+	{
+		Covariance += (Times[i] - MeanTime) * (GripAxes[i] - MeanGrip);
+		Variance += FMath::Square(Times[i] - MeanTime);
+	}
+	auto const GripSlope = Covariance / Variance;
+	if (GripSlope > -Settings.GripOpeningSpeed)
+	{
+		return false;
+	}
+
+	// the peak speed time, at the vertex of the parabola through the speeds around it
+	auto const Left = SpeedTimes[1] - SpeedTimes[0];
+	auto const Right = SpeedTimes[1] - SpeedTimes[2];
+	auto const Numerator = Left * Left * (Speeds[1] - Speeds[2]) - Right * Right * (Speeds[1] - Speeds[0]);
+	auto const Denominator = Left * (Speeds[1] - Speeds[2]) - Right * (Speeds[1] - Speeds[0]);
+	auto const PeakTime = FMath::Abs(Denominator) > UE_DOUBLE_SMALL_NUMBER
+		? FMath::Clamp(SpeedTimes[1] - Numerator / (2 * Denominator), SpeedTimes[0], SpeedTimes[2])
+		: SpeedTimes[1];
+
+	// where the fitted grip crosses the release threshold, not before the hand starts slowing down
+	auto const CrossingTime = MeanTime + (Settings.ReleaseThreshold - MeanGrip) / GripSlope;
+	OutReleaseTime = FMath::Clamp(CrossingTime, PeakTime, Time + Settings.MaxLeadTime);
+	return true;
+}
@@ -0,0 +1,40 @@
+// Copyright (c) Meta Platforms, Inc. and affiliates.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+/**
+ * Predicts the moment a held object is let go in a throw, from the last few tracking samples: the hand has passed its
+ * peak speed while the gripping axis is opening quickly. The release time is estimated between samples, where the
+ * opening grip is extrapolated to cross the release threshold.
+ */
+class HANDINPUT_API FReleasePredictor
+{
+public:
+	struct FSettings
+	{
+		/// how fast the gripping axis must be opening (axis units/s)
+		float GripOpeningSpeed = 3.f;
+		/// hand speed the peak must reach (cm/s)
+		float MinHandSpeed = 100.f;
+		/// gripping axis value at which the hand is considered open
+		float ReleaseThreshold = 0.3f;
+		/// how far past the most recent sample the release may be predicted (s)
+		float MaxLeadTime = 0.05f;
+	};
+
+	void Reset() { NumSamples = 0; }
+
+	/// Adds a tracking sample. Returns true, with the estimated release time, if the hand is letting go.
+	bool AddSample(double Time, float GripAxis, FVector const& HandLocation, FSettings const& Settings, double& OutReleaseTime);
+
+private:
+	static constexpr int32 MaxSamples = 4;
+
+	// oldest first
+	double Times[MaxSamples];
+	float GripAxes[MaxSamples];
+	FVector Locations[MaxSamples];
+	int32 NumSamples = 0;
+};
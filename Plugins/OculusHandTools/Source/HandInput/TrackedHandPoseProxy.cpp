@@ -0,0 +1,55 @@
+// Copyright (c) Meta Platforms, Inc. and affiliates.
+
+#include "TrackedHandPoseProxy.h"
+
+#include "Misc/ScopeRWLock.h"
+
+FTrackedHandPose::FTrackedHandPose()
+{
+	for (auto& Quat : BoneRotations)
+	{
+		Quat = FQuat::Identity;
+	}
+	for (auto& Quat : CustomRotations)
+	{
+		Quat = FQuat::Identity;
+	}
+}
+
+void FTrackedHandPoseProxy::SetBoneMap(TArray<FHandBoneMapping> const& Mappings, bool bIsLeft, bool bOpenXRRootFixup)
+{
+	FWriteScopeLock WriteLock(Lock);
+	BoneMap.Mappings = Mappings;
+	BoneMap.bIsLeft = bIsLeft;
+	BoneMap.bOpenXRRootFixup = bOpenXRRootFixup;
+	++BoneMap.Version;
+}
+
+void FTrackedHandPoseProxy::Publish(TFunctionRef<void(FTrackedHandPose&)> Writer)
+{
+	FWriteScopeLock WriteLock(Lock);
+	Writer(Pose);
+	++Pose.Sequence;
+}
+
+bool FTrackedHandPoseProxy::ReadPose(FTrackedHandPose& OutPose) const
+{
+	FReadScopeLock ReadLock(Lock);
+	if (OutPose.Sequence == Pose.Sequence)
+	{
+		return false;
+	}
+	OutPose = Pose;
+	return true;
+}
+
+bool FTrackedHandPoseProxy::ReadBoneMap(FTrackedHandBoneMap& OutBoneMap) const
+{
+	FReadScopeLock ReadLock(Lock);
+	if (OutBoneMap.Version == BoneMap.Version)
+	{
+		return false;
+	}
+	OutBoneMap = BoneMap;
+	return true;
+}
@@ -0,0 +1,58 @@
+// Copyright (c) Meta Platforms, Inc. and affiliates.
+
+#pragma once
+
+#include "CameraHandInput.h"
+
+/** Snapshot of a tracked hand, in the tracking runtime's bone space. */
+struct HANDINPUT_API FTrackedHandPose
+{
+	FTrackedHandPose();
+
+	/// filtered bone rotations
+	TEnumMap<EOculusXRBone, FQuat> BoneRotations;
+
+	/// rotations of the last custom pose, bones the pose doesn't cover hold the tracked rotation
+	TEnumMap<EOculusXRBone, FQuat> CustomRotations;
+
+	bool bHasCustomGesture = false;
+	uint8 DigitsMaskedFromCustomGesture = 0;
+
+	/// incremented on every publish, 0 until the first one
+	int32 Sequence = 0;
+};
+
+/** Bone map of the hand the pose belongs to, so consumers can build their own retarget plan. */
+struct HANDINPUT_API FTrackedHandBoneMap
+{
+	TArray<FHandBoneMapping> Mappings;
+	bool bIsLeft = false;
+	bool bOpenXRRootFixup = false;
+
+	/// incremented every time the bone map changes, 0 until it is set
+	int32 Version = 0;
+};
+
+/**
+ * Hands the pose of a UCameraHandInput from the game thread to FAnimNode_TrackedHand, which reads it on animation
+ * worker threads. Readers copy what changed under a read lock, so the lock is only held for a copy.
+ */
+class HANDINPUT_API FTrackedHandPoseProxy
+{
+public:
+	void SetBoneMap(TArray<FHandBoneMapping> const& Mappings, bool bIsLeft, bool bOpenXRRootFixup);
+
+	/// Calls Writer under the write lock, then bumps the pose sequence.
+	void Publish(TFunctionRef<void(FTrackedHandPose&)> Writer);
+
+	/// Copies the pose if its sequence differs from Pose.Sequence. Returns true if it was copied.
+	bool ReadPose(FTrackedHandPose& Pose) const;
+
+	/// Copies the bone map if its version differs from BoneMap.Version. Returns true if it was copied.
+	bool ReadBoneMap(FTrackedHandBoneMap& BoneMap) const;
+
+private:
+	mutable FRWLock Lock;
+	FTrackedHandPose Pose;
+	FTrackedHandBoneMap BoneMap;
+};
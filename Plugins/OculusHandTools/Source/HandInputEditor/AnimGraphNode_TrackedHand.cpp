@@ -0,0 +1,22 @@
+// Copyright (c) Meta Platforms, Inc. and affiliates.
+
+#include "AnimGraphNode_TrackedHand.h"
+
+#define LOCTEXT_NAMESPACE "AnimGraphNode_TrackedHand"
+
+FText UAnimGraphNode_TrackedHand::GetNodeTitle(ENodeTitleType::Type TitleType) const
+{
+	return LOCTEXT("NodeTitle", "Tracked Hand");
+}
+
+FText UAnimGraphNode_TrackedHand::GetTooltipText() const
+{
+	return LOCTEXT("NodeTooltip", "Poses the hand with the filtered hand tracking data of the owner's CameraHandInput.");
+}
+
+FString UAnimGraphNode_TrackedHand::GetNodeCategory() const
+{
+	return TEXT("Hand Tracking");
+}
+
+#undef LOCTEXT_NAMESPACE
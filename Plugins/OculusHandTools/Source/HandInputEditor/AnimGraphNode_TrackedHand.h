@@ -0,0 +1,27 @@
+// Copyright (c) Meta Platforms, Inc. and affiliates.
+
+#pragma once
+
+#include "AnimGraphNode_Base.h"
+#include "AnimNode_TrackedHand.h"
+
+#include "AnimGraphNode_TrackedHand.generated.h"
+
+UCLASS()
+class HANDINPUTEDITOR_API UAnimGraphNode_TrackedHand : public UAnimGraphNode_Base
+{
+	GENERATED_BODY()
+
+public:
+	UPROPERTY(EditAnywhere, Category = Settings)
+	FAnimNode_TrackedHand Node;
+
+	// UEdGraphNode
+	virtual FText GetNodeTitle(ENodeTitleType::Type TitleType) const override;
+	virtual FText GetTooltipText() const override;
+	// ~UEdGraphNode
+
+	// UAnimGraphNode_Base
+	virtual FString GetNodeCategory() const override;
+	// ~UAnimGraphNode_Base
+};
@@ -0,0 +1,24 @@
+// Copyright (c) Meta Platforms, Inc. and affiliates.
+
+using UnrealBuildTool;
+
+public class HandInputEditor : ModuleRules
+{
+	public HandInputEditor(ReadOnlyTargetRules Target) : base(Target)
+	{
+		PCHUsage = PCHUsageMode.UseExplicitOrSharedPCHs;
+
+		PublicDependencyModuleNames.AddRange(
+			new string[] {
+				"Core",
+				"CoreUObject",
+				"Engine",
+				"AnimGraph",
+				"BlueprintGraph",
+				"HandInput"
+			}
+		);
+
+		IncludeOrderVersion = EngineIncludeOrderVersion.Unreal5_6;
+	}
+}
@@ -2,9 +2,12 @@
 
 #include "HandTrackingFilterComponent.h"
 
+#include "HandTrackingFilterDiagnostics.h"
 #include "MotionControllerComponent.h"
 #include "OculusXRInputFunctionLibrary.h"
 #include "Camera/CameraComponent.h"
+#include "Misc/Paths.h"
+#include "Misc/ScopeLock.h"
 #include "QuatUtil.h"
 #include "XRMotionControllerBase.h"
 
@@ -18,12 +21,18 @@ DEFINE_LOG_CATEGORY(LogHandTrackingFilter);
 UHandTrackingFilterComponent::UHandTrackingFilterComponent()
 {
 	bAutoActivate = true;
+
+	// only ticks to batch diagnostics
+	PrimaryComponentTick.bCanEverTick = true;
+	PrimaryComponentTick.bStartWithTickEnabled = false;
 }
 
 void UHandTrackingFilterComponent::BeginPlay()
 {
 	Super::BeginPlay();
 
+	SetDiagnosticsEnabled(bDiagnosticsEnabled);
+
 	LastFrameData = FHandTrackingFilterData{NOW, GetComponentTransform()};
 
 	if (auto Controller = Cast<UMotionControllerComponent>(GetAttachParent()))
@@ -63,6 +72,58 @@ void UHandTrackingFilterComponent::EndPlay(const EEndPlayReason::Type EndPlayRea
 	Super::EndPlay(EndPlayReason);
 }
 
+void UHandTrackingFilterComponent::TickComponent(float DeltaTime, ELevelTick TickType,
+	FActorComponentTickFunction* ThisTickFunction)
+{
+	Super::TickComponent(DeltaTime, TickType, ThisTickFunction);
+
+	if (Diagnostics && OnCalculatedDataBatch.IsBound())
+	{
+		TArray<FHandTrackingFilterDiagnosticsRecord> Records;
+		Diagnostics->GetRecordsSince(DiagnosticsBatchCursor, Records);
+		if (Records.Num() > 0)
+		{
+			TArray<FHandTrackingFilterCalculatedData> Batch;
+			Batch.Reserve(Records.Num());
+			for (auto const& Record : Records)
+			{
+				Batch.Add(Record.ToCalculatedData());
+			}
+			OnCalculatedDataBatch.Broadcast(Batch);
+		}
+	}
+}
+
+void UHandTrackingFilterComponent::SetDiagnosticsEnabled(bool bEnabled)
+{
+	bDiagnosticsEnabled = bEnabled;
+	if (!bEnabled)
+	{
+		Diagnostics.Reset();
+	}
+	else if (!Diagnostics || Diagnostics->GetCapacity() != DiagnosticsCapacity)
+	{
+		Diagnostics = MakeShared<FHandTrackingFilterDiagnostics, ESPMode::ThreadSafe>(DiagnosticsCapacity);
+		DiagnosticsBatchCursor = 0;
+	}
+
+	SetComponentTickEnabled(bEnabled);
+}
+
+void UHandTrackingFilterComponent::ExportDiagnostics(FString const& Filename, EHandTrackingFilterDiagnosticsFormat Format)
+{
+	if (!Diagnostics)
+	{
+		UE_LOG(LogHandTrackingFilter, Warning, TEXT("%s - ExportDiagnostics - diagnostics are not enabled"), *GetName());
+		return;
+	}
+
+	auto const Path = FPaths::IsRelative(Filename) ?
+		FPaths::Combine(FPaths::ProjectSavedDir(), TEXT("HandTrackingFilter"), Filename) :
+		Filename;
+	Diagnostics->ExportAsync(Path, Format);
+}
+
 EHandTrackingDataQuality UHandTrackingFilterComponent::GetDataQualityOverride() const
 {
 	if (bIgnoreConfidence)
@@ -155,24 +216,55 @@ FQuat UHandTrackingFilterComponent::SmoothRotation(FQuat StartRot, FQuat TargetR
 	return FQuat::Slerp(StartRot, TargetRot, SmoothFactor);
 }
 
+bool UHandTrackingFilterComponent::UpdateTrackingSample(FVector const& Location, FRotator const& Orientation, bool bForceBadData)
+{
+	// the source hands back the exact same tracking-space pose until it has a new sample
+	auto const bIsNewSample = bForceBadData || !bHasRawSample ||
+		Location != LastRawLocation || Orientation != LastRawOrientation;
+
+	if (bIsNewSample && !bForceBadData)
+	{
+		LastRawLocation = Location;
+		LastRawOrientation = Orientation;
+		bHasRawSample = true;
+		LastTrackingSampleTime = NOW;
+		++TrackingSampleSequence;
+	}
+
+	return bIsNewSample;
+}
+
 bool UHandTrackingFilterComponent::DoFirstPassFilter(
 	FHandTrackingFilterData const& LastData,
 	FHandTrackingFilterData const& ThisFrameInitData,
+	bool bIsNewSample,
 	FTransform& NewTransform)
 {
-	auto const LastLocation = LastData.Transform.GetLocation();
-	auto const NewLocation = ThisFrameInitData.Transform.GetLocation();
-	auto const DeltaLocation = NewLocation - LastLocation;
-	auto const DistanceSquared = DeltaLocation.SizeSquared();
-
 	// if there hasn't been a tracking update, extrapolate
-	if (DistanceSquared < MinTrackingDistance * MinTrackingDistance)
+	if (!bIsNewSample)
 	{
-		UE_LOG(LogHandTrackingFilter, Verbose, TEXT("%s - DoFirstPassFilter - if the location hasn't changed (%f), there hasn't been a tracking update"), *GetName(), DistanceSquared);
+		UE_LOG(LogHandTrackingFilter, Verbose, TEXT("%s - DoFirstPassFilter - no new tracking sample (%i)"), *GetName(), TrackingSampleSequence);
 		NewTransform = LastSetTransform;
 		return true;
 	}
 
+	auto const LastLocation = LastData.Transform.GetLocation();
+	auto const NewLocation = ThisFrameInitData.Transform.GetLocation();
+
+	if (!bDetectTrackingSamplesFromSource)
+	{
+		auto const DistanceSquared = FVector::DistSquared(NewLocation, LastLocation);
+		if (DistanceSquared < MinTrackingDistance * MinTrackingDistance)
+		{
+			UE_LOG(LogHandTrackingFilter, Verbose, TEXT("%s - DoFirstPassFilter - if the location hasn't changed (%f), there hasn't been a tracking update"), *GetName(), DistanceSquared);
+			NewTransform = LastSetTransform;
+			return true;
+		}
+
+		LastTrackingSampleTime = ThisFrameInitData.Time;
+		++TrackingSampleSequence;
+	}
+
 	auto const NewRotation = ThisFrameInitData.Transform.GetRotation();
 
 	auto const SmoothedPosition = SmoothPosition(LastSetTransform.GetLocation(), NewLocation);
@@ -184,17 +276,19 @@ bool UHandTrackingFilterComponent::DoFirstPassFilter(
 	return false;
 }
 
-FTransform UHandTrackingFilterComponent::DoFilteringImpl(FTransform HandTransform, bool bForceBadData)
+FTransform UHandTrackingFilterComponent::DoFilteringImpl(FHandTrackingFilterInput const& Input)
 {
 	auto CalculatedData = FHandTrackingFilterCalculatedData();
+	auto const bForceBadData = Input.bForceBadData;
 
 	auto const LastData = LastFrameData;
-	auto ThisFrameInitData = FHandTrackingFilterData{NOW, HandTransform};
+	auto ThisFrameInitData = FHandTrackingFilterData{Input.Time, Input.HandTransform};
 
+	// LastData is only advanced on new samples, so this is the true sample-to-sample delta
 	auto const DeltaTime = ThisFrameInitData.Time - LastData.Time;
 
 	auto MitigatedTransform = ThisFrameInitData.Transform;
-	auto const EarlyOut = DoFirstPassFilter(LastData, ThisFrameInitData, MitigatedTransform);
+	auto const EarlyOut = DoFirstPassFilter(LastData, ThisFrameInitData, Input.bIsNewSample, MitigatedTransform);
 	if (!bForceBadData && EarlyOut)
 	{
 		LastSetTransform = MitigatedTransform;
@@ -226,23 +320,18 @@ FTransform UHandTrackingFilterComponent::DoFilteringImpl(FTransform HandTransfor
 		Data.Velocity.SizeSquared() > MaxSpeed * MaxSpeed ||
 		CalculatedData.AngularVelocityScalar > MaxAngularVelocity;
 
-	auto const QualityOverride = GetDataQualityOverride();
+	auto const QualityOverride = Input.QualityOverride;
 	if (QualityOverride == EHandTrackingDataQuality::Good)
 		BadData = false;
 	else if (QualityOverride == EHandTrackingDataQuality::Bad)
 		BadData = true;
 
-	auto const Camera = GetOwner()->FindComponentByClass<UCameraComponent>();
-	if (Camera != nullptr)
+	CalculatedData.CameraDistance = Input.CameraDistance;
+	if (Input.CameraDistance >= 0)
 	{
-		CalculatedData.CameraDistance = FVector::Dist(Data.Transform.GetLocation(), Camera->GetComponentLocation());
 		if ((QualityOverride != EHandTrackingDataQuality::Good || bCameraRadiusIgnoreConfidence) && CalculatedData.CameraDistance < IgnoreCameraLocationRadius)
 			BadData = true;
 	}
-	else
-	{
-		CalculatedData.CameraDistance = -1;
-	}
 
 	if (bForceBadData)
 	{
@@ -264,7 +353,28 @@ FTransform UHandTrackingFilterComponent::DoFilteringImpl(FTransform HandTransfor
 	CalculatedData.QualityOverride = QualityOverride;
 	CalculatedData.BadData = BadData;
 
-	OnCalculatedData.Broadcast(CalculatedData);
+	// the late update pass on the render thread re-filters the same frame, only record the game thread pass
+	if (Diagnostics && IsInGameThread())
+	{
+		FHandTrackingFilterDiagnosticsRecord Record;
+		Record.Time = Data.Time;
+		Record.Location = FVector3f(NewTransform.GetLocation());
+		Record.Velocity = FVector3f(CalculatedData.Velocity);
+		Record.Acceleration = FVector3f(CalculatedData.Acceleration);
+		Record.AccelerationScalar = CalculatedData.AccelerationScalar;
+		Record.AngularVelocityScalar = CalculatedData.AngularVelocityScalar;
+		Record.CameraDistance = CalculatedData.CameraDistance;
+		Record.Distance = CalculatedData.Distance;
+		Record.SampleSequence = TrackingSampleSequence;
+		Record.QualityOverride = QualityOverride;
+		Record.bBadData = BadData;
+		Diagnostics->Push(Record);
+	}
+
+	if (OnCalculatedData.IsBound())
+	{
+		OnCalculatedData.Broadcast(CalculatedData);
+	}
 
 	if (UE_LOG_ACTIVE(LogHandTrackingFilter, VeryVerbose))
 	{
@@ -295,14 +405,83 @@ void UHandTrackingFilterComponent::DoFiltering(FVector& Location, FRotator& Orie
 		return;
 	}
 
+	FScopeLock Lock(&FilterCriticalSection);
+
+	auto const bIsNewSample = !bDetectTrackingSamplesFromSource || UpdateTrackingSample(Location, Orientation, bForceBadData);
+
 	auto ParentTransform = GetAttachParent()->GetAttachParent()->GetComponentTransform();
+	RebaseFilterState(ParentTransform);
 	auto RelativeTransform = FTransform(Orientation, Location);
-	auto WorldTransform = DoFilteringImpl(RelativeTransform * ParentTransform, bForceBadData);
+
+	FHandTrackingFilterInput Input;
+	Input.Time = NOW;
+	Input.HandTransform = RelativeTransform * ParentTransform;
+	Input.bForceBadData = bForceBadData;
+	Input.bIsNewSample = bIsNewSample;
+
+	// the quality and camera checks are only needed when the sample will actually be filtered
+	if (bIsNewSample || bForceBadData)
+	{
+		Input.QualityOverride = GetDataQualityOverride();
+		if (auto const Camera = GetOwner()->FindComponentByClass<UCameraComponent>())
+		{
+			Input.CameraDistance = FVector::Dist(Input.HandTransform.GetLocation(), Camera->GetComponentLocation());
+		}
+	}
+
+	auto WorldTransform = DoFilteringImpl(Input);
 	auto NewRelativeTransform = WorldTransform * ParentTransform.Inverse();
 	Location = NewRelativeTransform.GetLocation();
 	Orientation = NewRelativeTransform.Rotator();
 }
 
+void UHandTrackingFilterComponent::RebaseFilterState(FTransform const& ParentTransform)
+{
+	// the filter works in world space, move its state with the pawn so that the pose held between tracking samples,
+	// and the velocities extrapolated from it, stay relative to the parent rather than fixed in the world
+	if (bHasParentTransform && !ParentTransform.Equals(LastParentTransform, 0.))
+	{
+		auto const ParentDelta = LastParentTransform.Inverse() * ParentTransform;
+		auto const DeltaRotation = ParentDelta.GetRotation();
+
+		LastSetTransform = LastSetTransform * ParentDelta;
+		LastFrameData.Transform = LastFrameData.Transform * ParentDelta;
+		LastFrameData.Velocity = DeltaRotation.RotateVector(LastFrameData.Velocity);
+		LastFrameData.AngularVelocity = DeltaRotation * LastFrameData.AngularVelocity * DeltaRotation.Inverse();
+		LastGoodVelocity = DeltaRotation.RotateVector(LastGoodVelocity);
+		LastGoodAngularVelocity = DeltaRotation * LastGoodAngularVelocity * DeltaRotation.Inverse();
+	}
+
+	LastParentTransform = ParentTransform;
+	bHasParentTransform = true;
+}
+
+void UHandTrackingFilterComponent::ResetFilter(FTransform const& Transform, double Time)
+{
+	FScopeLock Lock(&FilterCriticalSection);
+
+	LastFrameData = FHandTrackingFilterData{Time, Transform, FVector::ZeroVector, FQuat::Identity};
+	LastSetTransform = Transform;
+	LastBadDataTime = -99999;
+	LastGoodVelocity = FVector::ZeroVector;
+	LastGoodAngularVelocity = FQuat::Identity;
+	LastFrozenMovementTime = -99999;
+	LastFrozenRotationTime = -99999;
+	bHasParentTransform = false;
+
+	// a replayed session must not be mistaken for the continuation of the last one
+	TrackingSampleSequence = 0;
+	LastTrackingSampleTime = -99999;
+	LastRawLocation = FVector::ZeroVector;
+	LastRawOrientation = FRotator::ZeroRotator;
+	bHasRawSample = false;
+}
+
+FTransform UHandTrackingFilterComponent::FilterSample(FHandTrackingFilterInput const& Input)
+{
+	return DoFilteringImpl(Input);
+}
+
 void UHandTrackingFilterComponent::ExtrapolateTransform(float DeltaTime, FVector& FakeLocation, FQuat& FakeRotation)
 {
 	UE_LOG(LogHandTrackingFilter, Verbose, TEXT("%s - ExtrapolateTransform - LastGoodVelocity = %f"), *GetName(), LastGoodVelocity.Size());
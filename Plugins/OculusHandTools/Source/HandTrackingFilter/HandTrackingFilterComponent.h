@@ -4,8 +4,11 @@
 
 #include "CoreMinimal.h"
 #include "Components/SceneComponent.h"
+#include "HAL/CriticalSection.h"
 #include "HandTrackingFilterComponent.generated.h"
 
+class FHandTrackingFilterDiagnostics;
+
 struct HANDTRACKINGFILTER_API FHandTrackingFilterData
 {
 	double Time;
@@ -22,6 +25,35 @@ enum class EHandTrackingDataQuality : uint8
 	Bad
 };
 
+/** Everything the filter needs to know about one tracking update, so that it can also run without a world. */
+struct HANDTRACKINGFILTER_API FHandTrackingFilterInput
+{
+	/// time of the update (s)
+	double Time = 0;
+
+	/// world-space hand transform reported by tracking
+	FTransform HandTransform = FTransform::Identity;
+
+	/// hand confidence information
+	EHandTrackingDataQuality QualityOverride = EHandTrackingDataQuality::None;
+
+	/// distance from the hand to the HMD (cm), negative if unknown
+	float CameraDistance = -1;
+
+	/// treat the update as bad data regardless of its content
+	bool bForceBadData = false;
+
+	/// whether tracking produced a new sample for this update
+	bool bIsNewSample = true;
+};
+
+UENUM(BlueprintType)
+enum class EHandTrackingFilterDiagnosticsFormat : uint8
+{
+	Csv,
+	Binary
+};
+
 USTRUCT(BlueprintType)
 struct HANDTRACKINGFILTER_API FHandTrackingFilterCalculatedData
 {
@@ -66,6 +98,11 @@ protected:
 	virtual void BeginPlay() override;
 	virtual void EndPlay(EEndPlayReason::Type const EndPlayReason) override;
 
+public:
+	virtual void TickComponent(float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction) override;
+
+protected:
+
 	FHandTrackingFilterData LastFrameData;
 
 	double LastBadDataTime = -99999;
@@ -73,21 +110,42 @@ protected:
 	FQuat LastGoodAngularVelocity = FQuat::Identity;
 	FTransform LastSetTransform = FTransform::Identity;
 
-	bool DoFirstPassFilter(FHandTrackingFilterData const& LastData, FHandTrackingFilterData const& ThisFrameInitData, FTransform& NewTransform);
-	FTransform DoFilteringImpl(FTransform HandTransform, bool bForceBadData);
+	bool DoFirstPassFilter(FHandTrackingFilterData const& LastData, FHandTrackingFilterData const& ThisFrameInitData, bool bIsNewSample, FTransform& NewTransform);
+	bool UpdateTrackingSample(FVector const& Location, FRotator const& Orientation, bool bForceBadData);
+	FTransform DoFilteringImpl(FHandTrackingFilterInput const& Input);
 	FTransform IntegrateFilterData(FTransform MitigatedTransform, FHandTrackingFilterData const& Data, float DeltaTime, bool BadData);
 	void DoFiltering(FVector& Location, FRotator& Orientation, bool bForceBadData);
+	void RebaseFilterState(FTransform const& ParentTransform);
 	void ExtrapolateTransform(float DeltaTime, FVector& FakeLocation, FQuat& FakeRotation);
 	EHandTrackingDataQuality GetDataQualityOverride() const;
 	FQuat SmoothRotation(FQuat StartRot, FQuat TargetRot);
 	FVector SmoothPosition(FVector StartPos, FVector TargetPos);
 
+	// tracking sample bookkeeping, updated from the raw tracking-space pose delivered by the source
+	int32 TrackingSampleSequence = 0;
+	double LastTrackingSampleTime = -99999;
+	FVector LastRawLocation = FVector::ZeroVector;
+	FRotator LastRawOrientation = FRotator::ZeroRotator;
+	bool bHasRawSample = false;
+
+	// parent of the motion controller when the filter state was last expressed in world space, so that the held pose
+	// follows the pawn between tracking samples
+	FTransform LastParentTransform = FTransform::Identity;
+	bool bHasParentTransform = false;
+
+	// DoFiltering runs on the game thread and again on the render thread for the late update
+	FCriticalSection FilterCriticalSection;
+
 	double LastFrozenMovementTime = -99999;
 	double LastFrozenRotationTime = -99999;
 
 	UPROPERTY(Transient)
 	USceneComponent* PreFilterComponent = nullptr;
 
+	/** Only allocated while diagnostics are enabled, so the filter pays a single null check otherwise. */
+	TSharedPtr<FHandTrackingFilterDiagnostics, ESPMode::ThreadSafe> Diagnostics;
+	uint64 DiagnosticsBatchCursor = 0;
+
 public:
 	/** Percentage to de-jitter the position by */
 	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "Jitter Mitigation")
@@ -165,6 +223,11 @@ public:
 	UPROPERTY(BlueprintReadWrite, EditAnywhere)
 	float MinTrackingDistance = 0.001f;
 
+	// Detect new tracking samples by comparing the raw tracking-space pose from the source instead of relying on
+	// MinTrackingDistance, which is fooled by the pawn moving while tracking has not updated
+	UPROPERTY(BlueprintReadWrite, EditAnywhere)
+	bool bDetectTrackingSamplesFromSource = true;
+
 	// How quickly to integrate presumed good velocity data into the extrapolation velocity
 	UPROPERTY(BlueprintReadWrite, EditAnywhere)
 	float GoodVelocityBlendRate = 0.5f;
@@ -177,6 +240,66 @@ public:
 	UPROPERTY(BlueprintAssignable)
 	FOnCalculatedDataEvent OnCalculatedData;
 
+	/** Record the data calculated by the filter in a ring buffer, for tuning and export. */
+	UPROPERTY(BlueprintReadOnly, EditAnywhere, Category = "Diagnostics")
+	bool bDiagnosticsEnabled = false;
+
+	/** Number of records kept by the diagnostics ring buffer. */
+	UPROPERTY(BlueprintReadOnly, EditAnywhere, Category = "Diagnostics", meta = (ClampMin = 1))
+	int32 DiagnosticsCapacity = 1024;
+
+	DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FOnCalculatedDataBatchEvent, TArray<FHandTrackingFilterCalculatedData> const &, Batch);
+
+	/**
+	 * @brief Called once per frame with all the data recorded since the previous frame. Requires diagnostics to be enabled.
+	 */
+	UPROPERTY(BlueprintAssignable, Category = "Diagnostics")
+	FOnCalculatedDataBatchEvent OnCalculatedDataBatch;
+
+	/**
+	 * @param bEnabled Whether the filter should record its calculated data. Disabling frees the recorded data.
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Diagnostics")
+	void SetDiagnosticsEnabled(bool bEnabled);
+
+	/**
+	 * @brief Writes the recorded data to a file on a background thread.
+	 * @param Filename Output file, relative paths are written to Saved/HandTrackingFilter.
+	 * @param Format CSV for spreadsheets, binary for tools.
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Diagnostics")
+	void ExportDiagnostics(FString const& Filename, EHandTrackingFilterDiagnosticsFormat Format);
+
+	/**
+	 * @brief Resets the filter state, eg. before replaying recorded tracking data.
+	 */
+	void ResetFilter(FTransform const& Transform, double Time);
+
+	/**
+	 * @brief Runs the filter on one tracking update without touching the world, eg. for offline tuning tools.
+	 * Updates must be supplied in increasing time order.
+	 * @return The filtered world-space hand transform.
+	 */
+	FTransform FilterSample(FHandTrackingFilterInput const& Input);
+
+	/**
+	 * @return The diagnostics ring buffer, or null if diagnostics are disabled.
+	 */
+	TSharedPtr<FHandTrackingFilterDiagnostics, ESPMode::ThreadSafe> GetDiagnostics() const { return Diagnostics; }
+
+	/**
+	 * @return A counter incremented every time the tracking source delivers a new hand sample.
+	 * Downstream consumers can compare it against the last value they processed to skip redundant work.
+	 */
+	UFUNCTION(BlueprintPure)
+	int32 GetTrackingSampleSequence() const { return TrackingSampleSequence; }
+
+	/**
+	 * @return The real time (s) at which the most recent tracking sample was received.
+	 */
+	UFUNCTION(BlueprintPure)
+	double GetLastTrackingSampleTime() const { return LastTrackingSampleTime; }
+
 	/**
 	 * @return The pre-filter component
 	 */
@@ -0,0 +1,136 @@
+// Copyright (c) Meta Platforms, Inc. and affiliates.
+
+#include "HandTrackingFilterDiagnostics.h"
+
+#include "Async/Async.h"
+#include "Misc/FileHelper.h"
+#include "Serialization/MemoryWriter.h"
+
+namespace
+{
+	// "HTFD", a format version, the record size and the number of records, followed by the records
+	constexpr uint32 BinaryMagic = 0x44465448;
+	constexpr uint32 BinaryVersion = 2;
+
+	// records are written field by field, in declaration order and without padding, so that files are reproducible
+	constexpr uint32 BinaryRecordSize = sizeof(double) + 3 * sizeof(FVector3f) + 4 * sizeof(float) + sizeof(int32) + 2 * sizeof(uint8);
+}
+
+FHandTrackingFilterCalculatedData FHandTrackingFilterDiagnosticsRecord::ToCalculatedData() const
+{
+	FHandTrackingFilterCalculatedData Data;
+	Data.Acceleration = FVector(Acceleration);
+	Data.AccelerationScalar = AccelerationScalar;
+	Data.AngularVelocityScalar = AngularVelocityScalar;
+	Data.CameraDistance = CameraDistance;
+	Data.Distance = Distance;
+	Data.Velocity = FVector(Velocity);
+	Data.QualityOverride = QualityOverride;
+	Data.BadData = bBadData;
+	return Data;
+}
+
+FHandTrackingFilterDiagnostics::FHandTrackingFilterDiagnostics(int32 Capacity)
+{
+	Records.SetNumZeroed(FMath::Max(Capacity, 1));
+}
+
+void FHandTrackingFilterDiagnostics::Push(FHandTrackingFilterDiagnosticsRecord const& Record)
+{
+	Records[static_cast<int32>(NumPushed % Records.Num())] = Record;
+	++NumPushed;
+}
+
+void FHandTrackingFilterDiagnostics::Reset()
+{
+	NumPushed = 0;
+}
+
+void FHandTrackingFilterDiagnostics::GetRecords(TArray<FHandTrackingFilterDiagnosticsRecord>& OutRecords) const
+{
+	uint64 Cursor = 0;
+	OutRecords.Reset();
+	GetRecordsSince(Cursor, OutRecords);
+}
+
+void FHandTrackingFilterDiagnostics::GetRecordsSince(uint64& Cursor, TArray<FHandTrackingFilterDiagnosticsRecord>& OutRecords) const
+{
+	uint64 const Capacity = Records.Num();
+	auto const Oldest = NumPushed > Capacity ? NumPushed - Capacity : 0;
+	auto First = FMath::Max(Cursor, Oldest);
+	if (First > NumPushed)
+	{
+		// the buffer was reset after the cursor was taken
+		First = Oldest;
+	}
+
+	OutRecords.Reserve(OutRecords.Num() + static_cast<int32>(NumPushed - First));
+	for (auto Index = First; Index < NumPushed; ++Index)
+	{
+		OutRecords.Add(Records[static_cast<int32>(Index % Capacity)]);
+	}
+
+	Cursor = NumPushed;
+}
+
+TFuture<bool> FHandTrackingFilterDiagnostics::ExportAsync(FString const& Filename, EHandTrackingFilterDiagnosticsFormat Format) const
+{
+	TArray<FHandTrackingFilterDiagnosticsRecord> Snapshot;
+	GetRecords(Snapshot);
+
+	return Async(EAsyncExecution::ThreadPool, [Snapshot = MoveTemp(Snapshot), Filename, Format]
+	{
+		if (Format == EHandTrackingFilterDiagnosticsFormat::Binary)
+		{
+			return FFileHelper::SaveArrayToFile(FormatBinary(Snapshot), *Filename);
+		}
+		return FFileHelper::SaveStringToFile(FormatCsv(Snapshot), *Filename);
+	});
+}
+
+FString FHandTrackingFilterDiagnostics::FormatCsv(TArray<FHandTrackingFilterDiagnosticsRecord> const& Records)
+{
+	FString Csv;
+	Csv.Reserve(128 * (Records.Num() + 1));
+	Csv.Append(TEXT("Time,SampleSequence,LocationX,LocationY,LocationZ,VelocityX,VelocityY,VelocityZ,")
+		TEXT("AccelerationX,AccelerationY,AccelerationZ,AccelerationScalar,AngularVelocityScalar,CameraDistance,Distance,")
+		TEXT("QualityOverride,BadData\n"));
+
+	for (auto const& Record : Records)
+	{
+		Csv.Appendf(TEXT("%.6f,%i,%.3f,%.3f,%.3f,%.3f,%.3f,%.3f,%.3f,%.3f,%.3f,%.3f,%.4f,%.3f,%.4f,%i,%i\n"),
+			Record.Time, Record.SampleSequence,
+			Record.Location.X, Record.Location.Y, Record.Location.Z,
+			Record.Velocity.X, Record.Velocity.Y, Record.Velocity.Z,
+			Record.Acceleration.X, Record.Acceleration.Y, Record.Acceleration.Z,
+			Record.AccelerationScalar, Record.AngularVelocityScalar, Record.CameraDistance, Record.Distance,
+			static_cast<int32>(Record.QualityOverride), Record.bBadData ? 1 : 0);
+	}
+
+	return Csv;
+}
+
+TArray<uint8> FHandTrackingFilterDiagnostics::FormatBinary(TArray<FHandTrackingFilterDiagnosticsRecord> const& Records)
+{
+	TArray<uint8> Bytes;
+	Bytes.Reserve(4 * sizeof(uint32) + Records.Num() * BinaryRecordSize);
+	FMemoryWriter Writer(Bytes);
+
+	auto Magic = BinaryMagic;
+	auto Version = BinaryVersion;
+	auto RecordSize = BinaryRecordSize;
+	auto NumRecords = static_cast<uint32>(Records.Num());
+	Writer << Magic << Version << RecordSize << NumRecords;
+
+	for (auto Record : Records)
+	{
+		auto QualityOverride = static_cast<uint8>(Record.QualityOverride);
+		uint8 BadData = Record.bBadData ? 1 : 0;
+		Writer << Record.Time << Record.Location << Record.Velocity << Record.Acceleration
+			<< Record.AccelerationScalar << Record.AngularVelocityScalar << Record.CameraDistance << Record.Distance
+			<< Record.SampleSequence << QualityOverride << BadData;
+	}
+
+	check(Bytes.Num() == 4 * sizeof(uint32) + Records.Num() * BinaryRecordSize);
+	return Bytes;
+}
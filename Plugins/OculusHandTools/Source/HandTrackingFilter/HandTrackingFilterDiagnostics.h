@@ -0,0 +1,64 @@
+// Copyright (c) Meta Platforms, Inc. and affiliates.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Async/Future.h"
+#include "HandTrackingFilterComponent.h"
+
+/** Plain copy of FHandTrackingFilterCalculatedData, cheap enough to record on every filter invocation. */
+struct HANDTRACKINGFILTER_API FHandTrackingFilterDiagnosticsRecord
+{
+	double Time;
+	FVector3f Location;
+	FVector3f Velocity;
+	FVector3f Acceleration;
+	float AccelerationScalar;
+	float AngularVelocityScalar;
+	float CameraDistance;
+	float Distance;
+	int32 SampleSequence;
+	EHandTrackingDataQuality QualityOverride;
+	bool bBadData;
+
+	FHandTrackingFilterCalculatedData ToCalculatedData() const;
+};
+
+static_assert(std::is_trivially_copyable_v<FHandTrackingFilterDiagnosticsRecord>,
+	"Diagnostics records are copied in bulk by the ring buffer");
+
+/**
+ * Fixed-size ring buffer holding the most recent filter records.
+ * Only accessed from the game thread; exports snapshot the records before handing them to a worker.
+ */
+class HANDTRACKINGFILTER_API FHandTrackingFilterDiagnostics
+{
+public:
+	explicit FHandTrackingFilterDiagnostics(int32 Capacity);
+
+	void Push(FHandTrackingFilterDiagnosticsRecord const& Record);
+	void Reset();
+
+	/** Copies the buffered records, oldest first. */
+	void GetRecords(TArray<FHandTrackingFilterDiagnosticsRecord>& OutRecords) const;
+
+	/**
+	 * Copies the records pushed since Cursor, oldest first, and advances Cursor.
+	 * Records that were overwritten before being read are skipped.
+	 */
+	void GetRecordsSince(uint64& Cursor, TArray<FHandTrackingFilterDiagnosticsRecord>& OutRecords) const;
+
+	/** Snapshots the buffered records and writes them to Filename on a background thread. */
+	TFuture<bool> ExportAsync(FString const& Filename, EHandTrackingFilterDiagnosticsFormat Format) const;
+
+	static FString FormatCsv(TArray<FHandTrackingFilterDiagnosticsRecord> const& Records);
+	static TArray<uint8> FormatBinary(TArray<FHandTrackingFilterDiagnosticsRecord> const& Records);
+
+	int32 GetCapacity() const { return Records.Num(); }
+
+private:
+	TArray<FHandTrackingFilterDiagnosticsRecord> Records;
+
+	/** Total number of records ever pushed; the next record is written at NumPushed % Capacity. */
+	uint64 NumPushed = 0;
+};
@@ -0,0 +1,31 @@
+// Copyright (c) Meta Platforms, Inc. and affiliates.
+
+using UnrealBuildTool;
+
+public class HandTrackingTuning : ModuleRules
+{
+	public HandTrackingTuning(ReadOnlyTargetRules Target) : base(Target)
+	{
+		PCHUsage = ModuleRules.PCHUsageMode.UseExplicitOrSharedPCHs;
+
+		PublicDependencyModuleNames.AddRange(
+			new string[]
+			{
+				"Core",
+				"CoreUObject",
+				"Engine",
+			}
+			);
+
+
+		PrivateDependencyModuleNames.AddRange(
+			new string[]
+			{
+				"HandTrackingFilter",
+				"OculusThrowAssist",
+			}
+			);
+
+		IncludeOrderVersion = EngineIncludeOrderVersion.Unreal5_6;
+	}
+}
@@ -0,0 +1,464 @@
+// Copyright (c) Meta Platforms, Inc. and affiliates.
+
+#include "HandTrackingSweepCommandlet.h"
+
+#include "HandTrackingFilterComponent.h"
+#include "HandTrackingTuningModule.h"
+#include "ThrowingComponent.h"
+
+#include "Algo/Sort.h"
+#include "Async/ParallelFor.h"
+#include "HAL/FileManager.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "UObject/StrongObjectPtr.h"
+
+namespace
+{
+	/** One frame of a recorded session, as it was delivered to the filter. */
+	struct FRecordedHandFrame
+	{
+		double Time = 0;
+		FTransform Transform = FTransform::Identity;
+		EHandTrackingDataQuality Quality = EHandTrackingDataQuality::None;
+		bool bNewSample = true;
+
+		bool bHasTruth = false;
+		FVector Truth = FVector::ZeroVector;
+
+		FVector LookDirection = FVector::ForwardVector;
+
+		bool bRelease = false;
+		FVector ThrowDirection = FVector::ZeroVector;
+	};
+
+	struct FRecordedHandSession
+	{
+		FString Name;
+		TArray<FRecordedHandFrame> Frames;
+	};
+
+	/** A swept property and the values it takes, one axis of the parameter grid. */
+	struct FSweepParameter
+	{
+		FString Name;
+		bool bThrow = false;
+		FProperty* Property = nullptr;
+		TArray<FString> Values;
+	};
+
+	struct FSweepResult
+	{
+		int32 Setting = 0;
+		double Jitter = 0; // rms acceleration of the filtered location (m/s^2)
+		double Lag = 0; // rms distance from the filtered to the ground truth location (cm)
+		double ThrowError = 0; // mean angle between the selected and the ground truth throw direction (deg)
+		double VelocityError = 0; // rms difference between the buffered and the ground truth hand velocity (m/s)
+		double Score = 0;
+	};
+
+	struct FSweepWeights
+	{
+		double Jitter = 1;
+		double Lag = 1;
+		double Throw = 1;
+		double Velocity = 0;
+	};
+
+	bool LoadSession(FString const& Filename, FRecordedHandSession& Session)
+	{
+		TArray<FString> Lines;
+		if (!FFileHelper::LoadFileToStringArray(Lines, *Filename) || Lines.Num() < 2)
+		{
+			UE_LOG(LogHandTrackingTuning, Error, TEXT("LoadSession - %s is missing or empty"), *Filename);
+			return false;
+		}
+
+		TArray<FString> Header;
+		Lines[0].ParseIntoArray(Header, TEXT(","));
+		for (auto& Column : Header)
+		{
+			Column.TrimStartAndEndInline();
+		}
+
+		auto const Column = [&Header](TCHAR const* Name) { return Header.IndexOfByKey(FString(Name)); };
+		int32 const Time = Column(TEXT("Time"));
+		int32 const Loc[] = {Column(TEXT("LocX")), Column(TEXT("LocY")), Column(TEXT("LocZ"))};
+		int32 const Rot[] = {Column(TEXT("RotX")), Column(TEXT("RotY")), Column(TEXT("RotZ")), Column(TEXT("RotW"))};
+		int32 const Truth[] = {Column(TEXT("TruthX")), Column(TEXT("TruthY")), Column(TEXT("TruthZ"))};
+		int32 const Look[] = {Column(TEXT("LookX")), Column(TEXT("LookY")), Column(TEXT("LookZ"))};
+		int32 const Throw[] = {Column(TEXT("ThrowX")), Column(TEXT("ThrowY")), Column(TEXT("ThrowZ"))};
+		int32 const Quality = Column(TEXT("Quality"));
+		int32 const NewSample = Column(TEXT("NewSample"));
+		int32 const Release = Column(TEXT("Release"));
+
+		if (Time == INDEX_NONE || Loc[0] == INDEX_NONE || Loc[1] == INDEX_NONE || Loc[2] == INDEX_NONE
+			|| Rot[0] == INDEX_NONE || Rot[1] == INDEX_NONE || Rot[2] == INDEX_NONE || Rot[3] == INDEX_NONE)
+		{
+			UE_LOG(LogHandTrackingTuning, Error, TEXT("LoadSession - %s needs Time, LocX/Y/Z and RotX/Y/Z/W columns"), *Filename);
+			return false;
+		}
+
+		auto const bHasTruth = Truth[0] != INDEX_NONE && Truth[1] != INDEX_NONE && Truth[2] != INDEX_NONE;
+		auto const bHasLook = Look[0] != INDEX_NONE && Look[1] != INDEX_NONE && Look[2] != INDEX_NONE;
+		auto const bHasThrow = Release != INDEX_NONE && Throw[0] != INDEX_NONE && Throw[1] != INDEX_NONE && Throw[2] != INDEX_NONE;
+
+		Session.Name = FPaths::GetBaseFilename(Filename);
+		Session.Frames.Reset(Lines.Num() - 1);
+
+		TArray<FString> Fields;
+		for (auto LineIndex = 1; LineIndex < Lines.Num(); ++LineIndex)
+		{
+			Fields.Reset();
+			Lines[LineIndex].ParseIntoArray(Fields, TEXT(","), false);
+			if (Fields.Num() < Header.Num())
+			{
+				continue; // blank or truncated line
+			}
+
+			auto const Value = [&Fields](int32 Index) { return FCString::Atod(*Fields[Index]); };
+			auto const Vector = [&Value](int32 const (&Indices)[3]) { return FVector(Value(Indices[0]), Value(Indices[1]), Value(Indices[2])); };
+
+			FRecordedHandFrame Frame;
+			Frame.Time = Value(Time);
+			Frame.Transform = FTransform(
+				FQuat(Value(Rot[0]), Value(Rot[1]), Value(Rot[2]), Value(Rot[3])).GetNormalized(),
+				Vector(Loc));
+			if (Quality != INDEX_NONE)
+			{
+				Frame.Quality = static_cast<EHandTrackingDataQuality>(FMath::Clamp(FCString::Atoi(*Fields[Quality]), 0, 2));
+			}
+			if (NewSample != INDEX_NONE)
+			{
+				Frame.bNewSample = FCString::Atoi(*Fields[NewSample]) != 0;
+			}
+			if (bHasTruth && !Fields[Truth[0]].IsEmpty())
+			{
+				Frame.bHasTruth = true;
+				Frame.Truth = Vector(Truth);
+			}
+			if (bHasLook)
+			{
+				Frame.LookDirection = Vector(Look).GetSafeNormal(UE_SMALL_NUMBER, FVector::ForwardVector);
+			}
+			if (bHasThrow && FCString::Atoi(*Fields[Release]) != 0)
+			{
+				Frame.ThrowDirection = Vector(Throw).GetSafeNormal();
+				Frame.bRelease = !Frame.ThrowDirection.IsZero();
+			}
+			Session.Frames.Add(Frame);
+		}
+
+		if (Session.Frames.Num() < 3)
+		{
+			UE_LOG(LogHandTrackingTuning, Error, TEXT("LoadSession - %s has fewer than 3 frames"), *Filename);
+			return false;
+		}
+		return true;
+	}
+
+	/** Replays every session through one setting. Only touches the objects of that setting, so settings run in parallel. */
+	FSweepResult EvaluateSetting(int32 Setting, UHandTrackingFilterComponent& Filter, UThrowingComponent const& Throwing,
+		TArray<FRecordedHandSession> const& Sessions, FSweepWeights const& Weights)
+	{
+		FSweepResult Result;
+		Result.Setting = Setting;
+
+		double JitterSum = 0;
+		int32 JitterCount = 0;
+		double LagSum = 0;
+		int32 LagCount = 0;
+		double ThrowErrorSum = 0;
+		int32 ThrowCount = 0;
+		double VelocityErrorSum = 0;
+		int32 VelocityCount = 0;
+
+		TArray<double> Times;
+		TArray<FVector> Locations;
+		FThrowSolver ThrowSolver;
+		for (auto const& Session : Sessions)
+		{
+			auto const& Frames = Session.Frames;
+			Filter.ResetFilter(Frames[0].Transform, Frames[0].Time);
+			ThrowSolver.Reset(Throwing.VelocityFitWindow, Throwing.VelocityFitOrder);
+			ThrowSolver.SetSettings(Throwing.GetSolverSettings());
+
+			Times.Reset(Frames.Num());
+			Locations.Reset(Frames.Num());
+			for (auto FrameIndex = 0; FrameIndex < Frames.Num(); ++FrameIndex)
+			{
+				auto const& Frame = Frames[FrameIndex];
+
+				FHandTrackingFilterInput Input;
+				Input.Time = Frame.Time;
+				Input.HandTransform = Frame.Transform;
+				Input.QualityOverride = Frame.Quality;
+				Input.bIsNewSample = Frame.bNewSample;
+
+				auto const Transform = Filter.FilterSample(Input);
+				auto const Location = Transform.GetLocation();
+				if (Frame.bHasTruth)
+				{
+					LagSum += FVector::DistSquared(Location, Frame.Truth);
+					++LagCount;
+				}
+
+				// the throw is solved the way UThrowingComponent::UpdateWithTrackingSample and GetThrowVector do in game
+				auto const bTracked = Frame.Quality != EHandTrackingDataQuality::Bad;
+				if (Frame.bNewSample)
+				{
+					ThrowSolver.AddSample(Frame.Time, Transform, bTracked);
+
+					// the velocity the solver reads from the buffer, against the ground truth across the neighbouring frames
+					auto const* const Previous = FrameIndex > 0 ? &Frames[FrameIndex - 1] : nullptr;
+					auto const* const Next = FrameIndex + 1 < Frames.Num() ? &Frames[FrameIndex + 1] : nullptr;
+					FTransformBufferData BufferData;
+					if (Previous && Next && Previous->bHasTruth && Next->bHasTruth && Next->Time - Previous->Time > UE_SMALL_NUMBER
+						&& ThrowSolver.GetSamples().Sample(ETransformSampleView::All, Frame.Time, BufferData)
+							== FTransformSampleBuffer::ESampleResult::Reliable)
+					{
+						auto const TruthVelocity = (Next->Truth - Previous->Truth) / (Next->Time - Previous->Time);
+						VelocityErrorSum += ((BufferData.Velocity - TruthVelocity) / 100).SizeSquared();
+						++VelocityCount;
+					}
+				}
+				ThrowSolver.UpdateTrackingState(Frame.Time, bTracked);
+				if (Frame.bRelease)
+				{
+					auto const ThrowVector = ThrowSolver.Solve(Frame.LookDirection, nullptr, -1).LinearVelocity.GetSafeNormal();
+					auto const Dot = ThrowVector.IsZero() ? -1.0 : FMath::Clamp(FVector::DotProduct(ThrowVector, Frame.ThrowDirection), -1.0, 1.0);
+					ThrowErrorSum += FMath::RadiansToDegrees(FMath::Acos(Dot));
+					++ThrowCount;
+				}
+
+				// the trajectory only advances on new samples, repeated frames would read as zero velocity
+				if (Frame.bNewSample || Times.IsEmpty())
+				{
+					Times.Add(Frame.Time);
+					Locations.Add(Location);
+				}
+				else
+				{
+					Locations.Last() = Location;
+				}
+			}
+
+			for (auto i = 1; i + 1 < Times.Num(); ++i)
+			{
+				auto const DeltaTime0 = Times[i] - Times[i - 1];
+				auto const DeltaTime1 = Times[i + 1] - Times[i];
+				if (DeltaTime0 <= UE_SMALL_NUMBER || DeltaTime1 <= UE_SMALL_NUMBER)
+				{
+					continue;
+				}
+				auto const Velocity0 = (Locations[i] - Locations[i - 1]) / DeltaTime0;
+				auto const Velocity1 = (Locations[i + 1] - Locations[i]) / DeltaTime1;
+				auto const Acceleration = (Velocity1 - Velocity0) / ((DeltaTime0 + DeltaTime1) / 2);
+				JitterSum += (Acceleration / 100).SizeSquared();
+				++JitterCount;
+			}
+		}
+
+		Result.Jitter = JitterCount > 0 ? FMath::Sqrt(JitterSum / JitterCount) : 0;
+		Result.Lag = LagCount > 0 ? FMath::Sqrt(LagSum / LagCount) : 0;
+		Result.ThrowError = ThrowCount > 0 ? ThrowErrorSum / ThrowCount : 0;
+		Result.VelocityError = VelocityCount > 0 ? FMath::Sqrt(VelocityErrorSum / VelocityCount) : 0;
+		Result.Score = Weights.Jitter * Result.Jitter + Weights.Lag * Result.Lag + Weights.Throw * Result.ThrowError +
+			Weights.Velocity * Result.VelocityError;
+		return Result;
+	}
+
+	bool ParseSweepParameter(FString const& Key, FString const& Value, FSweepParameter& Parameter)
+	{
+		FString Prefix, PropertyName;
+		if (!Key.Split(TEXT("."), &Prefix, &PropertyName))
+		{
+			return false;
+		}
+
+		UClass* Class;
+		if (Prefix.Equals(TEXT("Filter"), ESearchCase::IgnoreCase))
+		{
+			Class = UHandTrackingFilterComponent::StaticClass();
+		}
+		else if (Prefix.Equals(TEXT("Throw"), ESearchCase::IgnoreCase))
+		{
+			Class = UThrowingComponent::StaticClass();
+			Parameter.bThrow = true;
+		}
+		else
+		{
+			return false;
+		}
+
+		Parameter.Name = Key;
+		Parameter.Property = FindFProperty<FProperty>(Class, *PropertyName);
+		if (!Parameter.Property)
+		{
+			UE_LOG(LogHandTrackingTuning, Error, TEXT("ParseSweepParameter - %s has no property %s"), *Class->GetName(), *PropertyName);
+			return false;
+		}
+
+		Value.TrimQuotes().ParseIntoArray(Parameter.Values, TEXT(","));
+		return !Parameter.Values.IsEmpty();
+	}
+
+	bool ApplySetting(int32 Setting, TArray<FSweepParameter> const& Parameters, UObject* Filter, UObject* Throwing)
+	{
+		for (auto const& Parameter : Parameters)
+		{
+			auto const& Value = Parameter.Values[Setting % Parameter.Values.Num()];
+			Setting /= Parameter.Values.Num();
+
+			auto* const Object = Parameter.bThrow ? Throwing : Filter;
+			auto* const ValuePtr = Parameter.Property->ContainerPtrToValuePtr<void>(Object);
+			if (!Parameter.Property->ImportText_Direct(*Value, ValuePtr, Object, PPF_None))
+			{
+				UE_LOG(LogHandTrackingTuning, Error, TEXT("ApplySetting - cannot set %s to %s"), *Parameter.Name, *Value);
+				return false;
+			}
+		}
+		return true;
+	}
+
+	FString DescribeSetting(int32 Setting, TArray<FSweepParameter> const& Parameters, TCHAR const* Separator)
+	{
+		TArray<FString> Values;
+		for (auto const& Parameter : Parameters)
+		{
+			Values.Add(Parameter.Values[Setting % Parameter.Values.Num()]);
+			Setting /= Parameter.Values.Num();
+		}
+		return FString::Join(Values, Separator);
+	}
+}
+
+UHandTrackingSweepCommandlet::UHandTrackingSweepCommandlet()
+{
+	IsClient = false;
+	IsEditor = false;
+	IsServer = false;
+	LogToConsole = true;
+}
+
+int32 UHandTrackingSweepCommandlet::Main(const FString& Params)
+{
+	TArray<FString> Tokens, Switches;
+	TMap<FString, FString> ParamsMap;
+	ParseCommandLine(*Params, Tokens, Switches, ParamsMap);
+
+	auto const* SessionsDir = ParamsMap.Find(TEXT("Sessions"));
+	if (!SessionsDir)
+	{
+		UE_LOG(LogHandTrackingTuning, Error, TEXT("HandTrackingSweep - missing -Sessions=<dir>"));
+		return 1;
+	}
+
+	TArray<FString> SessionFiles;
+	IFileManager::Get().FindFiles(SessionFiles, *FPaths::Combine(*SessionsDir, TEXT("*.csv")), true, false);
+	SessionFiles.Sort();
+
+	TArray<FRecordedHandSession> Sessions;
+	for (auto const& SessionFile : SessionFiles)
+	{
+		FRecordedHandSession Session;
+		if (LoadSession(FPaths::Combine(*SessionsDir, SessionFile), Session))
+		{
+			Sessions.Add(MoveTemp(Session));
+		}
+	}
+	if (Sessions.IsEmpty())
+	{
+		UE_LOG(LogHandTrackingTuning, Error, TEXT("HandTrackingSweep - no usable sessions in %s"), **SessionsDir);
+		return 1;
+	}
+
+	TArray<FSweepParameter> Parameters;
+	int64 NumSettings = 1;
+	for (auto const& Param : ParamsMap)
+	{
+		FSweepParameter Parameter;
+		if (ParseSweepParameter(Param.Key, Param.Value, Parameter))
+		{
+			NumSettings *= Parameter.Values.Num();
+			Parameters.Add(MoveTemp(Parameter));
+		}
+		else if (Param.Key.StartsWith(TEXT("Filter.")) || Param.Key.StartsWith(TEXT("Throw.")))
+		{
+			return 1;
+		}
+	}
+	if (NumSettings > MAX_int32)
+	{
+		UE_LOG(LogHandTrackingTuning, Error, TEXT("HandTrackingSweep - %lld settings, reduce the parameter grid"), NumSettings);
+		return 1;
+	}
+	auto const SettingCount = static_cast<int32>(NumSettings);
+
+	FSweepWeights Weights;
+	FParse::Value(*Params, TEXT("JitterWeight="), Weights.Jitter);
+	FParse::Value(*Params, TEXT("LagWeight="), Weights.Lag);
+	FParse::Value(*Params, TEXT("ThrowWeight="), Weights.Throw);
+	FParse::Value(*Params, TEXT("VelocityWeight="), Weights.Velocity);
+
+	// settings never share objects, every ParallelFor task then only writes to its own filter
+	TArray<TStrongObjectPtr<UHandTrackingFilterComponent>> Filters;
+	TArray<TStrongObjectPtr<UThrowingComponent>> Throwings;
+	Filters.Reserve(SettingCount);
+	Throwings.Reserve(SettingCount);
+	for (auto Setting = 0; Setting < SettingCount; ++Setting)
+	{
+		Filters.Emplace(NewObject<UHandTrackingFilterComponent>(GetTransientPackage()));
+		Throwings.Emplace(NewObject<UThrowingComponent>(GetTransientPackage()));
+		if (!ApplySetting(Setting, Parameters, Filters.Last().Get(), Throwings.Last().Get()))
+		{
+			return 1;
+		}
+	}
+
+	UE_LOG(LogHandTrackingTuning, Display, TEXT("HandTrackingSweep - %d sessions, %d settings"), Sessions.Num(), SettingCount);
+
+	TArray<FSweepResult> Results;
+	Results.SetNum(SettingCount);
+	ParallelFor(Results.Num(), [&](int32 Setting)
+	{
+		Results[Setting] = EvaluateSetting(Setting, *Filters[Setting], *Throwings[Setting], Sessions, Weights);
+	});
+
+	Algo::SortBy(Results, &FSweepResult::Score);
+
+	TArray<FString> ParameterNames;
+	for (auto const& Parameter : Parameters)
+	{
+		ParameterNames.Add(Parameter.Name);
+	}
+
+	auto Report = FString::Printf(TEXT("Rank,Score,Jitter,Lag,ThrowError,VelocityError%s%s\n"),
+		Parameters.IsEmpty() ? TEXT("") : TEXT(","), *FString::Join(ParameterNames, TEXT(",")));
+	for (auto Rank = 0; Rank < Results.Num(); ++Rank)
+	{
+		auto const& Result = Results[Rank];
+		Report += FString::Printf(TEXT("%d,%f,%f,%f,%f,%f%s%s\n"), Rank + 1, Result.Score, Result.Jitter, Result.Lag,
+			Result.ThrowError, Result.VelocityError, Parameters.IsEmpty() ? TEXT("") : TEXT(","),
+			*DescribeSetting(Result.Setting, Parameters, TEXT(",")));
+	}
+
+	auto ReportFilename = FPaths::Combine(FPaths::ProjectSavedDir(), TEXT("HandTrackingTuning"), TEXT("SweepReport.csv"));
+	FParse::Value(*Params, TEXT("Report="), ReportFilename);
+	if (!FFileHelper::SaveStringToFile(Report, *ReportFilename))
+	{
+		UE_LOG(LogHandTrackingTuning, Error, TEXT("HandTrackingSweep - cannot write %s"), *ReportFilename);
+		return 1;
+	}
+
+	auto Top = 10;
+	FParse::Value(*Params, TEXT("Top="), Top);
+	for (auto Rank = 0; Rank < FMath::Min(Top, Results.Num()); ++Rank)
+	{
+		auto const& Result = Results[Rank];
+		UE_LOG(LogHandTrackingTuning, Display, TEXT("#%d score %.3f jitter %.3f lag %.3f throw %.2f velocity %.3f - %s"),
+			Rank + 1, Result.Score, Result.Jitter, Result.Lag, Result.ThrowError, Result.VelocityError, *DescribeSetting(Result.Setting, Parameters, TEXT(" ")));
+	}
+	UE_LOG(LogHandTrackingTuning, Display, TEXT("HandTrackingSweep - report written to %s"), *ReportFilename);
+	return 0;
+}
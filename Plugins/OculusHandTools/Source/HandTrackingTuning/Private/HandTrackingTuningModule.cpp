@@ -0,0 +1,7 @@
+// Copyright (c) Meta Platforms, Inc. and affiliates.
+
+#include "HandTrackingTuningModule.h"
+
+DEFINE_LOG_CATEGORY(LogHandTrackingTuning);
+
+IMPLEMENT_MODULE(FHandTrackingTuningModule, HandTrackingTuning)
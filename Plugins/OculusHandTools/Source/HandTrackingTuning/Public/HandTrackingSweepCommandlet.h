@@ -0,0 +1,37 @@
+// Copyright (c) Meta Platforms, Inc. and affiliates.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Commandlets/Commandlet.h"
+#include "HandTrackingSweepCommandlet.generated.h"
+
+/**
+ * Replays recorded hand tracking sessions through the hand tracking filter and the throw solver over a grid of
+ * parameter values, and writes a report ranking each setting by jitter, lag and throw direction error. Throws are
+ * solved by FThrowSolver from the filtered samples, as UThrowingComponent does in game.
+ *
+ * UnrealEditor-Cmd HandGameplay.uproject -run=HandTrackingSweep -Sessions=<dir>
+ *     -Filter.MaxAcceleration=50000,100000 -Filter.SmoothPositionFactor=0.75,0.875
+ *     -Throw.ThrowLatencyAdjustmentTimeSeconds=0.02,0.04,0.06
+ *     [-Report=<file>] [-JitterWeight=1] [-LagWeight=1] [-ThrowWeight=1] [-VelocityWeight=0] [-Top=10]
+ *
+ * Any property of HandTrackingFilterComponent (Filter.) or ThrowingComponent (Throw.) can be swept. For example, to
+ * benchmark the throw velocity estimation, compare the ThrowError and VelocityError of -Throw.VelocityFitWindow=2,5,7,9
+ * -Throw.VelocityFitOrder=1,2,3 where window 2 is the plain difference between the last two samples. VelocityError is
+ * the rms difference between the hand velocity read from the solver's FTransformSampleBuffer at each new sample and
+ * the ground truth velocity across the neighbouring frames, it needs the Truth columns and isn't scored by default.
+ * Sessions are CSV files with a header row. The Time, LocX/Y/Z and RotX/Y/Z/W columns are required. Quality (0 none,
+ * 1 good, 2 bad), NewSample (0/1), TruthX/Y/Z (ground truth location), LookX/Y/Z (look direction), Release (0/1) and
+ * ThrowX/Y/Z (ground truth throw direction on release rows) are optional.
+ */
+UCLASS()
+class UHandTrackingSweepCommandlet : public UCommandlet
+{
+	GENERATED_BODY()
+
+public:
+	UHandTrackingSweepCommandlet();
+
+	virtual int32 Main(const FString& Params) override;
+};
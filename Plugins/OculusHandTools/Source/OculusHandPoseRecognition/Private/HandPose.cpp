@@ -4,8 +4,12 @@
 #include "OculusXRInputFunctionLibrary.h"
 #include <limits>
 
-void FHandPose::UpdatePose(EOculusXRHandType Side, FRotator Wrist)
+bool FHandPose::UpdatePose(EOculusXRHandType Side, FRotator Wrist)
 {
+	FRotator PreviousRotations[NUM];
+	FMemory::Memcpy(PreviousRotations, Rotations, sizeof(Rotations));
+	auto const PreviousHand = Hand;
+
 	Hand = Side;
 	Rotations[Thumb_0] = UOculusXRInputFunctionLibrary::GetBoneRotation(Side, EOculusXRBone::Thumb_0).Rotator();
 	Rotations[Thumb_1] = UOculusXRInputFunctionLibrary::GetBoneRotation(Side, EOculusXRBone::Thumb_1).Rotator();
@@ -25,6 +29,8 @@ void FHandPose::UpdatePose(EOculusXRHandType Side, FRotator Wrist)
 	Rotations[Pinky_2] = UOculusXRInputFunctionLibrary::GetBoneRotation(Side, EOculusXRBone::Pinky_2).Rotator();
 	Rotations[Pinky_3] = UOculusXRInputFunctionLibrary::GetBoneRotation(Side, EOculusXRBone::Pinky_3).Rotator();
 	Rotations[ERecognizedBone::Wrist] = Wrist;
+
+	return PreviousHand != Hand || FMemory::Memcmp(PreviousRotations, Rotations, sizeof(Rotations)) != 0;
 }
 
 void FHandPose::Encode()
@@ -0,0 +1,126 @@
+// Copyright (c) Meta Platforms, Inc. and affiliates.
+
+#include "HandPoseCache.h"
+#include "OculusHandPoseRecognitionModule.h"
+
+namespace
+{
+	struct FCachedHandPose
+	{
+		FString PoseString;
+		FDecodedHandPose Decoded;
+		uint32 Generation = 0;
+		uint64 LastUse = 0;
+		bool bDecoded = false;
+		bool bPinned = false;
+	};
+
+	// pose strings that failed to decode are cached too, so they are only reported once while they are in use
+	TMap<FString, int32> PoseIndices;
+	TArray<FCachedHandPose> CachedPoses;
+	int32 NumUnpinned = 0;
+	uint64 UseCounter = 0;
+
+	int32 AddSlot()
+	{
+		if (NumUnpinned < FHandPoseCache::Capacity)
+		{
+			++NumUnpinned;
+			return CachedPoses.AddDefaulted();
+		}
+
+		// only misses get here, so a scan for the least recently used pose is fine
+		auto Oldest = INDEX_NONE;
+		for (auto i = 0; i < CachedPoses.Num(); ++i)
+		{
+			if (!CachedPoses[i].bPinned && (Oldest == INDEX_NONE || CachedPoses[i].LastUse < CachedPoses[Oldest].LastUse))
+			{
+				Oldest = i;
+			}
+		}
+		check(Oldest != INDEX_NONE);
+
+		auto& Evicted = CachedPoses[Oldest];
+		PoseIndices.Remove(Evicted.PoseString);
+		auto const Generation = Evicted.Generation + 1;
+		Evicted = FCachedHandPose();
+		Evicted.Generation = Generation;
+		return Oldest;
+	}
+
+	int32 FindOrAddIndex(FString const& PoseString)
+	{
+		check(IsInGameThread());
+
+		if (auto const* Index = PoseIndices.Find(PoseString))
+		{
+			CachedPoses[*Index].LastUse = ++UseCounter;
+			return *Index;
+		}
+
+		auto const Index = AddSlot();
+		auto& Cached = CachedPoses[Index];
+		Cached.PoseString = PoseString;
+		Cached.LastUse = ++UseCounter;
+		Cached.Decoded.Pose.CustomEncodedPose = PoseString;
+		Cached.bDecoded = Cached.Decoded.Pose.Decode();
+		if (Cached.bDecoded)
+		{
+			for (auto Bone = 0; Bone < NUM; ++Bone)
+			{
+				Cached.Decoded.Rotations[Bone] = Cached.Decoded.Pose.GetRotator(static_cast<ERecognizedBone>(Bone)).Quaternion();
+			}
+		}
+		else
+		{
+			UE_LOG(LogHandPoseRecognition, Warning, TEXT("Pose string '%s' can not be decoded."), *PoseString);
+		}
+
+		PoseIndices.Add(PoseString, Index);
+		return Index;
+	}
+
+	FHandPoseId ToId(int32 Index)
+	{
+		auto const& Cached = CachedPoses[Index];
+		return Cached.bDecoded ? FHandPoseId{Index, Cached.Generation} : FHandPoseId();
+	}
+}
+
+FHandPoseId FHandPoseCache::FindOrAdd(FString const& PoseString)
+{
+	return ToId(FindOrAddIndex(PoseString));
+}
+
+FHandPoseId FHandPoseCache::Pin(FString const& PoseString)
+{
+	auto const Index = FindOrAddIndex(PoseString);
+	auto& Cached = CachedPoses[Index];
+
+	// a pinned pose no longer counts towards the capacity, failures aren't worth keeping
+	if (Cached.bDecoded && !Cached.bPinned)
+	{
+		Cached.bPinned = true;
+		--NumUnpinned;
+	}
+	return ToId(Index);
+}
+
+FDecodedHandPose const* FHandPoseCache::Find(FHandPoseId PoseId)
+{
+	check(IsInGameThread());
+	if (!CachedPoses.IsValidIndex(PoseId.Index))
+	{
+		return nullptr;
+	}
+
+	auto& Cached = CachedPoses[PoseId.Index];
+	if (!Cached.bDecoded || Cached.Generation != PoseId.Generation)
+	{
+		return nullptr;
+	}
+
+	// handles applied every frame keep their pose from being evicted
+	Cached.LastUse = ++UseCounter;
+	return &Cached.Decoded;
+}
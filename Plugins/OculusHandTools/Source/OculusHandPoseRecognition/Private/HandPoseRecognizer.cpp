@@ -22,6 +22,12 @@ UHandPoseRecognizer::UHandPoseRecognizer(const FObjectInitializer& ObjectInitial
 	CurrentHandPoseConfidence = 0.0f;
 	CurrentHandPoseError = std::numeric_limits<float>::max();
 
+	// Closest pattern match cache
+	LastSampleClosestHandPose = -1;
+	LastSampleClosestHandPoseConfidence = 0.0f;
+	LastSampleClosestHandPoseError = std::numeric_limits<float>::max();
+	bHasLastSampleResult = false;
+
 	// Encoded hand pose logged index
 	LoggedIndex = 0;
 }
@@ -83,12 +89,43 @@ void UHandPoseRecognizer::TickComponent(float DeltaTime, ELevelTick TickType, FA
 
 	// Updating tracked hand.
 	// Note that the wrist rotation pitch and roll are world relative, and the yaw is hmd relative.
-	Pose.UpdatePose(Side, GetWristRotator(GetComponentQuat()));
+	auto const bIsNewSample = Pose.UpdatePose(Side, GetWristRotator(GetComponentQuat()));
+
+	// The pattern matching only depends on the pose, so it is skipped until tracking delivers new data.
+	if (bIsNewSample || !bHasLastSampleResult)
+	{
+		FindClosestHandPose(LastSampleClosestHandPose, LastSampleClosestHandPoseConfidence, LastSampleClosestHandPoseError);
+		bHasLastSampleResult = true;
+	}
+
+	auto const ClosestHandPose = LastSampleClosestHandPose;
+	auto const ClosestHandPoseConfidence = LastSampleClosestHandPoseConfidence;
+	auto const ClosestHandPoseError = LastSampleClosestHandPoseError;
 
+	if (CurrentHandPose == ClosestHandPose)
+	{
+		// Same pose as before is being held
+		CurrentHandPoseDuration += TimeSinceLastRecognition;
+		TimeSinceLastRecognition = 0.0;
+		CurrentHandPoseConfidence = DampingFactor * CurrentHandPoseConfidence + (1.0f - DampingFactor) * ClosestHandPoseConfidence;
+		CurrentHandPoseError = DampingFactor * CurrentHandPoseError + (1.0f - DampingFactor) * ClosestHandPoseError;
+	}
+	else
+	{
+		// Change of pose
+		CurrentHandPose = ClosestHandPose;
+		CurrentHandPoseDuration = 0.0f;
+		CurrentHandPoseConfidence = ClosestHandPoseConfidence;
+		CurrentHandPoseError = ClosestHandPoseError;
+	}
+}
+
+void UHandPoseRecognizer::FindClosestHandPose(int& ClosestHandPose, float& ClosestHandPoseConfidence, float& ClosestHandPoseError) const
+{
 	// Finding closest pattern
-	auto ClosestHandPose = -1;
-	auto ClosestHandPoseConfidence = DefaultConfidenceFloor;
-	auto ClosestHandPoseError = std::numeric_limits<float>::max();
+	ClosestHandPose = -1;
+	ClosestHandPoseConfidence = DefaultConfidenceFloor;
+	ClosestHandPoseError = std::numeric_limits<float>::max();
 	auto HighestConfidence = 0.0f;
 
 	for (auto PatternIndex = 0; PatternIndex < Poses.Num(); ++PatternIndex)
@@ -125,23 +162,6 @@ void UHandPoseRecognizer::TickComponent(float DeltaTime, ELevelTick TickType, FA
 	{
 		ClosestHandPoseConfidence = HighestConfidence;
 	}
-
-	if (CurrentHandPose == ClosestHandPose)
-	{
-		// Same pose as before is being held
-		CurrentHandPoseDuration += TimeSinceLastRecognition;
-		TimeSinceLastRecognition = 0.0;
-		CurrentHandPoseConfidence = DampingFactor * CurrentHandPoseConfidence + (1.0f - DampingFactor) * ClosestHandPoseConfidence;
-		CurrentHandPoseError = DampingFactor * CurrentHandPoseError + (1.0f - DampingFactor) * ClosestHandPoseError;
-	}
-	else
-	{
-		// Change of pose
-		CurrentHandPose = ClosestHandPose;
-		CurrentHandPoseDuration = 0.0f;
-		CurrentHandPoseConfidence = ClosestHandPoseConfidence;
-		CurrentHandPoseError = ClosestHandPoseError;
-	}
 }
 
 bool UHandPoseRecognizer::GetRecognizedHandPose(int& Index, FString& Name, float& Duration, float& Error, float& Confidence)
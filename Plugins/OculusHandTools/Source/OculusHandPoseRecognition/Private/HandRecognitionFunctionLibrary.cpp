@@ -55,3 +55,13 @@ void UHandRecognitionFunctionLibrary::RecordHandPose(UObject* WorldContextObject
 		}
 	}
 }
+
+FHandPoseId UHandRecognitionFunctionLibrary::GetHandPoseId(FString PoseString)
+{
+	return FHandPoseCache::Pin(PoseString);
+}
+
+bool UHandRecognitionFunctionLibrary::IsValidHandPoseId(FHandPoseId PoseId)
+{
+	return FHandPoseCache::Find(PoseId) != nullptr;
+}
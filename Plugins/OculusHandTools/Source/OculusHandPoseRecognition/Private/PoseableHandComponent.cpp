@@ -1,8 +1,34 @@
 // Copyright (c) Meta Platforms, Inc. and affiliates.
 
 #include "PoseableHandComponent.h"
+#include "HandPoseCache.h"
 #include "OculusHandPoseRecognitionModule.h"
 
+namespace
+{
+	// the tracked bone of every finger bone that can be posed
+	EOculusXRBone const PosedBones[Wrist] =
+	{
+		EOculusXRBone::Thumb_0,
+		EOculusXRBone::Thumb_1,
+		EOculusXRBone::Thumb_2,
+		EOculusXRBone::Thumb_3,
+		EOculusXRBone::Index_1,
+		EOculusXRBone::Index_2,
+		EOculusXRBone::Index_3,
+		EOculusXRBone::Middle_1,
+		EOculusXRBone::Middle_2,
+		EOculusXRBone::Middle_3,
+		EOculusXRBone::Ring_1,
+		EOculusXRBone::Ring_2,
+		EOculusXRBone::Ring_3,
+		EOculusXRBone::Pinky_0,
+		EOculusXRBone::Pinky_1,
+		EOculusXRBone::Pinky_2,
+		EOculusXRBone::Pinky_3,
+	};
+}
+
 void UPoseableHandComponent::BeginPlay()
 {
 	if (GetSkinnedAsset() != nullptr)
@@ -17,84 +43,170 @@ void UPoseableHandComponent::TickComponent(float DeltaTime, enum ELevelTick Tick
 {
 	Super::TickComponent(DeltaTime, TickType, ThisTickFunction);
 
-	if (CustomPoseWeightCurrent != CustomPoseWeightTarget)
+	if (Layers.IsEmpty())
 	{
-		CustomPoseWeightCurrent = FMath::FInterpConstantTo(CustomPoseWeightCurrent, CustomPoseWeightTarget, DeltaTime, CustomPoseWeightLerpSpeed);
+		return;
 	}
 
-	if (CustomPoseWeightCurrent > 0.f)
+	for (auto& Layer : Layers)
 	{
-		UpdateBonePose(EOculusXRBone::Thumb_0, Thumb_0);
-		UpdateBonePose(EOculusXRBone::Thumb_1, Thumb_1);
-		UpdateBonePose(EOculusXRBone::Thumb_2, Thumb_2);
-		UpdateBonePose(EOculusXRBone::Thumb_3, Thumb_3);
-
-		UpdateBonePose(EOculusXRBone::Index_1, Index_1);
-		UpdateBonePose(EOculusXRBone::Index_2, Index_2);
-		UpdateBonePose(EOculusXRBone::Index_3, Index_3);
-
-		UpdateBonePose(EOculusXRBone::Middle_1, Middle_1);
-		UpdateBonePose(EOculusXRBone::Middle_2, Middle_2);
-		UpdateBonePose(EOculusXRBone::Middle_3, Middle_3);
-
-		UpdateBonePose(EOculusXRBone::Ring_1, Ring_1);
-		UpdateBonePose(EOculusXRBone::Ring_2, Ring_2);
-		UpdateBonePose(EOculusXRBone::Ring_3, Ring_3);
-
-		UpdateBonePose(EOculusXRBone::Pinky_0, Pinky_0);
-		UpdateBonePose(EOculusXRBone::Pinky_1, Pinky_1);
-		UpdateBonePose(EOculusXRBone::Pinky_2, Pinky_2);
-		UpdateBonePose(EOculusXRBone::Pinky_3, Pinky_3);
+		if (Layer.WeightCurrent != Layer.WeightTarget)
+		{
+			Layer.WeightCurrent = FMath::FInterpConstantTo(Layer.WeightCurrent, Layer.WeightTarget, DeltaTime, Layer.LerpSpeed);
+		}
+	}
+
+	auto const NumLayers = Layers.Num();
+	Layers.RemoveAll([](FCustomPoseLayer const& Layer) { return Layer.WeightCurrent <= 0.f && Layer.WeightTarget <= 0.f; });
+	bActiveBonesDirty |= Layers.Num() != NumLayers;
+
+	if (!Layers.IsEmpty())
+	{
+		BlendActiveBones();
 	}
 }
 
-void UPoseableHandComponent::UpdateBonePose(EOculusXRBone Bone, ERecognizedBone PosedBone)
+void UPoseableHandComponent::BlendActiveBones()
 {
-	auto BoneIndex = (int)Bone;
+	if (!bBoneIndicesResolved || ResolvedSkinnedAsset != TObjectKey<USkinnedAsset>(GetSkinnedAsset()))
+	{
+		ResolveBoneIndices();
+	}
+	if (bActiveBonesDirty)
+	{
+		UpdateActiveBones();
+	}
 
-	if (bCustomPoseableHandMesh && BoneNameMappings.Contains(Bone))
+	for (auto const Bone : ActiveBones)
 	{
-		auto const MappedBoneIndex = GetSkinnedAsset()->GetRefSkeleton().FindBoneIndex(BoneNameMappings[Bone]);
-		if (MappedBoneIndex != INDEX_NONE)
+		auto const BoneIndex = BoneIndices[Bone];
+		if (!BoneSpaceTransforms.IsValidIndex(BoneIndex))
+		{
+			continue;
+		}
+
+		// blend every layer over the tracked rotation in one pass, then write the bone once
+		auto Rotation = BoneSpaceTransforms[BoneIndex].GetRotation();
+		for (auto const& Layer : Layers)
 		{
-			BoneIndex = MappedBoneIndex;
+			auto const Weight = Layer.BoneWeights[Bone] * Layer.LayerWeight * Layer.WeightCurrent;
+			if (Weight > 0.f)
+			{
+				Rotation = FQuat::Slerp(Rotation, Layer.Rotations[Bone], Weight);
+			}
 		}
+		BoneSpaceTransforms[BoneIndex].SetRotation(Rotation);
 	}
+}
 
-	if (BoneSpaceTransforms.Num() > BoneIndex)
+void UPoseableHandComponent::ResolveBoneIndices()
+{
+	auto const* SkinnedAsset = GetSkinnedAsset();
+	for (auto Bone = 0; Bone < Wrist; ++Bone)
 	{
-		auto const TrackedRotation = BoneSpaceTransforms[BoneIndex].GetRotation();
-		auto const PosedRotation = CustomPose.GetRotator(PosedBone).Quaternion();
-		auto const PosedWeight = CustomPose.GetWeight(PosedBone) * CustomPoseWeightCurrent;
+		auto BoneIndex = static_cast<int32>(PosedBones[Bone]);
+		if (bCustomPoseableHandMesh && SkinnedAsset)
+		{
+			if (auto const* BoneName = BoneNameMappings.Find(PosedBones[Bone]))
+			{
+				auto const MappedBoneIndex = SkinnedAsset->GetRefSkeleton().FindBoneIndex(*BoneName);
+				if (MappedBoneIndex != INDEX_NONE)
+				{
+					BoneIndex = MappedBoneIndex;
+				}
+			}
+		}
+		BoneIndices[Bone] = BoneIndex;
+	}
 
-		if (PosedWeight > 0)
+	ResolvedSkinnedAsset = SkinnedAsset;
+	bBoneIndicesResolved = true;
+}
+
+void UPoseableHandComponent::UpdateActiveBones()
+{
+	ActiveBones.Reset();
+	for (auto Bone = 0; Bone < Wrist; ++Bone)
+	{
+		for (auto const& Layer : Layers)
 		{
-			auto const NewRotation = FQuat::Slerp(TrackedRotation, PosedRotation, PosedWeight);
-			BoneSpaceTransforms[BoneIndex].SetRotation(NewRotation);
+			if (Layer.BoneWeights[Bone] > 0.f && Layer.LayerWeight > 0.f)
+			{
+				ActiveBones.Add(static_cast<ERecognizedBone>(Bone));
+				break;
+			}
 		}
 	}
+	bActiveBonesDirty = false;
 }
 
+UPoseableHandComponent::FCustomPoseLayer* UPoseableHandComponent::FindOrAddLayer(int32 Layer)
+{
+	auto Index = 0;
+	for (; Index < Layers.Num() && Layers[Index].Layer <= Layer; ++Index)
+	{
+		if (Layers[Index].Layer == Layer)
+		{
+			return &Layers[Index];
+		}
+	}
+
+	auto& NewLayer = Layers.InsertDefaulted_GetRef(Index);
+	NewLayer.Layer = Layer;
+	return &NewLayer;
+}
 
 void UPoseableHandComponent::SetPose(FString PoseString, float LerpSpeedOverride)
 {
-	CustomPose.CustomEncodedPose = PoseString;
+	SetPoseLayer(0, PoseString, 1.f, LerpSpeedOverride);
+}
 
+void UPoseableHandComponent::SetPoseById(FHandPoseId PoseId, float LerpSpeedOverride)
+{
+	SetPoseLayerById(0, PoseId, 1.f, LerpSpeedOverride);
+}
 
-	if (CustomPose.Decode())
+void UPoseableHandComponent::ClearPose(float LerpSpeedOverride)
+{
+	ClearPoseLayer(0, LerpSpeedOverride);
+}
+
+void UPoseableHandComponent::SetPoseLayer(int32 Layer, FString PoseString, float LayerWeight, float LerpSpeedOverride)
+{
+	// the cache reports strings that can't be decoded
+	SetPoseLayerById(Layer, FHandPoseCache::FindOrAdd(PoseString), LayerWeight, LerpSpeedOverride);
+}
+
+void UPoseableHandComponent::SetPoseLayerById(int32 Layer, FHandPoseId PoseId, float LayerWeight, float LerpSpeedOverride)
+{
+	auto const* Decoded = FHandPoseCache::Find(PoseId);
+	if (Decoded == nullptr)
 	{
-		CustomPoseWeightTarget = 1.f;
-		CustomPoseWeightCurrent = 0.f;
-		CustomPoseWeightLerpSpeed = LerpSpeedOverride > 0 ? LerpSpeedOverride : DefaultLerpSpeed;
+		return;
 	}
-	else
+
+	// the pose is converted once here, blending then only reads the resolved rotations and weights
+	auto& PoseLayer = *FindOrAddLayer(Layer);
+	for (auto Bone = 0; Bone < Wrist; ++Bone)
 	{
-		UE_LOG(LogHandPoseRecognition, Warning, TEXT("Pose string '%s' can not be decoded."), *PoseString);
+		PoseLayer.Rotations[Bone] = Decoded->Rotations[Bone];
+		PoseLayer.BoneWeights[Bone] = Decoded->Pose.GetWeight(static_cast<ERecognizedBone>(Bone));
 	}
+	PoseLayer.LayerWeight = FMath::Clamp(LayerWeight, 0.f, 1.f);
+	PoseLayer.WeightTarget = 1.f;
+	PoseLayer.WeightCurrent = 0.f;
+	PoseLayer.LerpSpeed = LerpSpeedOverride > 0 ? LerpSpeedOverride : DefaultLerpSpeed;
+	bActiveBonesDirty = true;
 }
 
-void UPoseableHandComponent::ClearPose(float LerpSpeedOverride)
+void UPoseableHandComponent::ClearPoseLayer(int32 Layer, float LerpSpeedOverride)
 {
-	CustomPoseWeightTarget = 0.f;
-	CustomPoseWeightLerpSpeed = LerpSpeedOverride > 0 ? LerpSpeedOverride : DefaultLerpSpeed;
+	for (auto& PoseLayer : Layers)
+	{
+		if (PoseLayer.Layer == Layer)
+		{
+			PoseLayer.WeightTarget = 0.f;
+			PoseLayer.LerpSpeed = LerpSpeedOverride > 0 ? LerpSpeedOverride : DefaultLerpSpeed;
+		}
+	}
 }
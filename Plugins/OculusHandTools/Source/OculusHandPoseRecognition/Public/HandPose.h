@@ -91,8 +91,9 @@ public:
 	 *
 	 * @param Side - EOculusXRHandType to track
 	 * @param Wrist - FRotator from the controller.
+	 * @return True if any bone rotation differs from the previous update (ie. tracking produced a new sample).
 	 */
-	void UpdatePose(EOculusXRHandType Hand, FRotator Wrist);
+	bool UpdatePose(EOculusXRHandType Hand, FRotator Wrist);
 
 	/** Encodes rotators to string form, without weights. */
 	void Encode();
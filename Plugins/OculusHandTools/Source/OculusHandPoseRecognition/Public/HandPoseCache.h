@@ -0,0 +1,60 @@
+// Copyright (c) Meta Platforms, Inc. and affiliates.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "HandPose.h"
+#include "HandPoseCache.generated.h"
+
+/**
+ * Handle to a pose decoded by FHandPoseCache. Handles from GetHandPoseId stay valid for the lifetime of the process,
+ * the others until the pose is evicted from the cache.
+ */
+USTRUCT(BlueprintType)
+struct OCULUSHANDPOSERECOGNITION_API FHandPoseId
+{
+	GENERATED_BODY()
+
+	UPROPERTY(Transient)
+	int32 Index = INDEX_NONE;
+
+	/** Which pose held the cache slot, so handles to an evicted pose don't find the pose that replaced it. */
+	UPROPERTY(Transient)
+	uint32 Generation = 0;
+
+	bool IsValid() const { return Index != INDEX_NONE; }
+
+	bool operator==(FHandPoseId const& Other) const { return Index == Other.Index && Generation == Other.Generation; }
+	bool operator!=(FHandPoseId const& Other) const { return !(*this == Other); }
+};
+
+/** A hand pose with its rotators already converted to quaternions. */
+struct OCULUSHANDPOSERECOGNITION_API FDecodedHandPose
+{
+	FHandPose Pose;
+	FQuat Rotations[NUM];
+};
+
+/**
+ * Decodes each pose string once, so custom poses that have to be re-applied every frame cost a lookup instead of a
+ * parse. Pinned poses are kept for the lifetime of the process; the others, including the strings that can't be
+ * decoded, are evicted least recently used first once there are Capacity of them. Game thread only.
+ */
+class OCULUSHANDPOSERECOGNITION_API FHandPoseCache
+{
+public:
+	/** How many poses that aren't pinned are kept. */
+	static constexpr int32 Capacity = 256;
+
+	/// Returns the handle of the decoded pose string, decoding it if it isn't cached. Invalid if it can't be decoded.
+	static FHandPoseId FindOrAdd(FString const& PoseString);
+
+	/// FindOrAdd, keeping the pose for the lifetime of the process, for handles held on to such as compiled grab poses.
+	static FHandPoseId Pin(FString const& PoseString);
+
+	/// Returns the decoded pose of a handle, or nullptr for an invalid or evicted handle. Don't keep the pointer around.
+	static FDecodedHandPose const* Find(FHandPoseId PoseId);
+
+	/// Shorthand for Find(FindOrAdd(PoseString)).
+	static FDecodedHandPose const* FindOrDecode(FString const& PoseString) { return Find(FindOrAdd(PoseString)); }
+};
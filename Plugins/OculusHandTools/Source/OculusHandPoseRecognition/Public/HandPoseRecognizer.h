@@ -89,6 +89,15 @@ protected:
 	FRotator GetWristRotator(FQuat ComponentQuat) const;
 
 private:
+	/** Finds the closest pose pattern to the current pose. */
+	void FindClosestHandPose(int& ClosestHandPose, float& ClosestHandPoseConfidence, float& ClosestHandPoseError) const;
+
+	/** Closest pattern match for the last tracking sample, reused while tracking has no new data. */
+	int LastSampleClosestHandPose;
+	float LastSampleClosestHandPoseConfidence;
+	float LastSampleClosestHandPoseError;
+	bool bHasLastSampleResult;
+
 	/** Recognition state. */
 	float TimeSinceLastRecognition;
 	int CurrentHandPose;
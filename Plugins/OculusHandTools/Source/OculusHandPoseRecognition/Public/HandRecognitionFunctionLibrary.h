@@ -4,6 +4,7 @@
 
 #include "CoreMinimal.h"
 #include "Kismet/BlueprintFunctionLibrary.h"
+#include "HandPoseCache.h"
 #include "HandRecognitionFunctionLibrary.generated.h"
 
 class UHandPoseRecognizer;
@@ -100,4 +101,20 @@ public:
 	 */
 	UFUNCTION(BlueprintCallable, meta = (Latent, LatentInfo = "LatentInfo", WorldContext = "WorldContextObject", ExpandEnumAsExecs = "InExecs,OutExecs"), Category = "Hand Recognition")
 	static void RecordHandPose(UObject* WorldContextObject, UHandPoseRecognizer* Recognizer, const ERecordHandPoseEntryType& InExecs, ERecordHandPoseExitType& OutExecs, FLatentActionInfo LatentInfo);
+
+	/**
+	 * Decodes a hand pose string once and returns a handle to it, for poses that are applied every frame. The pose is
+	 * kept for the lifetime of the process, so the handle stays valid.
+	 * @param PoseString - Encoded hand pose.
+	 * @return The pose handle, invalid if the string can not be decoded.
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Hand Recognition")
+	static FHandPoseId GetHandPoseId(FString PoseString);
+
+	/**
+	 * @param PoseId - Hand pose handle.
+	 * @return True if the handle refers to a decoded pose.
+	 */
+	UFUNCTION(BlueprintPure, Category = "Hand Recognition")
+	static bool IsValidHandPoseId(FHandPoseId PoseId);
 };
@@ -5,6 +5,8 @@
 #include "CoreMinimal.h"
 #include "OculusXRHandComponent.h"
 #include "HandPose.h"
+#include "HandPoseCache.h"
+#include "UObject/ObjectKey.h"
 
 #include "PoseableHandComponent.generated.h"
 
@@ -18,12 +20,33 @@ public:
 
 	virtual void TickComponent(float DeltaTime, enum ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction) override;
 
+	/// Blends a custom pose in on layer 0.
 	UFUNCTION(BlueprintCallable)
 	void SetPose(FString PoseString, float LerpSpeedOverride = -1.f);
 
+	/// SetPose with a handle from GetHandPoseId, e.g. a compiled grab pose, so the pose string isn't looked up.
+	UFUNCTION(BlueprintCallable)
+	void SetPoseById(FHandPoseId PoseId, float LerpSpeedOverride = -1.f);
+
+	/// Blends the custom pose of layer 0 out.
 	UFUNCTION(BlueprintCallable)
 	void ClearPose(float LerpSpeedOverride = -1.f);
 
+	/**
+	 * Blends a custom pose in on a layer. Layers are blended over hand tracking in increasing order, each bone with the
+	 * weight encoded in the pose string scaled by LayerWeight.
+	 */
+	UFUNCTION(BlueprintCallable)
+	void SetPoseLayer(int32 Layer, FString PoseString, float LayerWeight = 1.f, float LerpSpeedOverride = -1.f);
+
+	/// SetPoseLayer with a handle from GetHandPoseId.
+	UFUNCTION(BlueprintCallable)
+	void SetPoseLayerById(int32 Layer, FHandPoseId PoseId, float LayerWeight = 1.f, float LerpSpeedOverride = -1.f);
+
+	/// Blends the custom pose of a layer out.
+	UFUNCTION(BlueprintCallable)
+	void ClearPoseLayer(int32 Layer, float LerpSpeedOverride = -1.f);
+
 	UPROPERTY(EditAnywhere, BlueprintReadWrite)
 	float DefaultLerpSpeed = 10.f;
 
@@ -31,11 +54,33 @@ protected:
 	bool bCustomPoseableHandMesh = false;
 
 private:
-	void UpdateBonePose(EOculusXRBone Bone, ERecognizedBone PosedBone);
+	/** Custom pose resolved for blending, only the finger bones are posed. */
+	struct FCustomPoseLayer
+	{
+		int32 Layer = 0;
+		float WeightCurrent = 0.f;
+		float WeightTarget = 0.f;
+		float LerpSpeed = 0.f;
+		float LayerWeight = 1.f;
+
+		FQuat Rotations[Wrist];
+		float BoneWeights[Wrist] = {};
+	};
+
+	FCustomPoseLayer* FindOrAddLayer(int32 Layer);
+	void ResolveBoneIndices();
+	void UpdateActiveBones();
+	void BlendActiveBones();
+
+	/// sorted by layer, layers are removed once blended out
+	TArray<FCustomPoseLayer, TInlineAllocator<2>> Layers;
 
-	float CustomPoseWeightCurrent;
-	float CustomPoseWeightTarget;
-	float CustomPoseWeightLerpSpeed;
+	/// finger bones weighted by at least one layer
+	TArray<ERecognizedBone, TInlineAllocator<Wrist>> ActiveBones;
+	bool bActiveBonesDirty = false;
 
-	FHandPose CustomPose;
+	/// BoneSpaceTransforms index of every finger bone, resolved for ResolvedSkinnedAsset
+	int32 BoneIndices[Wrist];
+	TObjectKey<USkinnedAsset> ResolvedSkinnedAsset;
+	bool bBoneIndicesResolved = false;
 };
@@ -26,6 +26,7 @@ public class OculusInteractable : ModuleRules
 			new string[]
 			{
 				"Core",
+				"OculusHandPoseRecognition",
 				// ... add other public dependencies that you statically link with here ...
 			}
 			);
@@ -3,60 +3,132 @@
 #include "HandGrabbingComponent.h"
 
 #include "Interactable.h"
+#include "InteractableSubsystem.h"
 #include "Engine/OverlapResult.h"
+#include "PhysicsEngine/PhysicsHandleComponent.h"
+
+UHandGrabbingComponent::UHandGrabbingComponent()
+{
+	// Only ticks while holding with the physics handle, to move its target.
+	PrimaryComponentTick.bCanEverTick = true;
+	PrimaryComponentTick.bStartWithTickEnabled = false;
+}
+
+void UHandGrabbingComponent::TickComponent(float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction)
+{
+	Super::TickComponent(DeltaTime, TickType, ThisTickFunction);
+
+	if (bHoldingWithPhysicsHandle && PhysicsHandle)
+	{
+		auto const Target = HoldTransform * GetComponentTransform();
+		PhysicsHandle->SetTargetLocationAndRotation(Target.GetLocation(), Target.Rotator());
+	}
+}
+
+void UHandGrabbingComponent::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	// The physics handle belongs to our owner, and would keep holding.
+	if (bHoldingWithPhysicsHandle)
+	{
+		TryRelease();
+	}
+
+	Super::EndPlay(EndPlayReason);
+}
 
 AInteractable* UHandGrabbingComponent::TryGrab(FTransform GrabTransform)
 {
-	auto HitResults = TArray<FOverlapResult>{};
-	auto QueryParams = FCollisionQueryParams::DefaultQueryParam;
-	auto ResponseParams = FCollisionResponseParams(ECR_Overlap);
+	auto ClosestInteractable = (AInteractable*)nullptr;
+	auto DistanceToClosestInteractable = 0.0f;
 
-	GetWorld()->OverlapMultiByChannel(HitResults, GrabTransform.GetLocation(), GrabTransform.GetRotation(), ECC_WorldDynamic, FCollisionShape::MakeCapsule(GrabCapsuleRadius, GrabCapsuleHeight / 2.f), FCollisionQueryParams::DefaultQueryParam, ResponseParams);
+	auto ConsiderInteractable = [&](AInteractable* Interactable)
+	{
+		auto Distance = FVector::Dist(GrabTransform.GetLocation(), Interactable->GetActorLocation());
+		if (ClosestInteractable == nullptr || Distance < DistanceToClosestInteractable)
+		{
+			ClosestInteractable = Interactable;
+			DistanceToClosestInteractable = Distance;
+		}
+	};
+
+	auto Registry = bUseInteractableRegistry ? GetWorld()->GetSubsystem<UInteractableSubsystem>() : nullptr;
+	if (Registry)
+	{
+		// The capsule's axis is the grab transform's Z axis, as with FCollisionShape::MakeCapsule.
+		auto const HalfSegment = GrabTransform.GetRotation().GetUpVector() * FMath::Max(GrabCapsuleHeight / 2.f - GrabCapsuleRadius, 0.f);
+		auto Found = TArray<FRegisteredInteractable>{};
+		Registry->QueryCapsule(GrabTransform.GetLocation() - HalfSegment, GrabTransform.GetLocation() + HalfSegment, GrabCapsuleRadius, Found);
 
-	if (HitResults.Num() > 0)
+		// The registry's bounding spheres are loose, test the candidates as the overlap query below would.
+		auto const GrabCapsule = FCollisionShape::MakeCapsule(GrabCapsuleRadius, GrabCapsuleHeight / 2.f);
+		for (auto&& Registered : Found)
+		{
+			if ((Registered.GetSelectionFlags() & EInteractableSelectionFlags::Movable)
+				&& UInteractableSubsystem::OverlapInteractable(Registered.Interactable, ECC_WorldDynamic, GrabTransform.GetLocation(), GrabTransform.GetRotation(), GrabCapsule))
+			{
+				ConsiderInteractable(Registered.Interactable);
+			}
+		}
+	}
+	else
 	{
-		auto ClosestInteractable = (AInteractable*)nullptr;
-		auto DistanceToClosestInteractable = 0.0f;
+		auto HitResults = TArray<FOverlapResult>{};
+		auto ResponseParams = FCollisionResponseParams(ECR_Overlap);
+
+		GetWorld()->OverlapMultiByChannel(HitResults, GrabTransform.GetLocation(), GrabTransform.GetRotation(), ECC_WorldDynamic, FCollisionShape::MakeCapsule(GrabCapsuleRadius, GrabCapsuleHeight / 2.f), FCollisionQueryParams::DefaultQueryParam, ResponseParams);
+
 		for (auto&& HitResult : HitResults)
 		{
 			if (auto HitActor = HitResult.GetActor())
 			{
 				auto Interactable = Cast<AInteractable>(HitActor);
-				if (Interactable && Interactable->IsMovable())
+				if (Interactable && (Interactable->GetSelectionFlags() & EInteractableSelectionFlags::Movable))
 				{
-					auto Distance = FVector::Dist(GrabTransform.GetLocation(), Interactable->GetActorLocation());
-					if (ClosestInteractable == nullptr || Distance < DistanceToClosestInteractable)
-					{
-						ClosestInteractable = Interactable;
-						DistanceToClosestInteractable = Distance;
-					}
+					ConsiderInteractable(Interactable);
 				}
 			}
 		}
+	}
 
-		if (ClosestInteractable)
-		{
-			auto InteractableRoot = ClosestInteractable->GetRootComponent();
+	if (ClosestInteractable)
+	{
+		auto InteractableRoot = ClosestInteractable->GetRootComponent();
 
-			if (auto OtherHand = Cast<UHandGrabbingComponent>(InteractableRoot->GetAttachParent()))
+		if (auto OtherHand = Cast<UHandGrabbingComponent>(InteractableRoot->GetAttachParent()))
+		{
+			OtherHand->TryRelease();
+		}
+		else if (auto Owner = GetOwner())
+		{
+			// Actors held with a physics handle are not attached to the hand.
+			for (auto Hand : Owner->GetComponents())
 			{
-				OtherHand->TryRelease();
+				auto HandGrabbing = Cast<UHandGrabbingComponent>(Hand);
+				if (HandGrabbing && HandGrabbing != this && HandGrabbing->GrabbedActor == ClosestInteractable)
+				{
+					HandGrabbing->TryRelease();
+				}
 			}
+		}
 
-			if (InteractableRoot != nullptr)
+		if (InteractableRoot != nullptr)
+		{
+			auto GrabbedPrimitive = Cast<UPrimitiveComponent>(ClosestInteractable->GetRootComponent());
+			if(GrabbedPrimitive != nullptr && GrabbedPrimitive->IsSimulatingPhysics())
 			{
-				auto GrabbedPrimitive = Cast<UPrimitiveComponent>(ClosestInteractable->GetRootComponent());
-				if(GrabbedPrimitive != nullptr && GrabbedPrimitive->IsSimulatingPhysics())
+				bGrabbedActorHasPhysics = true;
+
+				// Held by the physics handle, the body keeps simulating and is never recreated.
+				if (HoldMode != EGrabHoldMode::PhysicsHandle || !GrabWithPhysicsHandle(GrabbedPrimitive))
 				{
-					bGrabbedActorHasPhysics = true;
 					ClosestInteractable->SetInteractablePhysicsSimulation(false);
 				}
+			}
 
-				ClosestInteractable->Interaction1();
+			ClosestInteractable->Interaction1();
 
-				GrabbedActor = ClosestInteractable;
-				GrabbedActor->OnDestroyed.AddDynamic(this, &UHandGrabbingComponent::HandleHeldActorDestroyed);
-			}
+			GrabbedActor = ClosestInteractable;
+			GrabbedActor->OnDestroyed.AddDynamic(this, &UHandGrabbingComponent::HandleHeldActorDestroyed);
 		}
 	}
 
@@ -70,7 +142,19 @@ AInteractable* UHandGrabbingComponent::TryRelease(bool bReenablePhysics)
 	{
 		GrabbedActor->OnDestroyed.RemoveDynamic(this, &UHandGrabbingComponent::HandleHeldActorDestroyed);
 
-		if(bReenablePhysics && bGrabbedActorHasPhysics)
+		if (bHoldingWithPhysicsHandle)
+		{
+			// The body still simulates, releasing it only clears the handle's target.
+			PhysicsHandle->ReleaseComponent();
+			bHoldingWithPhysicsHandle = false;
+			SetComponentTickEnabled(false);
+
+			if (!bReenablePhysics)
+			{
+				GrabbedActor->SetInteractablePhysicsSimulation(false);
+			}
+		}
+		else if(bReenablePhysics && bGrabbedActorHasPhysics)
 		{
 			GrabbedActor->SetInteractablePhysicsSimulation(true);
 		}
@@ -81,6 +165,48 @@ AInteractable* UHandGrabbingComponent::TryRelease(bool bReenablePhysics)
 	return ReleasedActor;
 }
 
+AInteractable* UHandGrabbingComponent::TryThrow(FVector LinearVelocity, FVector AngularVelocity)
+{
+	auto const ReleasedActor = TryRelease();
+
+	auto const ReleasedPrimitive = ReleasedActor ? Cast<UPrimitiveComponent>(ReleasedActor->GetRootComponent()) : nullptr;
+	if (ReleasedPrimitive && ReleasedPrimitive->IsSimulatingPhysics())
+	{
+		ReleasedPrimitive->SetPhysicsLinearVelocity(LinearVelocity);
+		ReleasedPrimitive->SetPhysicsAngularVelocityInRadians(AngularVelocity);
+	}
+
+	return ReleasedActor;
+}
+
+void UHandGrabbingComponent::SetHoldTransform(FTransform RelativeTransform)
+{
+	HoldTransform = RelativeTransform;
+}
+
+bool UHandGrabbingComponent::GrabWithPhysicsHandle(UPrimitiveComponent* Primitive)
+{
+	if (!PhysicsHandle)
+	{
+		PhysicsHandle = NewObject<UPhysicsHandleComponent>(GetOwner());
+		PhysicsHandle->RegisterComponent();
+
+		// Moves the target before the handle moves the body towards it.
+		PhysicsHandle->AddTickPrerequisiteComponent(this);
+	}
+
+	PhysicsHandle->SetLinearStiffness(HoldLinearStiffness);
+	PhysicsHandle->SetAngularStiffness(HoldAngularStiffness);
+
+	// Held where it is now, relative to us, until SetHoldTransform is called.
+	HoldTransform = Primitive->GetComponentTransform().GetRelativeTransform(GetComponentTransform());
+	PhysicsHandle->GrabComponentAtLocationWithRotation(Primitive, NAME_None, Primitive->GetComponentLocation(), Primitive->GetComponentRotation());
+
+	bHoldingWithPhysicsHandle = PhysicsHandle->GetGrabbedComponent() == Primitive;
+	SetComponentTickEnabled(bHoldingWithPhysicsHandle);
+	return bHoldingWithPhysicsHandle;
+}
+
 void UHandGrabbingComponent::HandleHeldActorDestroyed(AActor* DestroyedActor)
 {
 	if (DestroyedActor == GrabbedActor)
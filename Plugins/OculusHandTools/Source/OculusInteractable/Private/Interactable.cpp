@@ -1,8 +1,9 @@
 // Copyright (c) Meta Platforms, Inc. and affiliates.
 
 #include "Interactable.h"
+#include "InteractableGrabPoses.h"
 #include "InteractableSelector.h"
-#include "TransformString.h"
+#include "InteractableSubsystem.h"
 #include "OculusInteractableModule.h"
 
 AInteractable::AInteractable()
@@ -12,11 +13,29 @@ AInteractable::AInteractable()
 
 	// Defaults.
 	FarFieldSelectionDelayMs = 100.0f;
+	GrabPoseAsset = nullptr;
+	bSelectable = true;
+	SelectionChannels = 0xFF; // All channels.
+	bDynamicSelectionFlags = false;
+	GrabPoseRotationWeight = 400.0f; // A quarter turn counts as about 11cm.
 }
 
 void AInteractable::BeginPlay()
 {
 	Super::BeginPlay();
+
+	// Before registering, the registry caches the flags.
+	SelectionFlags = ComputeSelectionFlags();
+
+	if (!bGrabPosesCompiled)
+	{
+		CompileGrabPoses();
+	}
+
+	if (auto* const Registry = GetWorld()->GetSubsystem<UInteractableSubsystem>())
+	{
+		Registry->RegisterInteractable(this);
+	}
 }
 
 void AInteractable::EndPlay(const EEndPlayReason::Type EndPlayReason)
@@ -27,6 +46,11 @@ void AInteractable::EndPlay(const EEndPlayReason::Type EndPlayReason)
 		Selector->SetSelectedInteractable(nullptr, false); // Remove with no notification.
 	}
 
+	if (auto* const Registry = GetWorld()->GetSubsystem<UInteractableSubsystem>())
+	{
+		Registry->UnregisterInteractable(this);
+	}
+
 	Super::EndPlay(EndPlayReason);
 }
 
@@ -83,31 +107,119 @@ bool AInteractable::IsMovable_Implementation()
 	return false;
 }
 
+bool AInteractable::IsSelectable_Implementation()
+{
+	return bSelectable;
+}
+
+void AInteractable::InvalidateSelectionFlags()
+{
+	SelectionFlags = ComputeSelectionFlags();
+
+	if (auto* const Registry = GetWorld() ? GetWorld()->GetSubsystem<UInteractableSubsystem>() : nullptr)
+	{
+		Registry->UpdateSelectionFlags(this);
+	}
+}
+
+uint32 AInteractable::ComputeSelectionFlags()
+{
+	auto Flags = static_cast<uint32>(SelectionChannels & 0xFF) << EInteractableSelectionFlags::ChannelShift;
+	Flags |= IsMovable() ? EInteractableSelectionFlags::Movable : 0;
+	Flags |= IsSelectable() ? EInteractableSelectionFlags::Selectable : 0;
+	Flags |= bDynamicSelectionFlags ? EInteractableSelectionFlags::Dynamic : 0;
+	return Flags;
+}
+
 void AInteractable::SelectGrabPose(EHandSide Side, bool& GrabPoseFound, FString& GrabPoseName, FTransform& GrabTransform, FString& GrabHandPose)
 {
-	auto& GrabPoses = Side == EHandSide::HandLeft ? GrabPosesLeftHand : GrabPosesRightHand;
+	auto const& CompiledPoses = GetCompiledGrabPoses(Side);
 
-	GrabPoseFound = GrabPoses.Num() > 0;
+	GrabPoseFound = CompiledPoses.Num() > 0;
 	if (GrabPoseFound)
 	{
-		// Random selection for this first pass.
-		auto const RandomGrabIndex = FMath::RandRange(0, GrabPoses.Num() - 1);
+		// Random selection, see SelectNearestGrabPose.
+		auto const& CompiledPose = CompiledPoses[FMath::RandRange(0, CompiledPoses.Num() - 1)];
 
-		auto const EncodedTransform = GrabPoses[RandomGrabIndex].RelativeHandTransform;
+		GrabTransform = CompiledPose.RelativeHandTransform;
+		GrabPoseName = CompiledPose.PoseName;
+		GrabHandPose = CompiledPose.HandPose;
+	}
+}
 
-		if (FTransformString::StringToTransform(EncodedTransform, GrabTransform))
-		{
-			GrabPoseName = GrabPoses[RandomGrabIndex].PoseName;
-			GrabHandPose = GrabPoses[RandomGrabIndex].HandPose;
-		}
-		else
+void AInteractable::SelectNearestGrabPose(EHandSide Side, FTransform HandTransform, bool& GrabPoseFound, int32& GrabPoseIndex, FTransform& GrabTransform, FHandPoseId& GrabHandPoseId)
+{
+	auto const* CompiledPose = FindNearestGrabPose(Side, HandTransform);
+
+	GrabPoseFound = CompiledPose != nullptr;
+	if (GrabPoseFound)
+	{
+		GrabPoseIndex = CompiledPose->Index;
+		GrabTransform = CompiledPose->RelativeHandTransform;
+		GrabHandPoseId = CompiledPose->HandPoseId;
+	}
+}
+
+FCompiledGrabPose const* AInteractable::FindNearestGrabPose(EHandSide Side, FTransform const& HandTransform)
+{
+	auto const& CompiledPoses = GetCompiledGrabPoses(Side);
+
+	// The hand relative to us, unscaled like the grab poses.
+	auto const& ActorTransform = GetActorTransform();
+	auto const HandLocation = ActorTransform.GetRotation().UnrotateVector(HandTransform.GetLocation() - ActorTransform.GetLocation());
+	auto const HandRotation = ActorTransform.GetRotation().Inverse() * HandTransform.GetRotation();
+
+	FCompiledGrabPose const* Nearest = nullptr;
+	auto NearestScore = TNumericLimits<double>::Max();
+	for (auto const& CompiledPose : CompiledPoses)
+	{
+		// |q1.q2| is the cosine of half the angle between the rotations.
+		auto const Score = FVector::DistSquared(HandLocation, CompiledPose.HandLocation)
+			+ GrabPoseRotationWeight * (1.0 - FMath::Abs(HandRotation | CompiledPose.HandRotation));
+		if (Score < NearestScore)
 		{
-			UE_LOG(LogInteractable, Warning, TEXT("Invalid grab transform on %s, %s side at index %d: \"%s\""),
-				*GetHumanReadableName(),
-				Side == EHandSide::HandLeft ? TEXT("left") : TEXT("right"),
-				RandomGrabIndex,
-				*EncodedTransform);
-			GrabPoseFound = false;
+			Nearest = &CompiledPose;
+			NearestScore = Score;
 		}
 	}
+
+	return Nearest;
+}
+
+void AInteractable::CompileGrabPoses()
+{
+	FCompiledGrabPose::Compile(GrabPosesLeftHand, CompiledGrabPoses[static_cast<int32>(EHandSide::HandLeft)],
+		GetHumanReadableName() + TEXT(", left side"));
+	FCompiledGrabPose::Compile(GrabPosesRightHand, CompiledGrabPoses[static_cast<int32>(EHandSide::HandRight)],
+		GetHumanReadableName() + TEXT(", right side"));
+
+	bGrabPosesCompiled = true;
+}
+
+bool AInteractable::UsesGrabPoseAsset(EHandSide Side) const
+{
+	// Our own grab poses override those of the asset.
+	return GrabPoseAsset != nullptr && (Side == EHandSide::HandLeft ? GrabPosesLeftHand : GrabPosesRightHand).Num() == 0;
+}
+
+SIZE_T AInteractable::GetGrabPoseAllocatedSize() const
+{
+	return FCompiledGrabPose::GetAllocatedSize(GrabPosesLeftHand, CompiledGrabPoses[static_cast<int32>(EHandSide::HandLeft)])
+		+ FCompiledGrabPose::GetAllocatedSize(GrabPosesRightHand, CompiledGrabPoses[static_cast<int32>(EHandSide::HandRight)]);
+}
+
+TArray<FCompiledGrabPose> const& AInteractable::GetCompiledGrabPoses(EHandSide Side)
+{
+	if (UsesGrabPoseAsset(Side))
+	{
+		return GrabPoseAsset->GetCompiledGrabPoses(Side == EHandSide::HandLeft);
+	}
+
+	// Grab poses can be selected before BeginPlay.
+	if (!bGrabPosesCompiled)
+	{
+		CompileGrabPoses();
+	}
+
+	return CompiledGrabPoses[static_cast<int32>(Side)];
 }
@@ -0,0 +1,90 @@
+// Copyright (c) Meta Platforms, Inc. and affiliates.
+
+#include "InteractableGrabPoses.h"
+#include "Interactable.h"
+#include "EngineUtils.h"
+#include "HAL/IConsoleManager.h"
+#include "OculusInteractableModule.h"
+
+TArray<FCompiledGrabPose> const& UInteractableGrabPoses::GetCompiledGrabPoses(bool bLeftHand)
+{
+	// Compiled on the game thread, as FHandPoseCache requires, rather than in PostLoad.
+	if (!bGrabPosesCompiled)
+	{
+		CompileGrabPoses();
+	}
+
+	return bLeftHand ? CompiledGrabPosesLeftHand : CompiledGrabPosesRightHand;
+}
+
+SIZE_T UInteractableGrabPoses::GetGrabPoseAllocatedSize() const
+{
+	return FCompiledGrabPose::GetAllocatedSize(GrabPosesLeftHand, CompiledGrabPosesLeftHand)
+		+ FCompiledGrabPose::GetAllocatedSize(GrabPosesRightHand, CompiledGrabPosesRightHand);
+}
+
+#if WITH_EDITOR
+void UInteractableGrabPoses::PostEditChangeProperty(FPropertyChangedEvent& PropertyChangedEvent)
+{
+	Super::PostEditChangeProperty(PropertyChangedEvent);
+
+	bGrabPosesCompiled = false;
+}
+#endif
+
+void UInteractableGrabPoses::CompileGrabPoses()
+{
+	FCompiledGrabPose::Compile(GrabPosesLeftHand, CompiledGrabPosesLeftHand, GetPathName() + TEXT(", left side"));
+	FCompiledGrabPose::Compile(GrabPosesRightHand, CompiledGrabPosesRightHand, GetPathName() + TEXT(", right side"));
+	bGrabPosesCompiled = true;
+}
+
+namespace
+{
+	void ReportGrabPoseMemory(UWorld* World)
+	{
+		if (!World)
+		{
+			return;
+		}
+
+		auto NumInteractables = 0;
+		auto NumSharing = 0;
+		SIZE_T InstanceSize = 0;
+		// what the interactables sharing grab poses would use with a copy of the asset each
+		SIZE_T UnsharedSize = 0;
+		TSet<UInteractableGrabPoses const*> Assets;
+
+		for (TActorIterator<AInteractable> It(World); It; ++It)
+		{
+			auto const* Interactable = *It;
+			++NumInteractables;
+			InstanceSize += Interactable->GetGrabPoseAllocatedSize();
+
+			if (Interactable->UsesGrabPoseAsset(EHandSide::HandLeft) || Interactable->UsesGrabPoseAsset(EHandSide::HandRight))
+			{
+				++NumSharing;
+				Assets.Add(Interactable->GrabPoseAsset);
+				UnsharedSize += Interactable->GrabPoseAsset->GetGrabPoseAllocatedSize();
+			}
+		}
+
+		SIZE_T AssetSize = 0;
+		for (auto const* Asset : Assets)
+		{
+			AssetSize += Asset->GetGrabPoseAllocatedSize();
+		}
+
+		UE_LOG(LogInteractable, Display, TEXT("Grab poses of %d interactables in %s, %d of them sharing %d assets:"),
+			NumInteractables, *World->GetName(), NumSharing, Assets.Num());
+		UE_LOG(LogInteractable, Display, TEXT("  per instance %.1f KiB, shared %.1f KiB, total %.1f KiB"),
+			InstanceSize / 1024.0, AssetSize / 1024.0, (InstanceSize + AssetSize) / 1024.0);
+		UE_LOG(LogInteractable, Display, TEXT("  total with a copy of the shared grab poses per instance %.1f KiB"),
+			(InstanceSize + UnsharedSize) / 1024.0);
+	}
+}
+
+static FAutoConsoleCommandWithWorld CmdReportGrabPoseMemory(
+	TEXT("interactable.GrabPoseMemoryReport"),
+	TEXT("Logs the memory used by the grab poses of the interactables in the world, shared through UInteractableGrabPoses or not"),
+	FConsoleCommandWithWorldDelegate::CreateStatic(&ReportGrabPoseMemory));
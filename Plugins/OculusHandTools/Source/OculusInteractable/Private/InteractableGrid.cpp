@@ -0,0 +1,192 @@
+// Copyright (c) Meta Platforms, Inc. and affiliates.
+
+#include "InteractableGrid.h"
+
+FInteractableGrid::FInteractableGrid(float InCellSize) :
+	CellSize(FMath::Max(InCellSize, 1.f)), InvCellSize(1.f / CellSize)
+{
+}
+
+template <typename FTestCell, typename FTestElement>
+void FInteractableGrid::Query(FBox const& Box, FTestCell const& TestCell, FTestElement const& TestElement, TArray<int32>& OutIds) const
+{
+	for (auto const Id : LargeElements)
+	{
+		if (TestElement(Elements[Id]))
+		{
+			OutIds.Add(Id);
+		}
+	}
+
+	// small spheres are bucketed by their center, which can be up to half a cell outside of the box
+	auto const MinCell = ToCell(Box.Min - FVector(CellSize * 0.5f));
+	auto const MaxCell = ToCell(Box.Max + FVector(CellSize * 0.5f));
+
+	auto VisitCell = [&](FIntVector const& Cell, TArray<int32> const& Ids)
+	{
+		if (!TestCell(Cell))
+		{
+			return;
+		}
+
+		for (auto const Id : Ids)
+		{
+			if (TestElement(Elements[Id]))
+			{
+				OutIds.Add(Id);
+			}
+		}
+	};
+
+	// a long query through a sparse grid covers more cells than are occupied
+	auto const NumCellsInBox = int64(MaxCell.X - MinCell.X + 1) * (MaxCell.Y - MinCell.Y + 1) * (MaxCell.Z - MinCell.Z + 1);
+	if (NumCellsInBox > Cells.Num())
+	{
+		for (auto const& Pair : Cells)
+		{
+			auto const& Cell = Pair.Key;
+			if (Cell.X >= MinCell.X && Cell.X <= MaxCell.X &&
+				Cell.Y >= MinCell.Y && Cell.Y <= MaxCell.Y &&
+				Cell.Z >= MinCell.Z && Cell.Z <= MaxCell.Z)
+			{
+				VisitCell(Cell, Pair.Value);
+			}
+		}
+		return;
+	}
+
+	for (auto X = MinCell.X; X <= MaxCell.X; ++X)
+	{
+		for (auto Y = MinCell.Y; Y <= MaxCell.Y; ++Y)
+		{
+			for (auto Z = MinCell.Z; Z <= MaxCell.Z; ++Z)
+			{
+				auto const Cell = FIntVector(X, Y, Z);
+				if (auto const* Ids = Cells.Find(Cell))
+				{
+					VisitCell(Cell, *Ids);
+				}
+			}
+		}
+	}
+}
+
+void FInteractableGrid::Update(int32 Id, FVector const& Center, float Radius)
+{
+	check(Id >= 0);
+	if (Id >= Elements.Num())
+	{
+		Elements.SetNum(Id + 1);
+	}
+
+	auto& Element = Elements[Id];
+	auto const bLarge = Radius > CellSize * 0.5f;
+	auto const Cell = ToCell(Center);
+	auto const bInGrid = Element.IndexInCell != INDEX_NONE;
+
+	Element.Center = Center;
+	Element.Radius = Radius;
+
+	// most updates move a sphere within its cell
+	if (bInGrid && Element.bLarge == bLarge && (bLarge || Element.Cell == Cell))
+	{
+		return;
+	}
+
+	if (bInGrid)
+	{
+		RemoveFromCell(Id);
+	}
+	else
+	{
+		++NumElements;
+	}
+
+	Element.Cell = Cell;
+	Element.bLarge = bLarge;
+	AddToCell(Id);
+}
+
+void FInteractableGrid::Remove(int32 Id)
+{
+	if (Contains(Id))
+	{
+		RemoveFromCell(Id);
+		--NumElements;
+	}
+}
+
+void FInteractableGrid::Reset()
+{
+	Elements.Reset();
+	Cells.Reset();
+	LargeElements.Reset();
+	NumElements = 0;
+}
+
+void FInteractableGrid::QuerySphere(FVector const& Center, float Radius, TArray<int32>& OutIds) const
+{
+	auto const Box = FBox(Center - FVector(Radius), Center + FVector(Radius));
+	Query(Box,
+		[](FIntVector const&) { return true; },
+		[&](FElement const& Element)
+		{
+			return FVector::DistSquared(Element.Center, Center) <= FMath::Square(Radius + Element.Radius);
+		},
+		OutIds);
+}
+
+void FInteractableGrid::QueryCapsule(FVector const& Start, FVector const& End, float Radius, TArray<int32>& OutIds) const
+{
+	auto const Box = FBox(Start.ComponentMin(End) - FVector(Radius), Start.ComponentMax(End) + FVector(Radius));
+
+	// a cell can only hold overlapping spheres if its center is within the capsule grown by half a cell (the largest
+	// small sphere) and by half the cell's diagonal
+	auto const CellReachSquared = FMath::Square(Radius + CellSize * (0.5f + UE_HALF_SQRT_3));
+	Query(Box,
+		[&](FIntVector const& Cell)
+		{
+			auto const CellCenter = (FVector(Cell) + FVector(0.5)) * CellSize;
+			return FMath::PointDistToSegmentSquared(CellCenter, Start, End) <= CellReachSquared;
+		},
+		[&](FElement const& Element)
+		{
+			return FMath::PointDistToSegmentSquared(Element.Center, Start, End) <= FMath::Square(Radius + Element.Radius);
+		},
+		OutIds);
+}
+
+FIntVector FInteractableGrid::ToCell(FVector const& Location) const
+{
+	return FIntVector(
+		FMath::FloorToInt32(Location.X * InvCellSize),
+		FMath::FloorToInt32(Location.Y * InvCellSize),
+		FMath::FloorToInt32(Location.Z * InvCellSize));
+}
+
+void FInteractableGrid::AddToCell(int32 Id)
+{
+	auto& Element = Elements[Id];
+	auto& List = Element.bLarge ? LargeElements : Cells.FindOrAdd(Element.Cell);
+	Element.IndexInCell = List.Add(Id);
+}
+
+void FInteractableGrid::RemoveFromCell(int32 Id)
+{
+	auto& Element = Elements[Id];
+	auto* const List = Element.bLarge ? &LargeElements : Cells.Find(Element.Cell);
+	check(List);
+
+	List->RemoveAtSwap(Element.IndexInCell, EAllowShrinking::No);
+	if (Element.IndexInCell < List->Num())
+	{
+		Elements[(*List)[Element.IndexInCell]].IndexInCell = Element.IndexInCell;
+	}
+
+	if (!Element.bLarge && List->IsEmpty())
+	{
+		Cells.Remove(Element.Cell);
+	}
+
+	Element.IndexInCell = INDEX_NONE;
+}
@@ -0,0 +1,167 @@
+// Copyright (c) Meta Platforms, Inc. and affiliates.
+
+#include "InteractableGrid.h"
+#include "HAL/IConsoleManager.h"
+#include "OculusInteractableModule.h"
+
+namespace
+{
+	// a room full of props, and selector queries of the default AInteractableSelector and UHandGrabbingComponent
+	constexpr auto RoomExtent = 2000.0;
+	constexpr auto RoomHeight = 300.0;
+	constexpr auto NumFrames = 100;
+	constexpr auto MovedFraction = 0.1f;
+	constexpr auto NumQueries = 1000;
+	constexpr auto NearFieldRadius = 10.f;
+	constexpr auto GrabRadius = 20.f;
+	constexpr auto RaycastDistance = 1000.f;
+	constexpr auto RaycastAngleDegrees = 15.f;
+
+	struct FSphere
+	{
+		FVector Center;
+		float Radius;
+	};
+
+	FVector RandomLocation(FRandomStream& Random)
+	{
+		return FVector(
+			Random.FRandRange(-RoomExtent, RoomExtent),
+			Random.FRandRange(-RoomExtent, RoomExtent),
+			Random.FRandRange(0.0, RoomHeight));
+	}
+
+	template <typename FQueryFunc>
+	double TimeQueries(FQueryFunc Query, int32& OutNumFound)
+	{
+		TArray<int32> Found;
+		OutNumFound = 0;
+
+		auto const StartTime = FPlatformTime::Seconds();
+		for (auto i = 0; i < NumQueries; ++i)
+		{
+			Found.Reset();
+			Query(i, Found);
+			OutNumFound += Found.Num();
+		}
+
+		return (FPlatformTime::Seconds() - StartTime) * 1e6 / NumQueries;
+	}
+
+	void BenchmarkGrid(int32 NumInteractables)
+	{
+		FRandomStream Random(NumInteractables);
+
+		TArray<FSphere> Spheres;
+		Spheres.SetNum(NumInteractables);
+		for (auto& Sphere : Spheres)
+		{
+			Sphere.Center = RandomLocation(Random);
+			Sphere.Radius = Random.FRandRange(5.f, 30.f);
+		}
+
+		FInteractableGrid Grid;
+		auto const BuildStartTime = FPlatformTime::Seconds();
+		for (auto Id = 0; Id < NumInteractables; ++Id)
+		{
+			Grid.Update(Id, Spheres[Id].Center, Spheres[Id].Radius);
+		}
+		auto const BuildMs = (FPlatformTime::Seconds() - BuildStartTime) * 1e3;
+
+		// a fraction of the props move a little every frame
+		auto const NumMoved = FMath::Max(1, FMath::RoundToInt(NumInteractables * MovedFraction));
+		auto const MoveStartTime = FPlatformTime::Seconds();
+		for (auto Frame = 0; Frame < NumFrames; ++Frame)
+		{
+			for (auto i = 0; i < NumMoved; ++i)
+			{
+				auto const Id = Random.RandHelper(NumInteractables);
+				Spheres[Id].Center += Random.GetUnitVector() * 5.0;
+				Grid.Update(Id, Spheres[Id].Center, Spheres[Id].Radius);
+			}
+		}
+		auto const MoveUs = (FPlatformTime::Seconds() - MoveStartTime) * 1e6 / NumFrames;
+
+		TArray<FVector> Origins;
+		TArray<FVector> Directions;
+		for (auto i = 0; i < NumQueries; ++i)
+		{
+			Origins.Add(RandomLocation(Random));
+			Directions.Add(Random.GetUnitVector());
+		}
+
+		auto const CastRadius = RaycastDistance * FMath::Tan(FMath::DegreesToRadians(RaycastAngleDegrees * 0.5f));
+
+		auto NearGrid = [&](int32 i, TArray<int32>& Found) { Grid.QuerySphere(Origins[i], NearFieldRadius, Found); };
+		auto GrabGrid = [&](int32 i, TArray<int32>& Found) { Grid.QuerySphere(Origins[i], GrabRadius, Found); };
+		auto FarGrid = [&](int32 i, TArray<int32>& Found)
+		{
+			Grid.QueryCapsule(Origins[i], Origins[i] + Directions[i] * RaycastDistance, CastRadius, Found);
+		};
+
+		// the same queries testing every sphere, as without an index
+		auto NearLinear = [&](int32 i, TArray<int32>& Found)
+		{
+			for (auto Id = 0; Id < NumInteractables; ++Id)
+			{
+				if (FVector::DistSquared(Spheres[Id].Center, Origins[i]) <= FMath::Square(NearFieldRadius + Spheres[Id].Radius))
+				{
+					Found.Add(Id);
+				}
+			}
+		};
+		auto FarLinear = [&](int32 i, TArray<int32>& Found)
+		{
+			auto const End = Origins[i] + Directions[i] * RaycastDistance;
+			for (auto Id = 0; Id < NumInteractables; ++Id)
+			{
+				if (FMath::PointDistToSegmentSquared(Spheres[Id].Center, Origins[i], End) <= FMath::Square(CastRadius + Spheres[Id].Radius))
+				{
+					Found.Add(Id);
+				}
+			}
+		};
+
+		int32 NearFound, GrabFound, FarFound, NearLinearFound, FarLinearFound;
+		auto const NearUs = TimeQueries(NearGrid, NearFound);
+		auto const GrabUs = TimeQueries(GrabGrid, GrabFound);
+		auto const FarUs = TimeQueries(FarGrid, FarFound);
+		auto const NearLinearUs = TimeQueries(NearLinear, NearLinearFound);
+		auto const FarLinearUs = TimeQueries(FarLinear, FarLinearFound);
+
+		if (NearFound != NearLinearFound || FarFound != FarLinearFound)
+		{
+			UE_LOG(LogInteractable, Error, TEXT("Grid queries found %d/%d interactables, linear queries %d/%d"),
+				NearFound, FarFound, NearLinearFound, FarLinearFound);
+		}
+
+		UE_LOG(LogInteractable, Display, TEXT("%d interactables: build %.2f ms, %d moves %.1f us/frame"),
+			NumInteractables, BuildMs, NumMoved, MoveUs);
+		UE_LOG(LogInteractable, Display, TEXT("  near-field: %.2f us/query (linear %.2f us), %.2f found"),
+			NearUs, NearLinearUs, float(NearFound) / NumQueries);
+		UE_LOG(LogInteractable, Display, TEXT("  grab:       %.2f us/query, %.2f found"),
+			GrabUs, float(GrabFound) / NumQueries);
+		UE_LOG(LogInteractable, Display, TEXT("  far-field:  %.2f us/query (linear %.2f us), %.2f found"),
+			FarUs, FarLinearUs, float(FarFound) / NumQueries);
+	}
+
+	void BenchmarkGridCommand(TArray<FString> const& Args)
+	{
+		if (Args.IsEmpty())
+		{
+			BenchmarkGrid(1000);
+			BenchmarkGrid(10000);
+			return;
+		}
+
+		for (auto const& Arg : Args)
+		{
+			BenchmarkGrid(FMath::Max(1, FCString::Atoi(*Arg)));
+		}
+	}
+}
+
+static FAutoConsoleCommand CmdBenchmarkInteractableGrid(
+	TEXT("interactable.BenchmarkGrid"),
+	TEXT("Times the interactable registry's grid against a linear scan, with 1000 and 10000 interactables or the counts given"),
+	FConsoleCommandWithArgsDelegate::CreateStatic(&BenchmarkGridCommand));
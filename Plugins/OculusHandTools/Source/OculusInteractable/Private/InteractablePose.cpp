@@ -0,0 +1,54 @@
+// Copyright (c) Meta Platforms, Inc. and affiliates.
+
+#include "InteractablePose.h"
+#include "TransformString.h"
+#include "OculusInteractableModule.h"
+
+void FCompiledGrabPose::Compile(TArray<FInteractablePose> const& GrabPoses, TArray<FCompiledGrabPose>& OutCompiledPoses, FString const& Owner)
+{
+	OutCompiledPoses.Reset(GrabPoses.Num());
+
+	for (auto Index = 0; Index < GrabPoses.Num(); ++Index)
+	{
+		auto const& GrabPose = GrabPoses[Index];
+
+		FTransform GrabTransform;
+		if (!FTransformString::StringToTransform(GrabPose.RelativeHandTransform, GrabTransform))
+		{
+			UE_LOG(LogInteractable, Warning, TEXT("Invalid grab transform on %s at index %d: \"%s\""),
+				*Owner,
+				Index,
+				*GrabPose.RelativeHandTransform);
+			continue;
+		}
+
+		// The encoded rotation is rounded.
+		GrabTransform.NormalizeRotation();
+
+		auto& CompiledPose = OutCompiledPoses.AddDefaulted_GetRef();
+		CompiledPose.Index = Index;
+		CompiledPose.PoseName = GrabPose.PoseName;
+		CompiledPose.HandPose = GrabPose.HandPose;
+		CompiledPose.RelativeHandTransform = GrabTransform;
+		CompiledPose.HandRotation = GrabTransform.GetRotation().Inverse();
+		CompiledPose.HandLocation = CompiledPose.HandRotation.RotateVector(-GrabTransform.GetLocation());
+		CompiledPose.HandPoseId = GrabPose.HandPose.IsEmpty() ? FHandPoseId() : FHandPoseCache::Pin(GrabPose.HandPose);
+	}
+
+	OutCompiledPoses.Shrink();
+}
+
+SIZE_T FCompiledGrabPose::GetAllocatedSize(TArray<FInteractablePose> const& GrabPoses, TArray<FCompiledGrabPose> const& CompiledPoses)
+{
+	auto Size = GrabPoses.GetAllocatedSize() + CompiledPoses.GetAllocatedSize();
+	for (auto const& GrabPose : GrabPoses)
+	{
+		Size += GrabPose.GetAllocatedSize();
+	}
+	for (auto const& CompiledPose : CompiledPoses)
+	{
+		Size += CompiledPose.PoseName.GetAllocatedSize() + CompiledPose.HandPose.GetAllocatedSize();
+	}
+
+	return Size;
+}
@@ -1,6 +1,8 @@
 // Copyright (c) Meta Platforms, Inc. and affiliates.
 
 #include "InteractableSelector.h"
+#include "InteractableSelectorSubsystem.h"
+#include "InteractableSubsystem.h"
 #include "DrawDebugHelpers.h"
 #include "Kismet/GameplayStatics.h"
 
@@ -17,9 +19,17 @@ AInteractableSelector::AInteractableSelector()
 	RaycastDistance = 1000.0f;
 	RaycastAngleDegrees = 15.0f;
 	RaycastStickinessAngleDegrees = 20.0f;
+	TargetRadiusScale = 0.5f;
 	DampeningFactor = 0.95f;
 	AimingActorRotationRate = 0.1f;
 	bRaycastDebugTrace = false;
+	bUseInteractableRegistry = true;
+	bUseAsyncSceneQueries = false;
+	bExtrapolateAsyncSceneQueries = true;
+	bBatchSelection = false;
+	bRegisteredForBatching = false;
+	bShouldSelectImplementedInScript = false;
+	SelectionChannels = 0xFF; // All channels.
 
 	// State
 	bAlignAimingActorWithHitNormal = false;
@@ -54,9 +64,16 @@ void AInteractableSelector::BeginPlay()
 {
 	Super::BeginPlay();
 
+	bShouldSelectImplementedInScript = GetClass()->IsFunctionImplementedInScript(GET_FUNCTION_NAME_CHECKED(AInteractableSelector, ShouldSelect));
+
 	BuildAimingActor();
 	BuildBeam();
 
+	if (auto const Selectors = GetWorld()->GetSubsystem<UInteractableSelectorSubsystem>())
+	{
+		Selectors->RegisterSelector(this);
+	}
+
 	if (bSelectorStartsActivated)
 	{
 		ActivateSelector(true);
@@ -70,6 +87,11 @@ void AInteractableSelector::EndPlay(EEndPlayReason::Type const EndPlayReason)
 	DestroyAimingActor();
 	SetSelectedInteractable(nullptr); // Notify selected interactable that we are going away.
 
+	if (auto const Selectors = GetWorld()->GetSubsystem<UInteractableSelectorSubsystem>())
+	{
+		Selectors->UnregisterSelector(this);
+	}
+
 	Super::EndPlay(EndPlayReason);
 }
 
@@ -77,182 +99,381 @@ void AInteractableSelector::Tick(float DeltaTime)
 {
 	Super::Tick(DeltaTime);
 
-	auto TestShouldSelect = [this](TWeakObjectPtr<AActor> Actor)
+	// Batched selectors are updated together by the UInteractableSelectorSubsystem.
+	if (bSelectorActivated && !IsSelectionBatched())
 	{
-		return ShouldSelect(Cast<AInteractable>(Actor.Get()));
-	};
+		UpdateSelection(DeltaTime);
+	}
+}
 
-	if (bSelectorActivated)
+bool AInteractableSelector::IsSelectionBatched() const
+{
+	return bBatchSelection && bUseInteractableRegistry && bRegisteredForBatching;
+}
+
+void AInteractableSelector::UpdateSelection(float DeltaTime)
+{
+	auto const World = GetWorld();
+	if (!World)
 	{
-		auto const World = GetWorld();
-		if (!World)
-		{
-			return;
-		}
+		return;
+	}
 
-		AInteractable* Candidate = nullptr;
-		auto CandidateInNearField = false;
-		FVector StartCast, EndCast;
-		ComputeNearFieldRaycastEndpoints(StartCast, EndCast);
-		TArray<FHitResult> Hits;
+	if (auto const Registry = bUseInteractableRegistry ? World->GetSubsystem<UInteractableSubsystem>() : nullptr)
+	{
+		BeginCandidateSearch(CandidateSearch);
+		Registry->FlushMovedInteractables();
+		RunCandidateSearch(CandidateSearch, *Registry);
+		FinishCandidateSearch(CandidateSearch, DeltaTime);
+		return;
+	}
 
-		auto UpdateAimingActorTransform = [&]
-		{
-			World->LineTraceMultiByChannel(Hits, StartCast, EndCast, ECC_Visibility);
+	auto TestShouldSelect = [this](TWeakObjectPtr<AActor> Actor)
+	{
+		return CanSelect(Cast<AInteractable>(Actor.Get()));
+	};
 
-			auto const AimingQuat = AimingActor->GetActorQuat();
+	AInteractable* Candidate = nullptr;
+	auto CandidateInNearField = false;
+	FSelectorAim Aim;
+	ComputeNearFieldAim(Aim);
+	TArray<FHitResult> Hits;
 
-			// Default target aiming when we have not hit normal.
-			auto const RightVector = FVector::CrossProduct(DampenedForwardVector, FVector::UpVector);
-			auto ForwardVector = FVector::CrossProduct(StartCast - EndCast, RightVector);
-			auto TargetAimingQuat = FQuat(FRotationMatrix::MakeFromXZ(ForwardVector, StartCast - EndCast).Rotator());
+	// Near-field selection has priority.
+	if (NearFieldRadius > 0.0f)
+	{
+		auto const NearFieldCollisionSphere = FCollisionShape::MakeSphere(NearFieldRadius);
+		auto CandidateDistance = NearFieldRadius * 100.0f;
 
-			if (Hits.Num() > 0)
-			{
-				NonInteractableActorHit = Hits[0].GetActor();
+		QueryMultiByChannel(World, NearFieldTraceHandle, Aim.StartCast, Aim.StartCast, InteractableTraceChannel, NearFieldCollisionSphere, Hits);
 
-				if (bAlignAimingActorWithHitNormal)
+		for (auto const& Hit : Hits)
+		{
+			if (Hit.GetActor() && Hit.GetActor()->GetClass()->IsChildOf(AInteractable::StaticClass()) && TestShouldSelect(Hit.GetActor()))
+			{
+				auto const Distance = FVector::Distance(Hit.GetActor()->GetActorLocation(), Aim.StartCast);
+				if (CandidateDistance > Distance)
 				{
-					// Align with hit normal.
-					ForwardVector = FVector::CrossProduct(Hits[0].ImpactNormal, RightVector);
-					TargetAimingQuat = FQuat(FRotationMatrix::MakeFromXZ(ForwardVector, Hits[0].ImpactNormal).Rotator());
+					CandidateDistance = Distance;
+					Candidate = Cast<AInteractable>(Hit.GetActor());
+					CandidateInNearField = true;
 				}
-
-				AimingActor->SetActorLocation(Hits[0].ImpactPoint);
-			}
-			else
-			{
-				// Place the actor at the end of the cast of nothing is hit.
-				AimingActor->SetActorLocation(EndCast);
 			}
+		}
+	}
 
-			auto const LerpedTargetAimingQuat = FQuat::FastLerp(AimingQuat, TargetAimingQuat, AimingActorRotationRate);
-			AimingActor->SetActorRotation(LerpedTargetAimingQuat);
-		};
+	// If no candidates found in the near-field, we perform far-field selection.
+	if (!Candidate)
+	{
+		UpdateDampenedForwardVector(DampeningFactor);
+		ComputeFarFieldAim(World, Aim);
 
-		// Near-field selection has priority.
-		if (NearFieldRadius > 0.0f)
-		{
-			auto const NearFieldCollisionSphere = FCollisionShape::MakeSphere(NearFieldRadius);
-			auto CandidateDistance = NearFieldRadius * 100.0f;
+		// Gather the candidates in a cone, to be tested together.
+		auto const Cone = FSelectionCone(GetActorLocation(), DampenedForwardVector);
+		ConeCandidates.Reset(Cone.Apex);
+		ConeInteractables.Reset();
 
-			World->SweepMultiByChannel(Hits, StartCast, StartCast, FQuat::Identity, InteractableTraceChannel, NearFieldCollisionSphere);
+		auto const CollisionSphere = FCollisionShape::MakeSphere(ComputeSphereRadiusForCast());
+		QueryMultiByChannel(World, FarFieldTraceHandle, Aim.QueryStartCast, Aim.QueryEndCast, InteractableTraceChannel, CollisionSphere, Hits);
 
-			if (Hits.Num() > 0)
+		for (auto const& Hit : Hits)
+		{
+			// GEngine->AddOnScreenDebugMessage(-1, 0, FColor::Blue, FString::Printf(TEXT("Hit %s at %f"), *Hit.GetActor()->GetName(), Hit.Distance));
+			if (Hit.GetActor() && Hit.GetActor()->GetClass()->IsChildOf(AInteractable::StaticClass()) && TestShouldSelect(Hit.GetActor()))
 			{
-				for (auto const& Hit : Hits)
-				{
-					if (Hit.GetActor() && Hit.GetActor()->GetClass()->IsChildOf(AInteractable::StaticClass()) && TestShouldSelect(Hit.GetActor()))
-					{
-						auto const Distance = FVector::Distance(Hit.GetActor()->GetActorLocation(), StartCast);
-						if (CandidateDistance > Distance)
-						{
-							CandidateDistance = Distance;
-							Candidate = Cast<AInteractable>(Hit.GetActor());
-							CandidateInNearField = true;
-						}
-					}
-
-					// UE_LOG(LogTemp, Error, TEXT("Hit near field %s at %0.0f"), *Hit.GetActor()->GetName(), CandidateDistance);
-				}
+				ConeCandidates.Add(Hit.GetActor()->GetActorLocation(), Hit.GetActor()->GetSimpleCollisionRadius() * TargetRadiusScale, Hit.Distance);
+				ConeInteractables.Add(Cast<AInteractable>(Hit.GetActor()));
 			}
 		}
 
-		// If no candidates found in the near-field, we perform far-field selection.
-		if (!Candidate)
+		// Looking for the closest candidate by angle and distance, we cannot select outside of the cone.
+		auto const MinCosAngle = FMath::Cos(FMath::DegreesToRadians(RaycastAngleDegrees));
+		auto const CandidateIndex = Cone.FindBest(ConeCandidates, MinCosAngle, RaycastDistance, ConeCosAngles);
+		Candidate = CandidateIndex != INDEX_NONE ? ConeInteractables[CandidateIndex] : nullptr;
+
+		// Do not change the selection if it is within some angle.
+		if (SelectedInteractable != nullptr && Candidate != nullptr)
 		{
-			UpdateDampenedForwardVector(DampeningFactor);
-			ComputeFarFieldRaycastEndpoints(StartCast, EndCast);
+			// The current selection was usually tested with the other candidates.
+			auto const SelectedIndex = ConeInteractables.Find(SelectedInteractable);
+			auto const CosAngleToCurrentSelection = SelectedIndex != INDEX_NONE
+				? ConeCosAngles[SelectedIndex]
+				: Cone.GetCosAngleTo(SelectedInteractable->GetActorLocation(), SelectedInteractable->GetSimpleCollisionRadius() * TargetRadiusScale);
 
-			if (bRaycastDebugTrace)
+			if (ShouldKeepSelection(CosAngleToCurrentSelection, ConeCosAngles[CandidateIndex]))
 			{
-				DrawDebugLine(World, StartCast, EndCast, FColor::Green, false, -1.0f, 0, 0.1f);
+				KeepSelection(World, Aim);
+				return;
 			}
+		}
+	}
+
+	ApplyCandidate(World, Candidate, CandidateInNearField, Aim, DeltaTime);
+}
+
+void AInteractableSelector::BeginCandidateSearch(FSelectorCandidateSearch& Search) const
+{
+	FSelectorAim NearFieldAim;
+	ComputeNearFieldAim(NearFieldAim);
+	Search.NearFieldStartCast = NearFieldAim.StartCast;
+	Search.NearFieldRadius = NearFieldRadius;
+
+	// The far-field search uses the forward vector we will have if there is no near-field candidate.
+	Search.ForwardVector = ComputeDampenedForwardVector(DampeningFactor);
+	ComputeFarFieldRaycastEndpoints(Search.ForwardVector, Search.FarFieldStartCast, Search.FarFieldEndCast);
+	Search.FarFieldRadius = ComputeSphereRadiusForCast();
+	Search.Apex = GetActorLocation();
+	Search.MinCosAngle = FMath::Cos(FMath::DegreesToRadians(RaycastAngleDegrees));
+	Search.MaxDistance = RaycastDistance;
+	Search.TargetRadiusScale = TargetRadiusScale;
+	Search.SelectionChannels = SelectionChannels;
+}
 
-			// Trace in a cone against interactable.
-			auto const SphereRadius = ComputeSphereRadiusForCast();
-			auto const CollisionSphere = FCollisionShape::MakeSphere(SphereRadius);
-			World->SweepMultiByChannel(Hits, StartCast, EndCast, FQuat::Identity, InteractableTraceChannel, CollisionSphere);
+void AInteractableSelector::RunCandidateSearch(FSelectorCandidateSearch& Search, UInteractableSubsystem const& Registry)
+{
+	// Drops the candidates we cannot select by their cached flags. Dynamic flags are tested by CanSelect.
+	auto const IsIneligible = [&](FRegisteredInteractable const& Registered)
+	{
+		return !(Registered.SelectionFlags & EInteractableSelectionFlags::Dynamic)
+			&& !EInteractableSelectionFlags::CanBeSelected(Registered.SelectionFlags, Search.SelectionChannels);
+	};
 
-			// Looking for the closest candidate by angle and distance.
-			auto CandidateAngle = RaycastAngleDegrees;
-			auto CandidateDistance = RaycastDistance;
+	// Near-field candidates, closest first.
+	Search.NearFieldCandidates.Reset();
+	if (Search.NearFieldRadius > 0.0f)
+	{
+		Registry.FindInSphere(Search.NearFieldStartCast, Search.NearFieldRadius, Search.NearFieldCandidates);
 
-			if (Hits.Num() > 0)
-			{
-				for (auto const& Hit : Hits)
-				{
-					// GEngine->AddOnScreenDebugMessage(-1, 0, FColor::Blue, FString::Printf(TEXT("Hit %s at %f"), *Hit.GetActor()->GetName(), Hit.Distance));
-					if (Hit.GetActor() && Hit.GetActor()->GetClass()->IsChildOf(AInteractable::StaticClass()) && TestShouldSelect(Hit.GetActor()))
-					{
-						auto const Angle = ComputeAngularDistance(Hit.GetActor());
-
-						// Since CandidateAngle starts at RaycastAngleDegrees, we cannot select outside of the cone.
-						if (Angle > CandidateAngle || Angle == CandidateAngle && Hit.Distance >= CandidateDistance)
-						{
-							continue;
-						}
-
-						CandidateAngle = Angle;
-						CandidateDistance = Hit.Distance;
-						Candidate = Cast<AInteractable>(Hit.GetActor());
-					}
-				}
-			}
+		auto const MaxDistanceSquared = FMath::Square(Search.NearFieldRadius * 100.0f);
+		Search.NearFieldCandidates.RemoveAll([&](FRegisteredInteractable const& Registered)
+		{
+			return IsIneligible(Registered) || FVector::DistSquared(Registered.Location, Search.NearFieldStartCast) >= MaxDistanceSquared;
+		});
+		Search.NearFieldCandidates.StableSort([&](FRegisteredInteractable const& A, FRegisteredInteractable const& B)
+		{
+			return FVector::DistSquared(A.Location, Search.NearFieldStartCast) < FVector::DistSquared(B.Location, Search.NearFieldStartCast);
+		});
+	}
 
-			// Do not change the selection if it is within some angle.
-			if (SelectedInteractable != nullptr && Candidate != nullptr)
-			{
-				auto const AngleToCurrentSelection = ComputeAngularDistance(SelectedInteractable);
-				if (AngleToCurrentSelection <= RaycastStickinessAngleDegrees &&
-					AngleToCurrentSelection < ComputeAngularDistance(Candidate))
-				{
-					// Re-orient the beam.
-					OrientBeam();
-					if (bAlwaysShowAimingActor)
-					{
-						UpdateAimingActorTransform();
-					}
-					return;
-				}
-			}
+	// Far-field candidates within the cone, best first.
+	Search.FarFieldCandidates.Reset();
+	Registry.FindInCapsule(Search.FarFieldStartCast, Search.FarFieldEndCast, Search.FarFieldRadius, Search.FarFieldCandidates);
+	Search.FarFieldCandidates.RemoveAll(IsIneligible);
+
+	Search.ConeCandidates.Reset(Search.Apex);
+	for (auto const& Registered : Search.FarFieldCandidates)
+	{
+		// How far the sphere travels before touching the bounds, like the distance of a sweep hit.
+		auto const Distance = FVector::DotProduct(Registered.Center - Search.FarFieldStartCast, Search.ForwardVector) - Registered.Radius - Search.FarFieldRadius;
+		Search.ConeCandidates.Add(Registered.Center, Registered.Radius * Search.TargetRadiusScale, FMath::Max(static_cast<float>(Distance), 0.0f));
+	}
+
+	auto const Cone = FSelectionCone(Search.Apex, Search.ForwardVector);
+	Cone.Rank(Search.ConeCandidates, Search.MinCosAngle, Search.MaxDistance, Search.ConeCosAngles, Search.FarFieldOrder);
+}
+
+void AInteractableSelector::FinishCandidateSearch(FSelectorCandidateSearch const& Search, float DeltaTime)
+{
+	auto const World = GetWorld();
+	if (!World)
+	{
+		return;
+	}
+
+	FSelectorAim Aim;
+	ComputeNearFieldAim(Aim);
+
+	// Near-field selection has priority: the closest candidate we should select.
+	// The registry's bounding spheres are loose, candidates are tested as the physics queries would.
+	auto const NearFieldSphere = FCollisionShape::MakeSphere(Search.NearFieldRadius);
+	for (auto const& Registered : Search.NearFieldCandidates)
+	{
+		if (UInteractableSubsystem::OverlapInteractable(Registered.Interactable, InteractableTraceChannel, Search.NearFieldStartCast, FQuat::Identity, NearFieldSphere)
+			&& CanSelect(Registered.Interactable))
+		{
+			ApplyCandidate(World, Registered.Interactable, true, Aim, DeltaTime);
+			return;
 		}
+	}
+
+	// The far-field search was made with this forward vector.
+	UpdateDampenedForwardVector(DampeningFactor);
+	ComputeFarFieldAim(World, Aim);
 
-		if (!Candidate || bAlwaysShowAimingActor)
+	// The best far-field candidate we should select.
+	AInteractable* Candidate = nullptr;
+	auto CandidateCosAngle = 0.0f;
+	auto const FarFieldSphere = FCollisionShape::MakeSphere(Search.FarFieldRadius);
+	for (auto const Index : Search.FarFieldOrder)
+	{
+		auto* const Interactable = Search.FarFieldCandidates[Index].Interactable;
+		if (UInteractableSubsystem::SweepInteractable(Interactable, InteractableTraceChannel, Search.FarFieldStartCast, Search.FarFieldEndCast, FarFieldSphere)
+			&& CanSelect(Interactable))
 		{
-			if (AimingActor)
-			{
-				// If there are no hits, we help by displaying the aiming actor.
-				ActivateAimingActor(true);
-				UpdateAimingActorTransform();
-			}
+			Candidate = Interactable;
+			CandidateCosAngle = Search.ConeCosAngles[Index];
+			break;
 		}
-		else
+	}
+
+	// Do not change the selection if it is within some angle.
+	if (SelectedInteractable != nullptr && Candidate != nullptr)
+	{
+		// The current selection was usually tested with the other candidates.
+		auto const SelectedIndex = Search.FarFieldCandidates.IndexOfByPredicate([this](FRegisteredInteractable const& Registered)
 		{
-			// Do no show the aiming actor when we hit an interactable.
-			ActivateAimingActor(false);
+			return Registered.Interactable == SelectedInteractable;
+		});
 
-			// When we have a candidate, this first non-interactable actor hit is cleared.
-			NonInteractableActorHit.Reset();
+		auto CosAngleToCurrentSelection = 0.0f;
+		if (SelectedIndex != INDEX_NONE)
+		{
+			CosAngleToCurrentSelection = Search.ConeCosAngles[SelectedIndex];
+		}
+		else
+		{
+			FVector Center;
+			float Radius;
+			auto const Registry = World->GetSubsystem<UInteractableSubsystem>();
+			if (!Registry || !Registry->GetBounds(SelectedInteractable, Center, Radius))
+			{
+				Center = SelectedInteractable->GetActorLocation();
+				Radius = SelectedInteractable->GetSimpleCollisionRadius();
+			}
+			CosAngleToCurrentSelection = FSelectionCone(Search.Apex, Search.ForwardVector).GetCosAngleTo(Center, Radius * Search.TargetRadiusScale);
 		}
 
-		// Near-field selection is immediate.  , otherwise we update selection time on candidate in pre-selection.
-		if (CandidateInNearField)
+		if (ShouldKeepSelection(CosAngleToCurrentSelection, CandidateCosAngle))
 		{
-			CandidatePreSelection = Candidate;
-			CandidatePreSelectionTimeMs = Candidate->FarFieldSelectionDelayMs;
+			KeepSelection(World, Aim);
+			return;
 		}
-		else if (CandidatePreSelection != Candidate)
+	}
+
+	ApplyCandidate(World, Candidate, false, Aim, DeltaTime);
+}
+
+bool AInteractableSelector::ShouldKeepSelection(float CosAngleToCurrentSelection, float CosAngleToCandidate) const
+{
+	return CosAngleToCurrentSelection >= FMath::Cos(FMath::DegreesToRadians(RaycastStickinessAngleDegrees)) &&
+		CosAngleToCurrentSelection > CosAngleToCandidate;
+}
+
+void AInteractableSelector::KeepSelection(UWorld* World, FSelectorAim const& Aim)
+{
+	// Re-orient the beam.
+	OrientBeam();
+	if (bAlwaysShowAimingActor)
+	{
+		UpdateAimingActorTransform(World, Aim);
+	}
+}
+
+void AInteractableSelector::ApplyCandidate(UWorld* World, AInteractable* Candidate, bool CandidateInNearField, FSelectorAim const& Aim, float DeltaTime)
+{
+	if (!Candidate || bAlwaysShowAimingActor)
+	{
+		if (AimingActor)
 		{
-			CandidatePreSelection = Candidate;
-			CandidatePreSelectionTimeMs = 0.0f;
+			// If there are no hits, we help by displaying the aiming actor.
+			ActivateAimingActor(true);
+			UpdateAimingActorTransform(World, Aim);
 		}
-		else
+	}
+	else
+	{
+		// Do no show the aiming actor when we hit an interactable.
+		ActivateAimingActor(false);
+
+		// When we have a candidate, this first non-interactable actor hit is cleared.
+		NonInteractableActorHit.Reset();
+	}
+
+	// Near-field selection is immediate.  , otherwise we update selection time on candidate in pre-selection.
+	if (CandidateInNearField)
+	{
+		CandidatePreSelection = Candidate;
+		CandidatePreSelectionTimeMs = Candidate->FarFieldSelectionDelayMs;
+	}
+	else if (CandidatePreSelection != Candidate)
+	{
+		CandidatePreSelection = Candidate;
+		CandidatePreSelectionTimeMs = 0.0f;
+	}
+	else
+	{
+		CandidatePreSelectionTimeMs += DeltaTime * 1000.0f;
+	}
+
+	SetSelectedInteractable(CandidatePreSelection, CandidatePreSelectionTimeMs, true, CandidateInNearField);
+}
+
+void AInteractableSelector::UpdateAimingActorTransform(UWorld* World, FSelectorAim const& Aim)
+{
+	if (!AimingActor)
+	{
+		return;
+	}
+
+	TArray<FHitResult> Hits;
+	QueryMultiByChannel(World, AimingTraceHandle, Aim.QueryStartCast, Aim.QueryEndCast, ECC_Visibility, FCollisionShape(), Hits);
+
+	auto const AimingQuat = AimingActor->GetActorQuat();
+
+	// Default target aiming when we have not hit normal.
+	auto const RightVector = FVector::CrossProduct(DampenedForwardVector, FVector::UpVector);
+	auto ForwardVector = FVector::CrossProduct(Aim.StartCast - Aim.EndCast, RightVector);
+	auto TargetAimingQuat = FQuat(FRotationMatrix::MakeFromXZ(ForwardVector, Aim.StartCast - Aim.EndCast).Rotator());
+
+	if (Hits.Num() > 0)
+	{
+		NonInteractableActorHit = Hits[0].GetActor();
+
+		if (bAlignAimingActorWithHitNormal)
 		{
-			CandidatePreSelectionTimeMs += DeltaTime * 1000.0f;
+			// Align with hit normal.
+			ForwardVector = FVector::CrossProduct(Hits[0].ImpactNormal, RightVector);
+			TargetAimingQuat = FQuat(FRotationMatrix::MakeFromXZ(ForwardVector, Hits[0].ImpactNormal).Rotator());
 		}
 
-		SetSelectedInteractable(CandidatePreSelection, CandidatePreSelectionTimeMs, true, CandidateInNearField);
+		AimingActor->SetActorLocation(Hits[0].ImpactPoint);
+	}
+	else
+	{
+		// Place the actor at the end of the cast of nothing is hit.
+		AimingActor->SetActorLocation(Aim.EndCast);
+	}
+
+	auto const LerpedTargetAimingQuat = FQuat::FastLerp(AimingQuat, TargetAimingQuat, AimingActorRotationRate);
+	AimingActor->SetActorRotation(LerpedTargetAimingQuat);
+}
+
+void AInteractableSelector::ComputeNearFieldAim(FSelectorAim& Aim) const
+{
+	ComputeNearFieldRaycastEndpoints(Aim.StartCast, Aim.EndCast);
+	Aim.QueryStartCast = Aim.StartCast;
+	Aim.QueryEndCast = Aim.EndCast;
+}
+
+void AInteractableSelector::ComputeFarFieldAim(UWorld* World, FSelectorAim& Aim) const
+{
+	ComputeFarFieldRaycastEndpoints(Aim.StartCast, Aim.EndCast);
+
+	// Async queries are consumed on the next tick, so we cast them where we expect to aim by then.
+	if (bUseAsyncSceneQueries && bExtrapolateAsyncSceneQueries)
+	{
+		auto const ExtrapolatedForwardVector = (2.0f * DampenedForwardVector - PreviousDampenedForwardVector).GetSafeNormal();
+		ComputeFarFieldRaycastEndpoints(ExtrapolatedForwardVector, Aim.QueryStartCast, Aim.QueryEndCast);
+	}
+	else
+	{
+		Aim.QueryStartCast = Aim.StartCast;
+		Aim.QueryEndCast = Aim.EndCast;
+	}
+
+	if (bRaycastDebugTrace)
+	{
+		DrawDebugLine(World, Aim.StartCast, Aim.EndCast, FColor::Green, false, -1.0f, 0, 0.1f);
 	}
 }
 
@@ -324,6 +545,17 @@ bool AInteractableSelector::ShouldSelect_Implementation(AInteractable* Interacta
 	return true;
 }
 
+bool AInteractableSelector::CanSelect(AInteractable* Interactable) const
+{
+	if (!EInteractableSelectionFlags::CanBeSelected(Interactable->GetSelectionFlags(), SelectionChannels))
+	{
+		return false;
+	}
+
+	// Native overrides are plain virtual calls, only blueprint overrides need the VM.
+	return bShouldSelectImplementedInScript ? ShouldSelect(Interactable) : ShouldSelect_Implementation(Interactable);
+}
+
 void AInteractableSelector::ActivateSelector(bool Activate)
 {
 	if (bSelectorActivated != Activate)
@@ -331,11 +563,17 @@ void AInteractableSelector::ActivateSelector(bool Activate)
 		if (Activate)
 		{
 			UpdateDampenedForwardVector(0.0f);
+			PreviousDampenedForwardVector = DampenedForwardVector;
 		}
 		else
 		{
 			SetSelectedInteractable(nullptr);
 			ActivateAimingActor(false);
+
+			// Results of pending async queries are stale by the time we are activated again.
+			NearFieldTraceHandle = FTraceHandle();
+			FarFieldTraceHandle = FTraceHandle();
+			AimingTraceHandle = FTraceHandle();
 		}
 
 		bSelectorActivated = Activate;
@@ -344,9 +582,16 @@ void AInteractableSelector::ActivateSelector(bool Activate)
 
 void AInteractableSelector::UpdateDampenedForwardVector(float Dampening)
 {
-	DampenedForwardVector *= Dampening;
-	DampenedForwardVector += GetActorForwardVector() * (1.0f - Dampening);
-	DampenedForwardVector.Normalize();
+	PreviousDampenedForwardVector = DampenedForwardVector;
+	DampenedForwardVector = ComputeDampenedForwardVector(Dampening);
+}
+
+FVector AInteractableSelector::ComputeDampenedForwardVector(float Dampening) const
+{
+	auto Result = DampenedForwardVector * Dampening;
+	Result += GetActorForwardVector() * (1.0f - Dampening);
+	Result.Normalize();
+	return Result;
 }
 
 void AInteractableSelector::ComputeNearFieldRaycastEndpoints(FVector& Start, FVector& End) const
@@ -358,11 +603,48 @@ void AInteractableSelector::ComputeNearFieldRaycastEndpoints(FVector& Start, FVe
 }
 
 void AInteractableSelector::ComputeFarFieldRaycastEndpoints(FVector& Start, FVector& End) const
+{
+	ComputeFarFieldRaycastEndpoints(DampenedForwardVector, Start, End);
+}
+
+void AInteractableSelector::ComputeFarFieldRaycastEndpoints(FVector const& Forward, FVector& Start, FVector& End) const
 {
 	auto const ActorPos = GetActorLocation();
-	auto const ActorFwd = DampenedForwardVector;
-	Start = ActorPos + ActorFwd * RaycastOffset;
-	End = ActorPos + ActorFwd * (RaycastOffset + RaycastDistance);
+	Start = ActorPos + Forward * RaycastOffset;
+	End = ActorPos + Forward * (RaycastOffset + RaycastDistance);
+}
+
+void AInteractableSelector::QueryMultiByChannel(UWorld* World, FTraceHandle& AsyncHandle, FVector const& Start, FVector const& End,
+	ECollisionChannel TraceChannel, FCollisionShape const& CollisionShape, TArray<FHitResult>& OutHits)
+{
+	// The async query made on the previous tick has run by now. Without one, e.g. on the first tick after switching
+	// between near-field and far-field, we query right away rather than going a tick without hits.
+	FTraceDatum TraceData;
+	if (bUseAsyncSceneQueries && AsyncHandle.IsValid() && World->QueryTraceData(AsyncHandle, TraceData))
+	{
+		OutHits = MoveTemp(TraceData.OutHits);
+	}
+	else if (CollisionShape.IsLine())
+	{
+		World->LineTraceMultiByChannel(OutHits, Start, End, TraceChannel);
+	}
+	else
+	{
+		World->SweepMultiByChannel(OutHits, Start, End, FQuat::Identity, TraceChannel, CollisionShape);
+	}
+
+	if (!bUseAsyncSceneQueries)
+	{
+		AsyncHandle = FTraceHandle();
+	}
+	else if (CollisionShape.IsLine())
+	{
+		AsyncHandle = World->AsyncLineTraceByChannel(EAsyncTraceType::Multi, Start, End, TraceChannel);
+	}
+	else
+	{
+		AsyncHandle = World->AsyncSweepByChannel(EAsyncTraceType::Multi, Start, End, FQuat::Identity, TraceChannel, CollisionShape);
+	}
 }
 
 float AInteractableSelector::ComputeSphereRadiusForCast() const
@@ -372,19 +654,10 @@ float AInteractableSelector::ComputeSphereRadiusForCast() const
 
 float AInteractableSelector::ComputeAngularDistance(AActor* Target) const
 {
-	auto const LineStart = GetActorLocation();
-	auto const LineEnd = GetActorLocation() + 100.0f * DampenedForwardVector; // Any point will do, but projecting forward will reduce errors.
-	auto const TargetLocation = Target->GetActorLocation();
-
-	auto const NearestLocation = FMath::ClosestPointOnInfiniteLine(LineStart, LineEnd, TargetLocation);
-
-	auto const DistNearestToUs = FVector::Distance(NearestLocation, LineStart);
-	auto const DistNearestToTargetCenter = FVector::Distance(NearestLocation, TargetLocation);
-	auto const DistNearestToTarget = FMath::Max(DistNearestToTargetCenter - Target->GetSimpleCollisionRadius() * 0.5f, 0.0f);
-
-	auto const AngleToTargetRadians = FMath::FastAsin(DistNearestToTarget / DistNearestToUs);
+	auto const Cone = FSelectionCone(GetActorLocation(), DampenedForwardVector);
+	auto const CosAngle = Cone.GetCosAngleTo(Target->GetActorLocation(), Target->GetSimpleCollisionRadius() * TargetRadiusScale);
 
-	return FMath::RadiansToDegrees(AngleToTargetRadians);
+	return FMath::RadiansToDegrees(FMath::Acos(FMath::Clamp(CosAngle, -1.0f, 1.0f)));
 }
 
 void AInteractableSelector::ActivateAimingActor(bool Activate) const
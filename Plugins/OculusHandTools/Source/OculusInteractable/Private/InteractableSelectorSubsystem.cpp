@@ -0,0 +1,75 @@
+// Copyright (c) Meta Platforms, Inc. and affiliates.
+
+#include "InteractableSelectorSubsystem.h"
+#include "Async/ParallelFor.h"
+#include "InteractableSubsystem.h"
+
+void UInteractableSelectorSubsystem::RegisterSelector(AInteractableSelector* Selector)
+{
+	Selectors.AddUnique(Selector);
+	Selector->bRegisteredForBatching = true;
+}
+
+void UInteractableSelectorSubsystem::UnregisterSelector(AInteractableSelector* Selector)
+{
+	Selectors.Remove(Selector);
+	Selector->bRegisteredForBatching = false;
+}
+
+void UInteractableSelectorSubsystem::Tick(float DeltaTime)
+{
+	Super::Tick(DeltaTime);
+
+	auto const Registry = GetWorld()->GetSubsystem<UInteractableSubsystem>();
+	if (!Registry)
+	{
+		return;
+	}
+
+	BatchedSelectors.Reset();
+	for (auto const& Selector : Selectors)
+	{
+		if (Selector.IsValid() && Selector->bSelectorActivated && Selector->IsSelectionBatched())
+		{
+			BatchedSelectors.Add(Selector.Get());
+		}
+	}
+
+	if (BatchedSelectors.IsEmpty())
+	{
+		return;
+	}
+
+	// Searches are reused, to keep the memory of their arrays.
+	if (Searches.Num() < BatchedSelectors.Num())
+	{
+		Searches.SetNum(BatchedSelectors.Num());
+	}
+
+	for (auto i = 0; i < BatchedSelectors.Num(); ++i)
+	{
+		BatchedSelectors[i]->BeginCandidateSearch(Searches[i]);
+	}
+
+	Registry->FlushMovedInteractables();
+	ParallelFor(BatchedSelectors.Num(), [&](int32 i)
+	{
+		AInteractableSelector::RunCandidateSearch(Searches[i], *Registry);
+	});
+
+	// ShouldSelect, and the BeginSelection and EndSelection events, run on the game thread in a deterministic order.
+	for (auto i = 0; i < BatchedSelectors.Num(); ++i)
+	{
+		// A selection event of a previous selector may have deactivated or destroyed this one.
+		auto const Selector = BatchedSelectors[i];
+		if (IsValid(Selector) && Selector->bSelectorActivated)
+		{
+			Selector->FinishCandidateSearch(Searches[i], DeltaTime);
+		}
+	}
+}
+
+TStatId UInteractableSelectorSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UInteractableSelectorSubsystem, STATGROUP_Tickables);
+}
@@ -0,0 +1,256 @@
+// Copyright (c) Meta Platforms, Inc. and affiliates.
+
+#include "InteractableSubsystem.h"
+#include "Components/PrimitiveComponent.h"
+#include "Components/SceneComponent.h"
+#include "Interactable.h"
+#include "OculusInteractableModule.h"
+
+void UInteractableSubsystem::Initialize(FSubsystemCollectionBase& Collection)
+{
+	Super::Initialize(Collection);
+
+	Grid = FInteractableGrid(CellSize);
+}
+
+void UInteractableSubsystem::Deinitialize()
+{
+	for (auto& Registration : Registrations)
+	{
+		if (auto* const Root = Registration.Root.Get())
+		{
+			Root->TransformUpdated.Remove(Registration.TransformUpdatedHandle);
+		}
+
+		if (auto* const Interactable = Registration.Interactable.Get())
+		{
+			Interactable->RegistryId = INDEX_NONE;
+		}
+	}
+
+	Registrations.Empty();
+	MovedIds.Empty();
+	Grid.Reset();
+
+	Super::Deinitialize();
+}
+
+void UInteractableSubsystem::RegisterInteractable(AInteractable* Interactable)
+{
+	if (!Interactable || Interactable->RegistryId != INDEX_NONE)
+	{
+		return;
+	}
+
+	auto* const Root = Interactable->GetRootComponent();
+	if (!Root)
+	{
+		UE_LOG(LogInteractable, Warning, TEXT("%s has no root component and can't be selected or grabbed"),
+			*Interactable->GetHumanReadableName());
+		return;
+	}
+
+	auto const Id = Registrations.Add(FRegistration());
+	auto& Registration = Registrations[Id];
+	Registration.Interactable = Interactable;
+	Registration.Root = Root;
+	Registration.TransformUpdatedHandle = Root->TransformUpdated.AddUObject(this, &UInteractableSubsystem::HandleTransformUpdated, Id);
+	CacheBoundsAndFlags(Registration);
+
+	Interactable->RegistryId = Id;
+	UpdateGrid(Id);
+}
+
+void UInteractableSubsystem::UnregisterInteractable(AInteractable* Interactable)
+{
+	if (!Interactable || !Registrations.IsValidIndex(Interactable->RegistryId))
+	{
+		return;
+	}
+
+	auto const Id = Interactable->RegistryId;
+	if (auto* const Root = Registrations[Id].Root.Get())
+	{
+		Root->TransformUpdated.Remove(Registrations[Id].TransformUpdatedHandle);
+	}
+
+	// a pending move of this id is skipped by FlushMovedInteractables, even if the id is reused
+	Grid.Remove(Id);
+	Registrations.RemoveAt(Id);
+	Interactable->RegistryId = INDEX_NONE;
+}
+
+void UInteractableSubsystem::RefreshInteractable(AInteractable* Interactable)
+{
+	if (Interactable && Interactable->RegistryId != INDEX_NONE)
+	{
+		// registering again also picks up a new root component
+		UnregisterInteractable(Interactable);
+		RegisterInteractable(Interactable);
+	}
+}
+
+void UInteractableSubsystem::UpdateSelectionFlags(AInteractable* Interactable)
+{
+	if (Interactable && Registrations.IsValidIndex(Interactable->RegistryId))
+	{
+		Registrations[Interactable->RegistryId].SelectionFlags = Interactable->GetSelectionFlags();
+	}
+}
+
+void UInteractableSubsystem::QuerySphere(FVector const& Center, float Radius, TArray<FRegisteredInteractable>& OutInteractables)
+{
+	FlushMovedInteractables();
+	FindInSphere(Center, Radius, OutInteractables);
+}
+
+void UInteractableSubsystem::QueryCapsule(FVector const& Start, FVector const& End, float Radius, TArray<FRegisteredInteractable>& OutInteractables)
+{
+	FlushMovedInteractables();
+	FindInCapsule(Start, End, Radius, OutInteractables);
+}
+
+void UInteractableSubsystem::FindInSphere(FVector const& Center, float Radius, TArray<FRegisteredInteractable>& OutInteractables) const
+{
+	TArray<int32> Ids;
+	Grid.QuerySphere(Center, Radius, Ids);
+	ResolveQuery(Ids, OutInteractables);
+}
+
+void UInteractableSubsystem::FindInCapsule(FVector const& Start, FVector const& End, float Radius, TArray<FRegisteredInteractable>& OutInteractables) const
+{
+	TArray<int32> Ids;
+	Grid.QueryCapsule(Start, End, Radius, Ids);
+	ResolveQuery(Ids, OutInteractables);
+}
+
+TArray<AInteractable*> UInteractableSubsystem::GetInteractablesInSphere(FVector Center, float Radius)
+{
+	TArray<FRegisteredInteractable> Found;
+	QuerySphere(Center, Radius, Found);
+
+	TArray<AInteractable*> Interactables;
+	Interactables.Reserve(Found.Num());
+	for (auto const& Registered : Found)
+	{
+		Interactables.Add(Registered.Interactable);
+	}
+
+	return Interactables;
+}
+
+bool UInteractableSubsystem::GetBounds(AInteractable const* Interactable, FVector& OutCenter, float& OutRadius)
+{
+	if (!Interactable || !Grid.Contains(Interactable->RegistryId))
+	{
+		return false;
+	}
+
+	FlushMovedInteractables();
+
+	OutCenter = Grid.GetCenter(Interactable->RegistryId);
+	OutRadius = Grid.GetRadius(Interactable->RegistryId);
+	return true;
+}
+
+void UInteractableSubsystem::CacheBoundsAndFlags(FRegistration& Registration) const
+{
+	auto* const Interactable = Registration.Interactable.Get();
+
+	// the bounds of the components the queries can find, in the space of the root component, unscaled
+	auto const WorldToActor = Interactable->GetActorTransform().Inverse();
+	auto LocalBounds = FBox(ForceInit);
+	Interactable->ForEachComponent<UPrimitiveComponent>(false, [&](UPrimitiveComponent const* Component)
+	{
+		auto const bQueried = Component->IsRegistered() && QueryChannels.ContainsByPredicate([Component](ECollisionChannel Channel)
+		{
+			return Component->IsQueryCollisionEnabled() && Component->GetCollisionResponseToChannel(Channel) != ECR_Ignore;
+		});
+		if (bQueried)
+		{
+			LocalBounds += Component->CalcBounds(Component->GetComponentTransform() * WorldToActor).GetBox();
+		}
+	});
+	Registration.LocalCenter = LocalBounds.IsValid ? LocalBounds.GetCenter() : FVector::ZeroVector;
+	Registration.LocalRadius = LocalBounds.IsValid ? LocalBounds.GetExtent().Size() : 0.f;
+
+	Registration.SelectionFlags = Interactable->GetSelectionFlags();
+}
+
+bool UInteractableSubsystem::OverlapInteractable(AInteractable const* Interactable, ECollisionChannel Channel,
+	FVector const& Location, FQuat const& Rotation, FCollisionShape const& Shape)
+{
+	auto bOverlaps = false;
+	Interactable->ForEachComponent<UPrimitiveComponent>(false, [&](UPrimitiveComponent const* Component)
+	{
+		bOverlaps = bOverlaps || (Component->IsQueryCollisionEnabled()
+			&& Component->GetCollisionResponseToChannel(Channel) != ECR_Ignore
+			&& Component->OverlapComponent(Location, Rotation, Shape));
+	});
+
+	return bOverlaps;
+}
+
+bool UInteractableSubsystem::SweepInteractable(AInteractable* Interactable, ECollisionChannel Channel,
+	FVector const& Start, FVector const& End, FCollisionShape const& Shape)
+{
+	auto bHit = false;
+	Interactable->ForEachComponent<UPrimitiveComponent>(false, [&](UPrimitiveComponent* Component)
+	{
+		FHitResult Hit;
+		bHit = bHit || (Component->IsQueryCollisionEnabled()
+			&& Component->GetCollisionResponseToChannel(Channel) != ECR_Ignore
+			&& Component->SweepComponent(Hit, Start, End, FQuat::Identity, Shape));
+	});
+
+	return bHit;
+}
+
+void UInteractableSubsystem::HandleTransformUpdated(USceneComponent* Component, EUpdateTransformFlags Flags, ETeleportType Teleport, int32 Id)
+{
+	// moves are applied to the grid on the next query, an interactable can move several times per frame
+	auto& Registration = Registrations[Id];
+	if (!Registration.bDirty)
+	{
+		Registration.bDirty = true;
+		MovedIds.Add(Id);
+	}
+}
+
+void UInteractableSubsystem::UpdateGrid(int32 Id)
+{
+	auto& Registration = Registrations[Id];
+	Registration.bDirty = false;
+
+	if (auto const* Root = Registration.Root.Get())
+	{
+		auto const& Transform = Root->GetComponentTransform();
+		Registration.Location = Transform.GetLocation();
+		Grid.Update(Id, Transform.TransformPosition(Registration.LocalCenter), Registration.LocalRadius * Transform.GetMaximumAxisScale());
+	}
+}
+
+void UInteractableSubsystem::FlushMovedInteractables()
+{
+	for (auto const Id : MovedIds)
+	{
+		if (Registrations.IsValidIndex(Id) && Registrations[Id].bDirty)
+		{
+			UpdateGrid(Id);
+		}
+	}
+
+	MovedIds.Reset();
+}
+
+void UInteractableSubsystem::ResolveQuery(TArray<int32> const& Ids, TArray<FRegisteredInteractable>& OutInteractables) const
+{
+	for (auto const Id : Ids)
+	{
+		auto const& Registration = Registrations[Id];
+		if (auto* const Interactable = Registration.Interactable.Get())
+		{
+			OutInteractables.Add(FRegisteredInteractable{Interactable, Registration.Location, Grid.GetCenter(Id), Grid.GetRadius(Id), Registration.SelectionFlags});
+		}
+	}
+}
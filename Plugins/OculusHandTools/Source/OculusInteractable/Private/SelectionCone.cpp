@@ -0,0 +1,143 @@
+// Copyright (c) Meta Platforms, Inc. and affiliates.
+
+#include "SelectionCone.h"
+
+void FSelectionConeCandidates::Reset(FVector const& InApex)
+{
+	Apex = InApex;
+	X.Reset();
+	Y.Reset();
+	Z.Reset();
+	Radii.Reset();
+	Distances.Reset();
+	NumCandidates = 0;
+}
+
+void FSelectionConeCandidates::Add(FVector const& Center, float Radius, float Distance)
+{
+	if (NumCandidates == X.Num())
+	{
+		X.AddZeroed(4);
+		Y.AddZeroed(4);
+		Z.AddZeroed(4);
+		Radii.AddZeroed(4);
+		Distances.AddZeroed(4);
+	}
+
+	auto const Offset = Center - Apex;
+	X[NumCandidates] = static_cast<float>(Offset.X);
+	Y[NumCandidates] = static_cast<float>(Offset.Y);
+	Z[NumCandidates] = static_cast<float>(Offset.Z);
+	Radii[NumCandidates] = Radius;
+	Distances[NumCandidates] = Distance;
+	++NumCandidates;
+}
+
+FSelectionCone::FSelectionCone(FVector const& InApex, FVector const& InAxis) :
+	Apex(InApex), Axis(InAxis.GetSafeNormal())
+{
+}
+
+float FSelectionCone::GetCosAngleTo(FVector const& Center, float Radius) const
+{
+	auto const Offset = FVector3f(Center - Apex);
+	auto const DistanceSquared = Offset.SizeSquared();
+	auto const Along = FVector3f::DotProduct(Offset, FVector3f(Axis));
+	auto const PerpendicularSquared = FMath::Max(DistanceSquared - Along * Along, 0.f);
+	auto const RadiusSquared = Radius * Radius;
+
+	if (DistanceSquared <= RadiusSquared || Along > 0.f && PerpendicularSquared <= RadiusSquared)
+	{
+		return 1.f;
+	}
+
+	// cos(A - B), A being the angle to the center and B the half angle the sphere covers
+	return (Along * FMath::Sqrt(DistanceSquared - RadiusSquared) + FMath::Sqrt(PerpendicularSquared) * Radius) /
+		FMath::Max(DistanceSquared, UE_SMALL_NUMBER);
+}
+
+int32 FSelectionCone::FindBest(FSelectionConeCandidates const& Candidates, float MinCosAngle, float MaxDistance, TArray<float>& OutCosAngles) const
+{
+	ComputeCosAngles(Candidates, OutCosAngles);
+
+	auto BestIndex = INDEX_NONE;
+	auto BestCosAngle = MinCosAngle;
+	auto BestDistance = MaxDistance;
+	for (auto i = 0; i < Candidates.NumCandidates; ++i)
+	{
+		auto const CosAngle = OutCosAngles[i];
+		auto const Distance = Candidates.Distances[i];
+		if (CosAngle > BestCosAngle || CosAngle == BestCosAngle && Distance < BestDistance)
+		{
+			BestIndex = i;
+			BestCosAngle = CosAngle;
+			BestDistance = Distance;
+		}
+	}
+
+	return BestIndex;
+}
+
+void FSelectionCone::Rank(FSelectionConeCandidates const& Candidates, float MinCosAngle, float MaxDistance, TArray<float>& OutCosAngles,
+	TArray<int32>& OutOrder) const
+{
+	ComputeCosAngles(Candidates, OutCosAngles);
+
+	OutOrder.Reset();
+	for (auto i = 0; i < Candidates.NumCandidates; ++i)
+	{
+		auto const CosAngle = OutCosAngles[i];
+		if (CosAngle > MinCosAngle || CosAngle == MinCosAngle && Candidates.Distances[i] < MaxDistance)
+		{
+			OutOrder.Add(i);
+		}
+	}
+
+	// stable, so that like FindBest the first of equal candidates comes first
+	OutOrder.StableSort([&](int32 A, int32 B)
+	{
+		return OutCosAngles[A] > OutCosAngles[B] || OutCosAngles[A] == OutCosAngles[B] && Candidates.Distances[A] < Candidates.Distances[B];
+	});
+}
+
+void FSelectionCone::ComputeCosAngles(FSelectionConeCandidates const& Candidates, TArray<float>& OutCosAngles) const
+{
+	checkSlow(Candidates.Apex.Equals(Apex));
+
+	// same as GetCosAngleTo, four candidates at a time over the padded arrays
+	auto const NumPadded = Candidates.X.Num();
+	OutCosAngles.SetNumUninitialized(NumPadded, EAllowShrinking::No);
+
+	auto const AxisX = VectorSetFloat1(static_cast<float>(Axis.X));
+	auto const AxisY = VectorSetFloat1(static_cast<float>(Axis.Y));
+	auto const AxisZ = VectorSetFloat1(static_cast<float>(Axis.Z));
+	auto const Zero = VectorZeroFloat();
+	auto const One = VectorOneFloat();
+	auto const SmallNumber = VectorSetFloat1(UE_SMALL_NUMBER);
+
+	for (auto i = 0; i < NumPadded; i += 4)
+	{
+		auto const X = VectorLoad(&Candidates.X[i]);
+		auto const Y = VectorLoad(&Candidates.Y[i]);
+		auto const Z = VectorLoad(&Candidates.Z[i]);
+		auto const Radius = VectorLoad(&Candidates.Radii[i]);
+
+		auto const DistanceSquared = VectorMultiplyAdd(X, X, VectorMultiplyAdd(Y, Y, VectorMultiply(Z, Z)));
+		auto const Along = VectorMultiplyAdd(X, AxisX, VectorMultiplyAdd(Y, AxisY, VectorMultiply(Z, AxisZ)));
+		auto const PerpendicularSquared = VectorMax(VectorSubtract(DistanceSquared, VectorMultiply(Along, Along)), Zero);
+		auto const RadiusSquared = VectorMultiply(Radius, Radius);
+
+		auto const CosAngle = VectorDivide(
+			VectorMultiplyAdd(Along, VectorSqrt(VectorMax(VectorSubtract(DistanceSquared, RadiusSquared), Zero)),
+				VectorMultiply(VectorSqrt(PerpendicularSquared), Radius)),
+			VectorMax(DistanceSquared, SmallNumber));
+
+		auto const bAxisThroughSphere = VectorBitwiseOr(
+			VectorCompareLE(DistanceSquared, RadiusSquared),
+			VectorBitwiseAnd(VectorCompareGT(Along, Zero), VectorCompareLE(PerpendicularSquared, RadiusSquared)));
+
+		VectorStore(VectorSelect(bAxisThroughSphere, One, CosAngle), &OutCosAngles[i]);
+	}
+
+	OutCosAngles.SetNum(Candidates.NumCandidates, EAllowShrinking::No);
+}
@@ -10,6 +10,17 @@
 #include "HandGrabbingComponent.generated.h"
 
 class OCULUSINTERACTABLE_API AInteractable;
+class UPhysicsHandleComponent;
+
+/** How a UHandGrabbingComponent holds what it grabbed. */
+UENUM(BlueprintType)
+enum class EGrabHoldMode : uint8
+{
+	/** Physics simulation is turned off while held, and back on when released. */
+	TogglePhysics,
+	/** Simulating objects keep simulating, pulled to the hand by a physics handle. */
+	PhysicsHandle
+};
 
 UCLASS(ClassGroup=(Custom), meta=(BlueprintSpawnableComponent))
 class OCULUSINTERACTABLE_API UHandGrabbingComponent : public USceneComponent
@@ -17,12 +28,34 @@ class OCULUSINTERACTABLE_API UHandGrabbingComponent : public USceneComponent
 	GENERATED_BODY()
 
 public:
+	UHandGrabbingComponent();
+
+	virtual void TickComponent(float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction) override;
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
 	UFUNCTION(BlueprintCallable, Category = "Grabbing")
 	AInteractable* TryGrab(FTransform GrabTransform);
 
 	UFUNCTION(BlueprintCallable, Category = "Grabbing")
 	AInteractable* TryRelease(bool bReenablePhysics = true);
 
+	/**
+	 * Releases the grabbed actor and sets the velocities of its root component, e.g. from UThrowingComponent.
+	 * @param LinearVelocity - Linear velocity (cm/s).
+	 * @param AngularVelocity - World-space axis * angular speed (rad/s).
+	 * @return The released actor, if any.
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Grabbing")
+	AInteractable* TryThrow(FVector LinearVelocity, FVector AngularVelocity);
+
+	/**
+	 * Sets where a grabbed actor held by a physics handle is pulled to, e.g. the transform of a grab pose.
+	 * It defaults to where the actor was relative to us when grabbed.
+	 * @param RelativeTransform - The grabbed actor's transform relative to us.
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Grabbing")
+	void SetHoldTransform(FTransform RelativeTransform);
+
 	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "Grabbing")
 	EOculusXRHandType Hand = EOculusXRHandType::HandLeft;
 
@@ -38,7 +71,41 @@ public:
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Grabbing")
 	float GrabCapsuleRadius = 20.f;
 
+	/** Find interactables in the world's UInteractableSubsystem instead of overlapping ECC_WorldDynamic. */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Grabbing")
+	bool bUseInteractableRegistry = true;
+
+	/**
+	 * How to hold grabbed actors. With PhysicsHandle, simulating actors are not attached to us, and their physics
+	 * body is never recreated, so juggling objects quickly does not cause spikes.
+	 */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Grabbing")
+	EGrabHoldMode HoldMode = EGrabHoldMode::TogglePhysics;
+
+	/** Stiffness of the physics handle pulling held actors to their location. */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Grabbing", meta = (EditCondition = "HoldMode == EGrabHoldMode::PhysicsHandle"))
+	float HoldLinearStiffness = 5000.f;
+
+	/** Stiffness of the physics handle pulling held actors to their rotation. */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Grabbing", meta = (EditCondition = "HoldMode == EGrabHoldMode::PhysicsHandle"))
+	float HoldAngularStiffness = 5000.f;
+
+	/** Whether the grabbed actor is held by the physics handle. */
+	UFUNCTION(BlueprintPure, Category = "Grabbing")
+	bool IsHoldingWithPhysicsHandle() const { return bHoldingWithPhysicsHandle; }
+
 private:
+	/** Grabbed actors' transform relative to us, when held by the physics handle. */
+	FTransform HoldTransform;
+	bool bHoldingWithPhysicsHandle = false;
+
+	UPROPERTY(Transient)
+	UPhysicsHandleComponent* PhysicsHandle = nullptr;
+
+	/** Grabs with the physics handle, creating it if needed. */
+	bool GrabWithPhysicsHandle(UPrimitiveComponent* Primitive);
+
+
 	UFUNCTION()
 	void HandleHeldActorDestroyed(AActor* DestroyedActor);
 };
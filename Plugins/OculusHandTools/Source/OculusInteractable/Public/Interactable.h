@@ -8,6 +8,8 @@
 #include "Interactable.generated.h"
 
 class AInteractableSelector;
+class UInteractableGrabPoses;
+class UInteractableSubsystem;
 
 UENUM(BlueprintType)
 enum class EHandSide : uint8
@@ -16,6 +18,47 @@ enum class EHandSide : uint8
 	HandRight
 };
 
+/** Tags matching interactables with the selectors that can select them, see AInteractable::SelectionChannels. */
+UENUM(BlueprintType, meta = (Bitflags))
+enum class EInteractableSelectionChannel : uint8
+{
+	Channel1,
+	Channel2,
+	Channel3,
+	Channel4,
+	Channel5,
+	Channel6,
+	Channel7,
+	Channel8
+};
+
+/** Bits of AInteractable::GetSelectionFlags. */
+namespace EInteractableSelectionFlags
+{
+	enum Type : uint32
+	{
+		/** IsMovable. */
+		Movable = 1 << 0,
+		/** IsSelectable. */
+		Selectable = 1 << 1,
+		/** The flags are recomputed whenever they are read, see AInteractable::bDynamicSelectionFlags. */
+		Dynamic = 1 << 2,
+	};
+
+	/** AInteractable::SelectionChannels are stored from this bit up. */
+	constexpr uint32 ChannelShift = 8;
+
+	/**
+	 * Whether an interactable can be selected by a selector.
+	 * @param Flags - The interactable's selection flags.
+	 * @param Channels - The selector's channels.
+	 */
+	inline bool CanBeSelected(uint32 Flags, uint32 Channels)
+	{
+		return ((Flags & Selectable) != 0) & ((Flags & (Channels << ChannelShift)) != 0);
+	}
+}
+
 /** Base actor class of interactable objects. */
 UCLASS()
 class OCULUSINTERACTABLE_API AInteractable : public AActor
@@ -108,16 +151,65 @@ public:
 	UFUNCTION(BlueprintCallable, BlueprintNativeEvent)
 	bool IsMovable();
 
-	/** Hand poses when grabbed. */
+	/** Whether selectors can select us. Call InvalidateSelectionFlags after changing it. */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Interactable Selection")
+	bool bSelectable;
+
+	/** The channels of the selectors that can select us. Call InvalidateSelectionFlags after changing them. */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Interactable Selection", meta = (Bitmask, BitmaskEnum = "/Script/OculusInteractable.EInteractableSelectionChannel"))
+	int32 SelectionChannels;
+
+	/**
+	 * Recompute the selection flags whenever they are read, rather than when InvalidateSelectionFlags is called.
+	 * Only needed when IsMovable or IsSelectable are overridden in blueprint and change on their own, as the overrides
+	 * are then called for every selection and grab test.
+	 */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Interactable Selection")
+	bool bDynamicSelectionFlags;
+
+	/**
+	 * Method to check if object can be selected.
+	 * By default it returns bSelectable.
+	 * You can override this method in blueprint for special cases.
+	 */
+	UFUNCTION(BlueprintCallable, BlueprintNativeEvent)
+	bool IsSelectable();
+
+	/**
+	 * Recomputes the cached selection flags, calling IsMovable and IsSelectable.
+	 * Call after changing the result of either, or one of the properties of the "Interactable Selection" category.
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Interactable Selection")
+	void InvalidateSelectionFlags();
+
+	/**
+	 * Selection flags, see EInteractableSelectionFlags, cached so that selectors and grabbing components test bits
+	 * instead of calling IsMovable and IsSelectable.
+	 * @return The flags.
+	 */
+	uint32 GetSelectionFlags()
+	{
+		if (bDynamicSelectionFlags)
+		{
+			SelectionFlags = ComputeSelectionFlags();
+		}
+		return SelectionFlags;
+	}
+
+	/** Hand poses when grabbed, shared with the other interactables referencing the asset. */
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "Interactable Grab Pose")
+	UInteractableGrabPoses* GrabPoseAsset;
+
+	/** Hand poses when grabbed. When not empty, they override those of GrabPoseAsset for this instance. */
 	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "Interactable Grab Pose")
 	TArray<FInteractablePose> GrabPosesLeftHand;
 
-	/** Hand poses when grabbed. */
+	/** Hand poses when grabbed. When not empty, they override those of GrabPoseAsset for this instance. */
 	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "Interactable Grab Pose")
 	TArray<FInteractablePose> GrabPosesRightHand;
 
 	/**
-	 * Selects the best grab pose for the interactable, if any.
+	 * Selects a random grab pose for the interactable, if any.
 	 * @param Side - EOculusXRHandType to select left or right hand.
 	 * @param GrabPoseFound - returns a boolean indicating if a grab pose was found.
 	 * @param GrabPoseName - if GrabPoseFound, returns the hand pose while grabbing.
@@ -127,7 +219,69 @@ public:
 	UFUNCTION(BlueprintCallable, Category = "Interactable Grab Pose")
 	void SelectGrabPose(EHandSide Side, bool& GrabPoseFound, FString& GrabPoseName, FTransform& GrabTransform, FString& GrabHandPose);
 
+	/**
+	 * Selects the grab pose closest to the hand's current transform, if any.
+	 * @param Side - EOculusXRHandType to select left or right hand.
+	 * @param HandTransform - World transform of the hand.
+	 * @param GrabPoseFound - returns a boolean indicating if a grab pose was found.
+	 * @param GrabPoseIndex - if GrabPoseFound, returns the index of the pose in the grab poses of the hand, ours or
+	 * those of GrabPoseAsset.
+	 * @param GrabTransform - if GrabPoseFound, returns the Interactable's transform relative to the hand.
+	 * @param GrabHandPoseId - if GrabPoseFound, returns the decoded hand pose, for SetPoseById.
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Interactable Grab Pose")
+	void SelectNearestGrabPose(EHandSide Side, FTransform HandTransform, bool& GrabPoseFound, int32& GrabPoseIndex, FTransform& GrabTransform, FHandPoseId& GrabHandPoseId);
+
+	/**
+	 * Finds the grab pose closest to the hand's current transform.
+	 * @param Side - EOculusXRHandType to select left or right hand.
+	 * @param HandTransform - World transform of the hand.
+	 * @return The grab pose, or nullptr if there is none. Valid until the grab poses are compiled again.
+	 */
+	FCompiledGrabPose const* FindNearestGrabPose(EHandSide Side, FTransform const& HandTransform);
+
+	/**
+	 * How much the hand's rotation counts when looking for the closest grab pose, in squared cm for a half turn:
+	 * a rotation by angle A counts as a move of sqrt(GrabPoseRotationWeight * (1 - cos(A / 2))) cm.
+	 */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Interactable Grab Pose")
+	float GrabPoseRotationWeight;
+
+	/**
+	 * Parses the transforms and decodes the hand poses of GrabPosesLeftHand and GrabPosesRightHand, so that selecting
+	 * a grab pose does no string work. Called on BeginPlay, call it again after changing the grab poses.
+	 * GrabPoseAsset compiles its own grab poses.
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Interactable Grab Pose")
+	void CompileGrabPoses();
+
+	/**
+	 * Whether the grab poses of a hand are those of GrabPoseAsset.
+	 * @param Side - EOculusXRHandType to select left or right hand.
+	 */
+	bool UsesGrabPoseAsset(EHandSide Side) const;
+
+	/** Memory used by the grab poses of this instance, compiled or not, not counting GrabPoseAsset. */
+	SIZE_T GetGrabPoseAllocatedSize() const;
+
 protected:
 	/** List of selectors currently selecting us. */
 	TArray<AInteractableSelector*> Selectors;
+
+private:
+	friend class UInteractableSubsystem;
+
+	/** Our id in the world's UInteractableSubsystem, INDEX_NONE when not registered. */
+	int32 RegistryId = INDEX_NONE;
+
+	/** Cached by InvalidateSelectionFlags. */
+	uint32 SelectionFlags = 0;
+
+	uint32 ComputeSelectionFlags();
+
+	/** GrabPosesLeftHand and GrabPosesRightHand compiled, indexed by EHandSide. */
+	TArray<FCompiledGrabPose> CompiledGrabPoses[2];
+	bool bGrabPosesCompiled = false;
+
+	TArray<FCompiledGrabPose> const& GetCompiledGrabPoses(EHandSide Side);
 };
@@ -0,0 +1,48 @@
+// Copyright (c) Meta Platforms, Inc. and affiliates.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Engine/DataAsset.h"
+#include "InteractablePose.h"
+#include "InteractableGrabPoses.generated.h"
+
+/**
+ * Grab poses shared by every interactable of a kind, see AInteractable::GrabPoseAsset. They are compiled once, on first
+ * use, for all the interactables referencing the asset.
+ */
+UCLASS(BlueprintType)
+class OCULUSINTERACTABLE_API UInteractableGrabPoses : public UPrimaryDataAsset
+{
+	GENERATED_BODY()
+
+public:
+	/** Hand poses when grabbed. */
+	UPROPERTY(BlueprintReadOnly, EditAnywhere, Category = "Interactable Grab Pose")
+	TArray<FInteractablePose> GrabPosesLeftHand;
+
+	/** Hand poses when grabbed. */
+	UPROPERTY(BlueprintReadOnly, EditAnywhere, Category = "Interactable Grab Pose")
+	TArray<FInteractablePose> GrabPosesRightHand;
+
+	/**
+	 * The compiled grab poses of a hand. Game thread only.
+	 * @param bLeftHand - Whether to get those of the left hand or the right hand.
+	 * @return The compiled grab poses.
+	 */
+	TArray<FCompiledGrabPose> const& GetCompiledGrabPoses(bool bLeftHand);
+
+	/** Memory used by the grab poses, compiled or not. */
+	SIZE_T GetGrabPoseAllocatedSize() const;
+
+#if WITH_EDITOR
+	virtual void PostEditChangeProperty(FPropertyChangedEvent& PropertyChangedEvent) override;
+#endif
+
+private:
+	void CompileGrabPoses();
+
+	TArray<FCompiledGrabPose> CompiledGrabPosesLeftHand;
+	TArray<FCompiledGrabPose> CompiledGrabPosesRightHand;
+	bool bGrabPosesCompiled = false;
+};
@@ -0,0 +1,59 @@
+// Copyright (c) Meta Platforms, Inc. and affiliates.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+/**
+ * Sparse hashed grid of bounding spheres, identified by caller-chosen ids. Spheres are bucketed by the cell containing
+ * their center, so moving one only touches the two cells involved. Spheres too large for a cell are kept in a separate
+ * list that every query tests.
+ */
+class OCULUSINTERACTABLE_API FInteractableGrid
+{
+public:
+	explicit FInteractableGrid(float InCellSize = 100.f);
+
+	/// Adds the sphere with this id, or moves it if it is already in the grid.
+	void Update(int32 Id, FVector const& Center, float Radius);
+
+	void Remove(int32 Id);
+
+	void Reset();
+
+	bool Contains(int32 Id) const { return Elements.IsValidIndex(Id) && Elements[Id].IndexInCell != INDEX_NONE; }
+	FVector const& GetCenter(int32 Id) const { return Elements[Id].Center; }
+	float GetRadius(int32 Id) const { return Elements[Id].Radius; }
+	int32 Num() const { return NumElements; }
+
+	/// Appends the ids of the spheres overlapping the sphere at Center.
+	void QuerySphere(FVector const& Center, float Radius, TArray<int32>& OutIds) const;
+
+	/// Appends the ids of the spheres overlapping the capsule swept by a sphere of Radius from Start to End.
+	void QueryCapsule(FVector const& Start, FVector const& End, float Radius, TArray<int32>& OutIds) const;
+
+private:
+	struct FElement
+	{
+		FVector Center = FVector::ZeroVector;
+		float Radius = 0.f;
+		FIntVector Cell = FIntVector::ZeroValue;
+		// position in the cell's list or in LargeElements, INDEX_NONE when the id isn't in the grid
+		int32 IndexInCell = INDEX_NONE;
+		bool bLarge = false;
+	};
+
+	FIntVector ToCell(FVector const& Location) const;
+	void AddToCell(int32 Id);
+	void RemoveFromCell(int32 Id);
+
+	template <typename FTestCell, typename FTestElement>
+	void Query(FBox const& Box, FTestCell const& TestCell, FTestElement const& TestElement, TArray<int32>& OutIds) const;
+
+	float CellSize;
+	float InvCellSize;
+	TArray<FElement> Elements;
+	TMap<FIntVector, TArray<int32>> Cells;
+	TArray<int32> LargeElements;
+	int32 NumElements = 0;
+};
@@ -3,6 +3,7 @@
 #pragma once
 
 #include "CoreMinimal.h"
+#include "HandPoseCache.h"
 #include "InteractablePose.generated.h"
 
 /** A struct that represents a hand pose. */
@@ -22,4 +23,50 @@ struct OCULUSINTERACTABLE_API FInteractablePose
 	/** Relative hand transform. */
 	UPROPERTY(Category = "Interactable Grab Pose", EditAnywhere, BlueprintReadWrite)
 	FString RelativeHandTransform;
+
+	/** Memory allocated by the strings. */
+	SIZE_T GetAllocatedSize() const
+	{
+		return PoseName.GetAllocatedSize() + HandPose.GetAllocatedSize() + RelativeHandTransform.GetAllocatedSize();
+	}
+};
+
+/** A FInteractablePose parsed and decoded once, see AInteractable::CompileGrabPoses. */
+struct OCULUSINTERACTABLE_API FCompiledGrabPose
+{
+	/**
+	 * Index of the FInteractablePose this was compiled from, to report only: the grab pose arrays can be changed from
+	 * Blueprints without compiling them again, so the strings needed after compiling are copied below.
+	 */
+	int32 Index;
+
+	/** Copies of the FInteractablePose strings returned by AInteractable::SelectGrabPose. */
+	FString PoseName;
+	FString HandPose;
+
+	/** The interactable's transform relative to the hand. */
+	FTransform RelativeHandTransform;
+
+	/** The hand's location and rotation relative to the interactable, to compare with the hand grabbing it. */
+	FVector HandLocation;
+	FQuat HandRotation;
+
+	/** The decoded hand pose, invalid if the pose has none. */
+	FHandPoseId HandPoseId;
+
+	/**
+	 * Compiles grab poses, logging those with an invalid transform.
+	 * @param GrabPoses - The grab poses.
+	 * @param OutCompiledPoses - Where to store the valid grab poses, compiled.
+	 * @param Owner - Who holds the grab poses, for logging.
+	 */
+	static void Compile(TArray<FInteractablePose> const& GrabPoses, TArray<FCompiledGrabPose>& OutCompiledPoses, FString const& Owner);
+
+	/**
+	 * Memory used by grab poses.
+	 * @param GrabPoses - The grab poses.
+	 * @param CompiledPoses - Their compiled version.
+	 * @return The size allocated by both arrays, including the strings of both.
+	 */
+	static SIZE_T GetAllocatedSize(TArray<FInteractablePose> const& GrabPoses, TArray<FCompiledGrabPose> const& CompiledPoses);
 };
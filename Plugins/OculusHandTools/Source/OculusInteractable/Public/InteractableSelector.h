@@ -8,8 +8,58 @@
 #include "Particles/ParticleSystemComponent.h"
 #include "Interactable.h"
 #include "AimingActor.h"
+#include "InteractableSubsystem.h"
+#include "SelectionCone.h"
+#include "WorldCollision.h"
 #include "InteractableSelector.generated.h"
 
+class UInteractableSelectorSubsystem;
+
+/** Where a selector aims on a tick. */
+struct FSelectorAim
+{
+	/** The selection ray. */
+	FVector StartCast;
+	FVector EndCast;
+
+	/** Where physics queries are cast, ahead of the selection ray when extrapolating async queries. */
+	FVector QueryStartCast;
+	FVector QueryEndCast;
+};
+
+/**
+ * A selector's search for candidates in the interactable registry, before calling CanSelect on them.
+ * The search itself only reads the registry, so the searches of several selectors can run in parallel.
+ */
+struct FSelectorCandidateSearch
+{
+	/** Near-field query, disabled if NearFieldRadius <= 0. */
+	FVector NearFieldStartCast;
+	float NearFieldRadius;
+
+	/** Far-field query along ForwardVector, and the selection cone. */
+	FVector ForwardVector;
+	FVector FarFieldStartCast;
+	FVector FarFieldEndCast;
+	float FarFieldRadius;
+	FVector Apex;
+	float MinCosAngle;
+	float MaxDistance;
+	float TargetRadiusScale;
+
+	/** The selector's channels, see AInteractableSelector::SelectionChannels. */
+	uint32 SelectionChannels;
+
+	/** Near-field candidates, closest first. */
+	TArray<FRegisteredInteractable> NearFieldCandidates;
+
+	/** Far-field candidates, with the cosine of their angle to the cone's axis, and the order of those within the cone. */
+	TArray<FRegisteredInteractable> FarFieldCandidates;
+	FSelectionConeCandidates ConeCandidates;
+	TArray<float> ConeCosAngles;
+	TArray<int32> FarFieldOrder;
+};
+
 /**
  * Base actor class for interactable selectors.
  */
@@ -18,6 +68,7 @@ UCLASS()
 class OCULUSINTERACTABLE_API AInteractableSelector : public AActor
 {
 	friend class AInteractable;
+	friend class UInteractableSelectorSubsystem;
 
 	GENERATED_BODY()
 
@@ -57,6 +108,14 @@ public:
 	UPROPERTY(Category = "Selector", EditAnywhere, BlueprintReadWrite)
 	float RaycastStickinessAngleDegrees;
 
+	/**
+	 * Fraction of an interactable's radius that the selection cone measures angles to. At 1, any part of the bounds in
+	 * the cone is enough; the default of 0.5 only counts the middle of the interactable, which makes far-field
+	 * selection stricter.
+	 */
+	UPROPERTY(Category = "Selector", EditAnywhere, BlueprintReadWrite, meta = (ClampMin = "0.0", ClampMax = "1.0", UIMin = "0.0", UIMax = "1.0"))
+	float TargetRadiusScale;
+
 	/** Align aiming actor with hit normal. */
 	UPROPERTY(Category = "Selector", EditAnywhere, BlueprintReadWrite)
 	bool bAlignAimingActorWithHitNormal;
@@ -89,9 +148,44 @@ public:
 	UPROPERTY(Category = "Selector", EditAnywhere, BlueprintReadWrite)
 	bool bRaycastDebugTrace;
 
+	/** Find interactables in the world's UInteractableSubsystem instead of sweeping InteractableTraceChannel. */
+	UPROPERTY(Category = "Selector", EditAnywhere, BlueprintReadWrite)
+	bool bUseInteractableRegistry;
+
+	/**
+	 * Run the physics queries of the selector asynchronously: queries are made on one tick and their results used on the
+	 * next, off the game thread in between. Queries of the interactable registry are always synchronous.
+	 */
+	UPROPERTY(Category = "Selector", EditAnywhere, BlueprintReadWrite)
+	bool bUseAsyncSceneQueries;
+
+	/**
+	 * Update this selector together with the other batched selectors of the world, e.g. both hands and gaze, instead of
+	 * in its own tick. The candidate searches of all batched selectors then run as one parallel job.
+	 * Requires bUseInteractableRegistry.
+	 */
+	UPROPERTY(Category = "Selector", EditAnywhere, BlueprintReadWrite)
+	bool bBatchSelection;
+
+	/** Cast async queries along the forward vector extrapolated by one tick, to hide their delay. */
+	UPROPERTY(Category = "Selector", EditAnywhere, BlueprintReadWrite, meta = (EditCondition = "bUseAsyncSceneQueries"))
+	bool bExtrapolateAsyncSceneQueries;
+
+	/** Only select interactables tagged with one of these channels, see AInteractable::SelectionChannels. */
+	UPROPERTY(Category = "Selector", EditAnywhere, BlueprintReadWrite, meta = (Bitmask, BitmaskEnum = "/Script/OculusInteractable.EInteractableSelectionChannel"))
+	int32 SelectionChannels;
+
 	UFUNCTION(Category = "Selector", BlueprintNativeEvent)
 	bool ShouldSelect(AInteractable* Interactable) const;
 
+	/**
+	 * Whether we can select an interactable: it is selectable, shares one of our channels, and ShouldSelect returns
+	 * true. ShouldSelect is only called through the blueprint VM when it is overridden in blueprint.
+	 * @param Interactable - The interactable.
+	 * @return boolean
+	 */
+	bool CanSelect(AInteractable* Interactable) const;
+
 	/**
 	 * Call to activate / deactivate the selector.
 	 * @param Activate - A boolean.
@@ -130,12 +224,105 @@ protected:
 	/** Dampened forward vector. */
 	FVector DampenedForwardVector;
 
+	/** Dampened forward vector before the last update, to extrapolate it. */
+	FVector PreviousDampenedForwardVector;
+
 	/**
 	 * Updates DampenedForwardVector.
 	 * @param Dampening - Fraction of the current vector to keep.
 	 */
 	void UpdateDampenedForwardVector(float Dampening);
 
+	/**
+	 * Computes what UpdateDampenedForwardVector would set DampenedForwardVector to.
+	 * @param Dampening - Fraction of the current vector to keep.
+	 * @return The dampened forward vector.
+	 */
+	FVector ComputeDampenedForwardVector(float Dampening) const;
+
+	/** Whether the UInteractableSelectorSubsystem updates this selector rather than its own tick. */
+	bool IsSelectionBatched() const;
+
+	/** Whether we registered with the UInteractableSelectorSubsystem. */
+	bool bRegisteredForBatching;
+
+	/** Whether ShouldSelect is overridden in blueprint, cached on BeginPlay. */
+	bool bShouldSelectImplementedInScript;
+
+	/**
+	 * Selects the best candidate, in the near-field or in the far-field.
+	 * @param DeltaTime - Time since the last update.
+	 */
+	void UpdateSelection(float DeltaTime);
+
+	/**
+	 * Sets up a search for candidates in the interactable registry. Called on the game thread.
+	 * @param Search - The search to set up.
+	 */
+	void BeginCandidateSearch(FSelectorCandidateSearch& Search) const;
+
+	/**
+	 * Finds the candidates of a search in the interactable registry.
+	 * Can run concurrently with other searches, after UInteractableSubsystem::FlushMovedInteractables.
+	 * @param Search - The search, set up by BeginCandidateSearch.
+	 * @param Registry - The interactable registry.
+	 */
+	static void RunCandidateSearch(FSelectorCandidateSearch& Search, UInteractableSubsystem const& Registry);
+
+	/**
+	 * Selects the best candidate found by a search that we should select. Called on the game thread.
+	 * @param Search - The search, after RunCandidateSearch.
+	 * @param DeltaTime - Time since the last update.
+	 */
+	void FinishCandidateSearch(FSelectorCandidateSearch const& Search, float DeltaTime);
+
+	/** Reused by UpdateSelection. */
+	FSelectorCandidateSearch CandidateSearch;
+
+	/**
+	 * Whether the current selection sticks rather than switching to a far-field candidate.
+	 * @param CosAngleToCurrentSelection - Cosine of the angle to the current selection.
+	 * @param CosAngleToCandidate - Cosine of the angle to the candidate.
+	 */
+	bool ShouldKeepSelection(float CosAngleToCurrentSelection, float CosAngleToCandidate) const;
+
+	/**
+	 * Keeps the current selection for this tick.
+	 * @param World - Our world.
+	 * @param Aim - Where we aim on this tick.
+	 */
+	void KeepSelection(UWorld* World, FSelectorAim const& Aim);
+
+	/**
+	 * Updates the aiming actor and the pre-selection with the candidate found on this tick.
+	 * @param World - Our world.
+	 * @param Candidate - The candidate, or nullptr.
+	 * @param CandidateInNearField - Whether the candidate is in the near-field.
+	 * @param Aim - Where we aim on this tick.
+	 * @param DeltaTime - Time since the last update.
+	 */
+	void ApplyCandidate(UWorld* World, AInteractable* Candidate, bool CandidateInNearField, FSelectorAim const& Aim, float DeltaTime);
+
+	/**
+	 * Places the aiming actor where the selection ray hits.
+	 * @param World - Our world.
+	 * @param Aim - Where we aim on this tick.
+	 */
+	void UpdateAimingActorTransform(UWorld* World, FSelectorAim const& Aim);
+
+	/**
+	 * Computes where we aim in the near-field.
+	 * @param Aim - Where to store the aim.
+	 */
+	void ComputeNearFieldAim(FSelectorAim& Aim) const;
+
+	/**
+	 * Computes where we aim in the far-field, along DampenedForwardVector.
+	 * @param World - Our world, for debug drawing.
+	 * @param Aim - Where to store the aim.
+	 */
+	void ComputeFarFieldAim(UWorld* World, FSelectorAim& Aim) const;
+
 	/**
 	 * Computes the current start and end locations for the near-field selector.
 	 * @param Start - Where to store the start location.
@@ -150,6 +337,34 @@ protected:
 	 */
 	void ComputeFarFieldRaycastEndpoints(FVector& Start, FVector& End) const;
 
+	/**
+	 * Computes the start and end locations for the far-field selector along a forward vector.
+	 * @param Forward - The direction to cast in.
+	 * @param Start - Where to store the start location.
+	 * @param End - Where to store the end location.
+	 */
+	void ComputeFarFieldRaycastEndpoints(FVector const& Forward, FVector& Start, FVector& End) const;
+
+	/**
+	 * Traces a line, or sweeps a shape, for all hits. When bUseAsyncSceneQueries is set, the query is made
+	 * asynchronously and the hits are those of the query made with the same handle on the previous tick, or of a
+	 * synchronous query if there was none.
+	 * @param World - The world to query.
+	 * @param AsyncHandle - The handle of the async query made on the previous tick, replaced by the new query.
+	 * @param Start - Start of the query.
+	 * @param End - End of the query.
+	 * @param TraceChannel - Channel to query.
+	 * @param CollisionShape - The shape to sweep, or a line.
+	 * @param OutHits - Where to store the hits.
+	 */
+	void QueryMultiByChannel(UWorld* World, FTraceHandle& AsyncHandle, FVector const& Start, FVector const& End,
+		ECollisionChannel TraceChannel, FCollisionShape const& CollisionShape, TArray<FHitResult>& OutHits);
+
+	/** Handles of the async queries made on the last tick. */
+	FTraceHandle NearFieldTraceHandle;
+	FTraceHandle FarFieldTraceHandle;
+	FTraceHandle AimingTraceHandle;
+
 	/**
 	 * Computes the radius of the sphere required to hit at RaycastDistance and RaycastAngle.
 	 * @return Radius of sphere.
@@ -157,10 +372,10 @@ protected:
 	float ComputeSphereRadiusForCast() const;
 
 	/**
-	 * Computes our approximative angular distance to an Actor.
-	 * It is approximative because we take the actor's bounding volume into consideration.
+	 * Computes the angular distance between our forward vector and the closest point of an Actor's bounding sphere,
+	 * with the actor's simple collision radius as the radius of the sphere.
 	 * @param Target - The actor.
-	 * @return An approximative angular distance in degrees.
+	 * @return An angular distance in degrees.
 	 */
 	float ComputeAngularDistance(AActor* Target) const;
 
@@ -220,6 +435,11 @@ protected:
 	UPROPERTY() UParticleSystemComponent* Beam;
 
 private:
+	/** Far-field candidates tested against the selection cone, reused from one tick to the next. */
+	FSelectionConeCandidates ConeCandidates;
+	TArray<AInteractable*> ConeInteractables;
+	TArray<float> ConeCosAngles;
+
 	static ECollisionChannel InteractableTraceChannel;
 	static FName BeamSource;
 	static FName BeamTarget;
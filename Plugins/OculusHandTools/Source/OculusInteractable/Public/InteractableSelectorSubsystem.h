@@ -0,0 +1,36 @@
+// Copyright (c) Meta Platforms, Inc. and affiliates.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "InteractableSelector.h"
+#include "InteractableSelectorSubsystem.generated.h"
+
+/**
+ * Updates the world's batched interactable selectors (see AInteractableSelector::bBatchSelection) together once per
+ * frame. The candidate searches of all the selectors run as one parallel job against the interactable registry, then
+ * the selections are applied on the game thread, in the order the selectors began play.
+ */
+UCLASS()
+class OCULUSINTERACTABLE_API UInteractableSelectorSubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	/** Called by AInteractableSelector::BeginPlay. */
+	void RegisterSelector(AInteractableSelector* Selector);
+
+	/** Called by AInteractableSelector::EndPlay. */
+	void UnregisterSelector(AInteractableSelector* Selector);
+
+	virtual void Tick(float DeltaTime) override;
+	virtual TStatId GetStatId() const override;
+
+private:
+	TArray<TWeakObjectPtr<AInteractableSelector>> Selectors;
+
+	/** The selectors updated on this frame, and their searches, reused from one frame to the next. */
+	TArray<AInteractableSelector*> BatchedSelectors;
+	TArray<FSelectorCandidateSearch> Searches;
+};
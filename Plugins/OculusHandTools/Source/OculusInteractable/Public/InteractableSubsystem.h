@@ -0,0 +1,174 @@
+// Copyright (c) Meta Platforms, Inc. and affiliates.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "Interactable.h"
+#include "InteractableGrid.h"
+#include "InteractableSubsystem.generated.h"
+
+/** An interactable returned by the registry queries, with its cached bounds and flags. */
+struct FRegisteredInteractable
+{
+	AInteractable* Interactable;
+	/** Location of the interactable's root component. */
+	FVector Location;
+	/** Bounding sphere. */
+	FVector Center;
+	float Radius;
+	/** AInteractable::GetSelectionFlags, when the interactable was registered or last invalidated its flags. */
+	uint32 SelectionFlags;
+
+	/** The selection flags, read from the interactable if they are dynamic. Call on the game thread. */
+	uint32 GetSelectionFlags() const
+	{
+		return SelectionFlags & EInteractableSelectionFlags::Dynamic ? Interactable->GetSelectionFlags() : SelectionFlags;
+	}
+};
+
+/**
+ * Spatial registry of every AInteractable in the world. Interactables register themselves on BeginPlay. Their bounding
+ * spheres are cached and kept in a hashed grid that is updated when their root component moves, so selectors and
+ * grabbing components can find nearby interactables without physics scene queries. The bounding spheres are loose:
+ * queries return candidates, which OverlapInteractable and SweepInteractable then test exactly.
+ */
+UCLASS(Config = Game)
+class OCULUSINTERACTABLE_API UInteractableSubsystem : public UWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	/** Size of the grid cells (cm). Interactables with a bounding radius over half a cell are tested by every query. */
+	UPROPERTY(Config)
+	float CellSize = 100.f;
+
+	/**
+	 * The channels queried for interactables: those of AInteractableSelector and UHandGrabbingComponent. Only the
+	 * components responding to one of them count in the bounding spheres.
+	 */
+	UPROPERTY(Config)
+	TArray<TEnumAsByte<ECollisionChannel>> QueryChannels = {ECC_GameTraceChannel1, ECC_WorldDynamic};
+
+	virtual void Initialize(FSubsystemCollectionBase& Collection) override;
+	virtual void Deinitialize() override;
+
+	/** Adds an interactable to the registry, called by AInteractable::BeginPlay. */
+	void RegisterInteractable(AInteractable* Interactable);
+
+	/** Removes an interactable from the registry, called by AInteractable::EndPlay. */
+	void UnregisterInteractable(AInteractable* Interactable);
+
+	/**
+	 * Recomputes the cached bounds and flags of an interactable.
+	 * Call after adding or removing its components, or changing its root component.
+	 * @param Interactable - A registered interactable.
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Interactable")
+	void RefreshInteractable(AInteractable* Interactable);
+
+	/** Copies the selection flags of an interactable, called by AInteractable::InvalidateSelectionFlags. */
+	void UpdateSelectionFlags(AInteractable* Interactable);
+
+	/**
+	 * Finds the interactables whose bounding sphere overlaps a sphere.
+	 * @param Center - Center of the sphere.
+	 * @param Radius - Radius of the sphere.
+	 * @param OutInteractables - Where to append the interactables found.
+	 */
+	void QuerySphere(FVector const& Center, float Radius, TArray<FRegisteredInteractable>& OutInteractables);
+
+	/**
+	 * Finds the interactables whose bounding sphere overlaps a sphere swept from Start to End.
+	 * @param Start - Start of the sweep.
+	 * @param End - End of the sweep.
+	 * @param Radius - Radius of the swept sphere.
+	 * @param OutInteractables - Where to append the interactables found.
+	 */
+	void QueryCapsule(FVector const& Start, FVector const& End, float Radius, TArray<FRegisteredInteractable>& OutInteractables);
+
+	/** Applies the moves of interactables to the registry, which the queries above do first. */
+	void FlushMovedInteractables();
+
+	/**
+	 * Same as QuerySphere, without applying moves first.
+	 * Several of these can run concurrently, e.g. from a parallel job, after FlushMovedInteractables.
+	 */
+	void FindInSphere(FVector const& Center, float Radius, TArray<FRegisteredInteractable>& OutInteractables) const;
+
+	/**
+	 * Same as QueryCapsule, without applying moves first.
+	 * Several of these can run concurrently, e.g. from a parallel job, after FlushMovedInteractables.
+	 */
+	void FindInCapsule(FVector const& Start, FVector const& End, float Radius, TArray<FRegisteredInteractable>& OutInteractables) const;
+
+	/**
+	 * Finds the interactables whose bounding sphere overlaps a sphere.
+	 * @param Center - Center of the sphere.
+	 * @param Radius - Radius of the sphere.
+	 * @return The interactables found.
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Interactable")
+	TArray<AInteractable*> GetInteractablesInSphere(FVector Center, float Radius);
+
+	/**
+	 * Gets the cached bounding sphere of an interactable.
+	 * @param Interactable - The interactable.
+	 * @param OutCenter - Where to store the center of the sphere.
+	 * @param OutRadius - Where to store the radius of the sphere.
+	 * @return Whether the interactable is registered.
+	 */
+	bool GetBounds(AInteractable const* Interactable, FVector& OutCenter, float& OutRadius);
+
+	/**
+	 * Tests the components of an interactable responding to a channel against a shape, as an overlap query of the
+	 * channel would.
+	 * @param Interactable - The interactable.
+	 * @param Channel - The channel of the query.
+	 * @param Location - Location of the shape.
+	 * @param Rotation - Rotation of the shape.
+	 * @param Shape - The shape.
+	 * @return Whether one of the components overlaps the shape.
+	 */
+	static bool OverlapInteractable(AInteractable const* Interactable, ECollisionChannel Channel, FVector const& Location,
+		FQuat const& Rotation, FCollisionShape const& Shape);
+
+	/**
+	 * Sweeps a shape against the components of an interactable responding to a channel, as a sweep query of the
+	 * channel would.
+	 * @param Interactable - The interactable.
+	 * @param Channel - The channel of the query.
+	 * @param Start - Start of the sweep.
+	 * @param End - End of the sweep.
+	 * @param Shape - The shape, not rotated.
+	 * @return Whether one of the components is hit.
+	 */
+	static bool SweepInteractable(AInteractable* Interactable, ECollisionChannel Channel, FVector const& Start,
+		FVector const& End, FCollisionShape const& Shape);
+
+	/** Number of registered interactables. */
+	int32 Num() const { return Registrations.Num(); }
+
+private:
+	struct FRegistration
+	{
+		TWeakObjectPtr<AInteractable> Interactable;
+		TWeakObjectPtr<USceneComponent> Root;
+		FDelegateHandle TransformUpdatedHandle;
+		// bounding sphere relative to the root component, unscaled
+		FVector LocalCenter = FVector::ZeroVector;
+		float LocalRadius = 0.f;
+		FVector Location = FVector::ZeroVector;
+		uint32 SelectionFlags = 0;
+		bool bDirty = false;
+	};
+
+	void CacheBoundsAndFlags(FRegistration& Registration) const;
+	void HandleTransformUpdated(USceneComponent* Component, EUpdateTransformFlags Flags, ETeleportType Teleport, int32 Id);
+	void UpdateGrid(int32 Id);
+	void ResolveQuery(TArray<int32> const& Ids, TArray<FRegisteredInteractable>& OutInteractables) const;
+
+	TSparseArray<FRegistration> Registrations;
+	TArray<int32> MovedIds;
+	FInteractableGrid Grid;
+};
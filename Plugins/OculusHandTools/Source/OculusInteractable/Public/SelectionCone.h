@@ -0,0 +1,71 @@
+// Copyright (c) Meta Platforms, Inc. and affiliates.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+/** Bounding spheres of selection candidates, packed relative to a cone's apex so they can be tested four at a time. */
+class OCULUSINTERACTABLE_API FSelectionConeCandidates
+{
+public:
+	/// Removes every candidate and sets the apex of the cone they will be tested against.
+	void Reset(FVector const& InApex);
+
+	/// Adds a candidate bounding sphere. Distance orders candidates at the same angle.
+	void Add(FVector const& Center, float Radius, float Distance);
+
+	int32 Num() const { return NumCandidates; }
+	FVector const& GetApex() const { return Apex; }
+	float GetDistance(int32 Index) const { return Distances[Index]; }
+
+private:
+	friend struct FSelectionCone;
+
+	FVector Apex = FVector::ZeroVector;
+	// offsets from the apex, all arrays padded to a multiple of 4
+	TArray<float> X;
+	TArray<float> Y;
+	TArray<float> Z;
+	TArray<float> Radii;
+	TArray<float> Distances;
+	int32 NumCandidates = 0;
+};
+
+/**
+ * Selection cone measuring the angle from its axis to the closest point of bounding spheres. Angles are kept as
+ * cosines, so finding the best candidate only takes products and square roots.
+ */
+struct OCULUSINTERACTABLE_API FSelectionCone
+{
+	FSelectionCone(FVector const& InApex, FVector const& InAxis);
+
+	/// Cosine of the angle between the axis and the closest point of a sphere, 1 when the axis goes through the sphere.
+	float GetCosAngleTo(FVector const& Center, float Radius) const;
+
+	/**
+	 * @brief Finds the candidate at the smallest angle, or at the smallest distance between candidates at the same angle.
+	 * @param Candidates Bounding spheres packed relative to this cone's apex.
+	 * @param MinCosAngle Cosine of the largest angle a candidate can be at.
+	 * @param MaxDistance Candidates at exactly MinCosAngle must be closer than this.
+	 * @param OutCosAngles Receives GetCosAngleTo of every candidate.
+	 * @return Index of the best candidate, INDEX_NONE if no candidate is within the angle.
+	 */
+	int32 FindBest(FSelectionConeCandidates const& Candidates, float MinCosAngle, float MaxDistance, TArray<float>& OutCosAngles) const;
+
+	/**
+	 * @brief Orders the candidates within the angle from the best to the worst, the first being the one FindBest finds.
+	 * @param Candidates Bounding spheres packed relative to this cone's apex.
+	 * @param MinCosAngle Cosine of the largest angle a candidate can be at.
+	 * @param MaxDistance Candidates at exactly MinCosAngle must be closer than this.
+	 * @param OutCosAngles Receives GetCosAngleTo of every candidate.
+	 * @param OutOrder Receives the indices of the candidates within the angle, best first.
+	 */
+	void Rank(FSelectionConeCandidates const& Candidates, float MinCosAngle, float MaxDistance, TArray<float>& OutCosAngles,
+		TArray<int32>& OutOrder) const;
+
+	FVector Apex;
+	FVector Axis;
+
+private:
+	void ComputeCosAngles(FSelectionConeCandidates const& Candidates, TArray<float>& OutCosAngles) const;
+};
@@ -0,0 +1,42 @@
+// Copyright (c) Meta Platforms, Inc. and affiliates.
+
+#include "Misc/AutomationTest.h"
+#include "ThrowSolver.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FThrowSolverTrackedMatchesSolveTest, "OculusHandTools.ThrowAssist.ThrowSolver.TrackedMatchesSolve",
+	EAutomationTestFlags_ApplicationContextMask | EAutomationTestFlags::EngineFilter)
+
+bool FThrowSolverTrackedMatchesSolveTest::RunTest(FString const& Parameters)
+{
+	FThrowSolver Solver;
+	Solver.Reset(7, 2);
+
+	auto const LookDirection = FVector(1, 0.2, 0).GetSafeNormal();
+	auto const GripOffset = FVector(10, 0, 0);
+
+	// a hand winding up and swinging forward while turning, with tracking lost for a while in the middle
+	auto bMatches = true;
+	for (auto i = 0; i < 120; ++i)
+	{
+		auto const Time = 1.0 + i / 72.0;
+		auto const Swing = FMath::Sin(Time * 4);
+		auto const Transform = FTransform(FRotator(0, Swing * 40, 0), FVector(Swing * 60, Time * 10, FMath::Cos(Time * 3) * 20));
+		auto const bTracked = i < 50 || i > 65;
+
+		Solver.AddSample(Time, Transform, bTracked);
+		Solver.UpdateTrackingState(Time, bTracked);
+
+		// the held point moves with the hand, so the candidates are only evaluated again when tracking changes
+		auto const Tracked = Solver.GetTrackedThrowVelocity(LookDirection, Transform.TransformPosition(GripOffset), 2.f, 0.5f);
+		auto const Released = Solver.Solve(LookDirection, &GripOffset, -1);
+		bMatches &= Tracked.LinearVelocity.Equals(Released.LinearVelocity, 1e-3) &&
+			Tracked.AngularVelocity.Equals(Released.AngularVelocity, 1e-3);
+	}
+	TestTrue(TEXT("Tracked throw matches the release"), bMatches);
+
+	return true;
+}
+
+#endif
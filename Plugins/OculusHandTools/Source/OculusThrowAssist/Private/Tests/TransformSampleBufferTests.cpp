@@ -0,0 +1,60 @@
+// Copyright (c) Meta Platforms, Inc. and affiliates.
+
+#include "Misc/AutomationTest.h"
+#include "TransformSampleBuffer.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+namespace
+{
+	FVector TrajectoryAt(double Time)
+	{
+		return FVector(100 * Time, 20 * Time * Time, -5 * Time);
+	}
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FTransformSampleBufferGrowWrappedTest, "OculusHandTools.ThrowAssist.TransformSampleBuffer.GrowWrapped",
+	EAutomationTestFlags_ApplicationContextMask | EAutomationTestFlags::EngineFilter)
+
+bool FTransformSampleBufferGrowWrappedTest::RunTest(FString const& Parameters)
+{
+	FTransformSampleBuffer Buffer;
+	Buffer.MaxBufferTimeSeconds = 1.f;
+
+	auto Time = 0.0;
+	auto const AddSamples = [&Buffer, &Time](double Rate, int32 Count)
+	{
+		for (auto i = 0; i < Count; ++i)
+		{
+			Time += 1.0 / Rate;
+			Buffer.AddSample(Time, FTransform(TrajectoryAt(Time)), true);
+		}
+	};
+
+	// at 60 Hz the initial 72 slots hold more than a second, so the ring wraps instead of growing
+	AddSamples(60, 150);
+	TestEqual(TEXT("Samples buffered at 60 Hz"), Buffer.Num(), 72);
+
+	// at 100 Hz the wrapped ring grows to 144 slots, which hold more than a second and wrap again
+	AddSamples(100, 300);
+	TestEqual(TEXT("Samples buffered at 100 Hz"), Buffer.Num(), 144);
+
+	// at 200 Hz the wrapped ring grows to 288 slots
+	AddSamples(200, 400);
+	TestEqual(TEXT("Samples buffered at 200 Hz"), Buffer.Num(), 288);
+
+	// every sample kept its own transform, oldest first
+	auto PreviousTime = -1.0;
+	auto bIntact = true;
+	for (auto const Sample : Buffer.Iterate(ETransformSampleView::All))
+	{
+		bIntact &= Sample.Time > PreviousTime && Sample.Transform.GetLocation().Equals(TrajectoryAt(Sample.Time), 1e-3);
+		PreviousTime = Sample.Time;
+	}
+	TestTrue(TEXT("Samples are ordered and intact"), bIntact);
+	TestEqual(TEXT("Newest sample"), PreviousTime, Time);
+
+	return true;
+}
+
+#endif
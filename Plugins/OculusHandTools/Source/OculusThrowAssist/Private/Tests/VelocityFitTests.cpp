@@ -0,0 +1,92 @@
+// Copyright (c) Meta Platforms, Inc. and affiliates.
+
+#include "Misc/AutomationTest.h"
+#include "VelocityFit.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+namespace
+{
+	// a polynomial of each axis, lowest degree first
+	struct FPolynomialTrajectory
+	{
+		FVector Coefficients[4];
+
+		FVector LocationAt(double Time) const
+		{
+			return Coefficients[0] + Time * (Coefficients[1] + Time * (Coefficients[2] + Time * Coefficients[3]));
+		}
+
+		FVector VelocityAt(double Time) const
+		{
+			return Coefficients[1] + Time * (2 * Coefficients[2] + Time * 3 * Coefficients[3]);
+		}
+
+		FVector AccelerationAt(double Time) const
+		{
+			return 2 * Coefficients[2] + Time * 6 * Coefficients[3];
+		}
+	};
+
+	/**
+	 * Fits every prefix of a trajectory sampled at 72 Hz, with every other period stretched by Jitter and the others
+	 * shrunk by it, and checks the estimates at the newest sample against the analytic derivatives. A fit of at least
+	 * the degree of the trajectory is exact.
+	 */
+	void TestExactFit(FAutomationTestBase& Test, FString const& What, FPolynomialTrajectory const& Trajectory, int32 Order,
+		double Jitter)
+	{
+		FPolynomialVelocityFit Fit;
+		Fit.Configure(7, Order);
+
+		TArray<double> Times;
+		TArray<FVector> Locations;
+		auto Time = 1.0;
+		auto MaxVelocityError = 0.0;
+		auto MaxAccelerationError = 0.0;
+		for (auto i = 0; i < 30; ++i)
+		{
+			Time += (1 + (i % 2 == 0 ? Jitter : -Jitter)) / 72.0;
+			Times.Add(Time);
+			Locations.Add(Trajectory.LocationAt(Time));
+
+			FVector Velocity, Acceleration;
+			auto const bEstimated = Fit.Estimate(Times, Locations, Velocity, Acceleration);
+			if (i < Order)
+			{
+				// too few samples for the order, a lower order fit is only exact for a lower degree trajectory
+				continue;
+			}
+			Test.TestTrue(FString::Printf(TEXT("%s estimates with %d samples"), *What, i + 1), bEstimated);
+			MaxVelocityError = FMath::Max(MaxVelocityError, FVector::Dist(Velocity, Trajectory.VelocityAt(Time)));
+			MaxAccelerationError = FMath::Max(MaxAccelerationError, FVector::Dist(Acceleration, Trajectory.AccelerationAt(Time)));
+		}
+		Test.TestTrue(FString::Printf(TEXT("%s velocity error %g"), *What, MaxVelocityError), MaxVelocityError < 1e-4);
+		Test.TestTrue(FString::Printf(TEXT("%s acceleration error %g"), *What, MaxAccelerationError), MaxAccelerationError < 1e-2);
+	}
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FPolynomialVelocityFitExactTest, "OculusHandTools.ThrowAssist.VelocityFit.Exact",
+	EAutomationTestFlags_ApplicationContextMask | EAutomationTestFlags::EngineFilter)
+
+bool FPolynomialVelocityFitExactTest::RunTest(FString const& Parameters)
+{
+	FPolynomialTrajectory Quadratic;
+	Quadratic.Coefficients[0] = FVector(10, -20, 30);
+	Quadratic.Coefficients[1] = FVector(250, 40, -90);
+	Quadratic.Coefficients[2] = FVector(-300, 120, 45);
+	Quadratic.Coefficients[3] = FVector::ZeroVector;
+
+	FPolynomialTrajectory Cubic = Quadratic;
+	Cubic.Coefficients[3] = FVector(15, -8, 4);
+
+	// jitter below a tenth of a period uses the precomputed uniform weights, stronger jitter is fitted directly
+	TestExactFit(*this, TEXT("Quadratic, uniform"), Quadratic, 2, 0);
+	TestExactFit(*this, TEXT("Quadratic, jittered"), Quadratic, 2, 0.4);
+	TestExactFit(*this, TEXT("Cubic, uniform"), Cubic, 3, 0);
+	TestExactFit(*this, TEXT("Cubic, jittered"), Cubic, 3, 0.4);
+
+	return true;
+}
+
+#endif
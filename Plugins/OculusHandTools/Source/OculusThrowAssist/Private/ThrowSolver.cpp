@@ -0,0 +1,376 @@
+// Copyright (c) Meta Platforms, Inc. and affiliates.
+
+#include "ThrowSolver.h"
+
+#include "DrawDebugHelpers.h"
+
+static TAutoConsoleVariable<int> CVarDebugDrawThrowingVector(
+	TEXT("throw.DebugDrawThrowingVector"),
+	0,
+	TEXT("Shows throwing vector for camera-tracked hands. 1- draw when throwing. 2- draw always"),
+	ECVF_Cheat);
+
+void FThrowSolver::Reset(int32 VelocityFitWindow, int32 VelocityFitOrder)
+{
+	TransformSamples.Reset();
+	TransformSamples.MaxBufferTimeSeconds = 1.f;
+	TransformSamples.ConfigureVelocityFit(VelocityFitWindow, VelocityFitOrder);
+	TrackedSamples.Reset();
+	TrackedCandidates.Reset();
+	LastCandidateTime = TNumericLimits<double>::Lowest();
+	bHasTrackedAim = false;
+
+	bWasTracked = false;
+	MostRecentTrackingLossTime = 0;
+	MostRecentTrackingLossTransform = FTransform::Identity;
+	MostRecentTrackingLossVelocity = FVector::ZeroVector;
+	MostRecentTrackingGainTime = 0;
+	MostRecentTrackingGainTransform = FTransform::Identity;
+	MostRecentTrackingGainVelocity = FVector::ZeroVector;
+	++InputSequence;
+}
+
+void FThrowSolver::SetSettings(FThrowSolverSettings const& InSettings)
+{
+	if (InSettings == Settings)
+	{
+		return;
+	}
+
+	Settings = InSettings;
+	++InputSequence;
+
+	// candidates were aged, scored and classified with the old settings
+	bHasTrackedAim = false;
+}
+
+bool FThrowSolver::AddSample(double Time, FTransform const& Transform, bool bTracked)
+{
+	if (!TransformSamples.AddSample(Time, Transform, bTracked))
+	{
+		return false;
+	}
+
+	++InputSequence;
+	TrackSample(Time);
+	return true;
+}
+
+void FThrowSolver::UpdateTrackingState(double Time, bool bTracked)
+{
+	if (bTracked == bWasTracked)
+	{
+		return;
+	}
+
+	FTransformBufferData TransformBufferDataNow;
+	TransformSamples.GetNewest(ETransformSampleView::All, TransformBufferDataNow);
+	if (bTracked)
+	{
+		MostRecentTrackingGainTime = Time;
+		MostRecentTrackingGainTransform = TransformBufferDataNow.Transform;
+		MostRecentTrackingGainVelocity = TransformBufferDataNow.Velocity;
+	}
+	else
+	{
+		MostRecentTrackingLossTime = Time;
+		MostRecentTrackingLossTransform = TransformBufferDataNow.Transform;
+		MostRecentTrackingLossVelocity = TransformBufferDataNow.Velocity;
+	}
+
+	bWasTracked = bTracked;
+	++InputSequence;
+
+	// very low confidence candidates are aimed from the tracking loss
+	bHasTrackedAim = false;
+}
+
+void FThrowSolver::TrackSample(double Time)
+{
+	// the confidence is settled once, when the sample arrives, so that the candidate doesn't depend on the time after
+	FTrackedThrowSample Sample;
+	Sample.Time = Time;
+	Sample.bHighConfidence = GetTimeWithGoodTracking(Time) >= Settings.HighConfidenceThrowMinTrackingTime;
+	TransformSamples.GetNewest(Sample.bHighConfidence ? ETransformSampleView::HighConfidence : ETransformSampleView::All, Sample.BufferData);
+
+	auto const CandidateSpacing = Settings.OldestPossibleThrowVectorSeconds / FMath::Max(Settings.NumThrowVectorSamples, 1);
+	Sample.bCandidate = Time - LastCandidateTime >= CandidateSpacing;
+	if (Sample.bCandidate)
+	{
+		LastCandidateTime = Time;
+	}
+
+	while (!TrackedSamples.IsEmpty() && Sample.Time - TrackedSamples.First().Time > Settings.OldestPossibleThrowVectorSeconds)
+	{
+		TrackedSamples.PopFirst();
+	}
+	while (!TrackedCandidates.IsEmpty() && Sample.Time - TrackedCandidates.First().Time > Settings.OldestPossibleThrowVectorSeconds)
+	{
+		TrackedCandidates.PopFirst();
+	}
+
+	TrackedSamples.PushLast(Sample);
+	if (bHasTrackedAim)
+	{
+		AddTrackedCandidate(Sample);
+	}
+}
+
+FThrowSolver::FTrackedThrowCandidate FThrowSolver::EvaluateCandidate(FTrackedThrowSample const& Sample, FVector LookDirection,
+	FVector const* GripOffset) const
+{
+	auto const ThrowVelocity = ToThrowVelocity(Sample.BufferData, LookDirection, Sample.bHighConfidence, GripOffset);
+
+	// the recency score drops at the same rate for every candidate, so it is scored from the sample time and the
+	// candidates compare the same whichever time they are aged from
+	auto const RecencyScore = Settings.ThrowVectorSelectionRecencyScoring * Sample.Time /
+		FMath::Max(Settings.OldestPossibleThrowVectorSeconds, UE_KINDA_SMALL_NUMBER);
+	return FTrackedThrowCandidate{Sample.Time, RecencyScore + GetAimScore(ThrowVelocity.LinearVelocity, LookDirection), ThrowVelocity};
+}
+
+void FThrowSolver::AddTrackedCandidate(FTrackedThrowSample const& Sample)
+{
+	TrackedNewest = EvaluateCandidate(Sample, TrackedLookDirection, &TrackedGripOffset);
+	if (!Sample.bCandidate)
+	{
+		return;
+	}
+
+	// a candidate scoring no more than a newer one can't be the best again before it expires, so the best candidate is
+	// always the first
+	while (!TrackedCandidates.IsEmpty() && TrackedCandidates.Last().Score <= TrackedNewest.Score)
+	{
+		TrackedCandidates.PopLast();
+	}
+	TrackedCandidates.PushLast(TrackedNewest);
+}
+
+void FThrowSolver::RebuildTrackedCandidates()
+{
+	TrackedCandidates.Reset();
+	for (auto i = 0; i < TrackedSamples.Num(); ++i)
+	{
+		AddTrackedCandidate(TrackedSamples[i]);
+	}
+}
+
+int32 FThrowSolver::FindReleaseSample(double ReleaseTime) const
+{
+	// the newest sample, or the newest one buffered by the release, or the oldest
+	auto i = TrackedSamples.Num() - 1;
+	while (ReleaseTime >= 0 && i > 0 && TrackedSamples[i].Time > ReleaseTime)
+	{
+		--i;
+	}
+	return i;
+}
+
+int32 FThrowSolver::FindLookBackSample(int32 Newest) const
+{
+	// the newest sample at least ThrowLatencyAdjustmentTimeSeconds older than the given one, or the oldest
+	auto i = Newest;
+	while (i > 0 && TrackedSamples[Newest].Time - TrackedSamples[i].Time < Settings.ThrowLatencyAdjustmentTimeSeconds)
+	{
+		--i;
+	}
+	return i;
+}
+
+FThrowVelocity FThrowSolver::GetTrackedThrowVelocity(FVector LookDirection, FVector GripLocation,
+	float LookDirectionTolerance, float GripTolerance)
+{
+	auto const GripOffset = ToGripOffset(GripLocation);
+
+	auto const CosTolerance = FMath::Cos(FMath::DegreesToRadians(LookDirectionTolerance));
+	if (!bHasTrackedAim ||
+		FVector::DotProduct(LookDirection, TrackedLookDirection) < CosTolerance * LookDirection.Size() * TrackedLookDirection.Size() ||
+		FVector::DistSquared(GripOffset, TrackedGripOffset) > FMath::Square(GripTolerance))
+	{
+		TrackedLookDirection = LookDirection;
+		TrackedGripOffset = GripOffset;
+		bHasTrackedAim = true;
+		RebuildTrackedCandidates();
+	}
+
+	if (TrackedSamples.IsEmpty())
+	{
+		return FThrowVelocity();
+	}
+
+	if (!Settings.bSelectBestThrowVectorFromPast)
+	{
+		auto const& Sample = TrackedSamples[FindLookBackSample(TrackedSamples.Num() - 1)];
+		return ToThrowVelocity(Sample.BufferData, TrackedLookDirection, Sample.bHighConfidence, &TrackedGripOffset);
+	}
+
+	// ties go to the newer candidate, as in Solve
+	if (TrackedCandidates.IsEmpty() || TrackedNewest.Score >= TrackedCandidates.First().Score)
+	{
+		return TrackedNewest.ThrowVelocity;
+	}
+	return TrackedCandidates.First().ThrowVelocity;
+}
+
+FVector FThrowSolver::ToGripOffset(FVector GripLocation) const
+{
+	FTransformBufferData Newest;
+	TransformSamples.GetNewest(ETransformSampleView::All, Newest);
+	return Newest.Transform.InverseTransformPosition(GripLocation);
+}
+
+FThrowVelocity FThrowSolver::Solve(FVector LookDirection, FVector const* GripOffset, double ReleaseTime) const
+{
+	if (TrackedSamples.IsEmpty())
+	{
+		return FThrowVelocity();
+	}
+
+	if (Settings.bSelectBestThrowVectorFromPast)
+	{
+		TArray<FThrowVectorCandidate> Candidates;
+		auto const Best = GetThrowVectorCandidates(LookDirection, GripOffset, ReleaseTime, Candidates);
+		return FThrowVelocity(Candidates[Best].ThrowVector, Candidates[Best].AngularVelocity);
+	}
+
+	// with a known release time, solve at the release rather than a fixed look-back for latency
+	auto const Newest = FindReleaseSample(ReleaseTime);
+	auto const& Sample = TrackedSamples[ReleaseTime >= 0 ? Newest : FindLookBackSample(Newest)];
+	return ToThrowVelocity(Sample.BufferData, LookDirection, Sample.bHighConfidence, GripOffset);
+}
+
+int32 FThrowSolver::GetThrowVectorCandidates(FVector LookDirection, FVector const* GripOffset, double ReleaseTime,
+	TArray<FThrowVectorCandidate>& OutCandidates) const
+{
+	OutCandidates.Reset();
+	if (TrackedSamples.IsEmpty())
+	{
+		return INDEX_NONE;
+	}
+
+	// the same candidates and scores as the tracked throw, with the shared recency score reported relative to the newest
+	auto const Newest = FindReleaseSample(ReleaseTime);
+	auto const NewestTime = TrackedSamples[Newest].Time;
+	auto const OldestTime = FMath::Max(Settings.OldestPossibleThrowVectorSeconds, UE_KINDA_SMALL_NUMBER);
+	auto const SharedRecencyScore = Settings.ThrowVectorSelectionRecencyScoring * (NewestTime / OldestTime - 1);
+
+	auto Best = INDEX_NONE;
+	auto BestScore = 0.;
+	for (auto i = Newest; i >= 0 && NewestTime - TrackedSamples[i].Time <= Settings.OldestPossibleThrowVectorSeconds; --i)
+	{
+		auto const& Sample = TrackedSamples[i];
+		if (i != Newest && !Sample.bCandidate)
+		{
+			continue;
+		}
+
+		auto const Evaluated = EvaluateCandidate(Sample, LookDirection, GripOffset);
+		auto& Candidate = OutCandidates.AddDefaulted_GetRef();
+		Candidate.SecondsAgo = static_cast<float>(NewestTime - Sample.Time);
+		Candidate.ThrowVector = Evaluated.ThrowVelocity.LinearVelocity;
+		Candidate.AngularVelocity = Evaluated.ThrowVelocity.AngularVelocity;
+		Candidate.Score = static_cast<float>(Evaluated.Score - SharedRecencyScore);
+		Candidate.bReliable = Sample.bHighConfidence;
+
+		// ties go to the newer candidate, as in GetTrackedThrowVelocity
+		if (Best == INDEX_NONE || Evaluated.Score > BestScore)
+		{
+			Best = OutCandidates.Num() - 1;
+			BestScore = Evaluated.Score;
+		}
+	}
+	return Best;
+}
+
+FThrowVelocity FThrowSolver::ToThrowVelocity(FTransformBufferData const& TransformBufferData, FVector LookDirection,
+	bool bHighConfidence, FVector const* GripOffset) const
+{
+#if !UE_BUILD_SHIPPING
+	auto ArrowColor = FColor::Green;
+#endif
+
+	FVector ThrowVector;
+
+	FVector AngularVelocity = FVector::ZeroVector;
+
+	// High confidence throwing
+	if (bHighConfidence)
+	{
+		ThrowVector = TransformBufferData.Velocity;
+		AngularVelocity = TransformBufferData.AngularVelocity;
+
+		// the held point also moves as the hand rotates around it
+		if (GripOffset)
+		{
+			auto const LeverArm = TransformBufferData.Transform.TransformPosition(*GripOffset) - TransformBufferData.Transform.GetLocation();
+			ThrowVector += FVector::CrossProduct(AngularVelocity, LeverArm);
+		}
+	}
+	// Low confidence throwing, if we can get a decent vector from the all transforms buffer
+	else if (TransformBufferData.Velocity.Size() > Settings.LowConfidenceThrowMinSpeed &&
+		FVector::DotProduct(TransformBufferData.Velocity, LookDirection) > 0)
+	{
+		auto const ThrowSpeed = TransformBufferData.Velocity.Size();
+		ThrowVector = TransformBufferData.Velocity.GetSafeNormal() * (1 - Settings.LowConfidenceHeadForwardFactor) +
+			LookDirection * Settings.LowConfidenceHeadForwardFactor;
+		ThrowVector *= ThrowSpeed;
+
+#if !UE_BUILD_SHIPPING
+		ArrowColor = FColor::Yellow;
+#endif
+	}
+	// Very low confidence throwing
+	else
+	{
+		auto const TrackingLossVector = TransformBufferData.Transform.GetLocation() -
+			MostRecentTrackingLossTransform.GetLocation();
+		ThrowVector = TrackingLossVector.GetSafeNormal() * Settings.VeryLowConfidenceVectorFactor +
+			LookDirection * Settings.VeryLowConfidenceHeadForwardFactor;
+		ThrowVector *= TrackingLossVector.Size() * Settings.VeryLowConfidenceSpeedFactor;
+
+#if !UE_BUILD_SHIPPING
+		ArrowColor = FColor::Red;
+#endif
+	}
+
+#if !UE_BUILD_SHIPPING
+
+	if (DebugDrawWorld && CVarDebugDrawThrowingVector.GetValueOnAnyThread() > 0)
+	{
+		DrawDebugDirectionalArrow(
+			DebugDrawWorld,
+			TransformBufferData.Transform.GetLocation(),
+			TransformBufferData.Transform.GetLocation() + ThrowVector * 0.2f,
+			1.0f,
+			ArrowColor,
+			false,
+			4.0f,
+			0,
+			1.f);
+	}
+
+#endif
+
+	return FThrowVelocity(ThrowVector, AngularVelocity);
+}
+
+float FThrowSolver::GetTimeWithGoodTracking(double TimeNow) const
+{
+	if (!bWasTracked)
+	{
+		return 0.f;
+	}
+
+	return TimeNow - MostRecentTrackingGainTime;
+}
+
+double FThrowSolver::GetAimScore(FVector ThrowVector, FVector LookDirection) const
+{
+	// direction relative to the look direction, and speed
+	auto const SizeSquared = ThrowVector.SizeSquared();
+	auto const Size = FMath::Sqrt(SizeSquared);
+	auto const Dot = SizeSquared > UE_SMALL_NUMBER ? FVector::DotProduct(LookDirection, ThrowVector) / Size : 0.;
+
+	auto const DirectionScore = (Dot + 1.) * Settings.ThrowVectorSelectionDirectionScoring / 2.;
+	auto const SpeedScore = FMath::Min(Size, 200.) * Settings.ThrowVectorSelectionSpeedScoring / 200.;
+	return DirectionScore + SpeedScore;
+}
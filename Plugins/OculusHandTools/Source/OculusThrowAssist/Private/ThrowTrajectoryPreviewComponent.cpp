@@ -0,0 +1,85 @@
+// Copyright (c) Meta Platforms, Inc. and affiliates.
+
+#include "ThrowTrajectoryPreviewComponent.h"
+
+#include "Engine/World.h"
+#include "ThrowingComponent.h"
+
+UThrowTrajectoryPreviewComponent::UThrowTrajectoryPreviewComponent()
+{
+	PrimaryComponentTick.bCanEverTick = false;
+}
+
+bool UThrowTrajectoryPreviewComponent::UpdatePreview(FVector StartLocation, FVector LookDirection)
+{
+	if (!ThrowingComponent)
+	{
+		return false;
+	}
+
+	// the throwing component only evaluates new samples, or all of them when the aim moved past the tolerances
+	auto const ThrowVelocity = ThrowingComponent->GetTrackedThrowVelocity(LookDirection, StartLocation,
+		LookDirectionTolerance, LocationTolerance).LinearVelocity;
+
+	if (bHasArc &&
+		FVector::DistSquared(ThrowVelocity, ArcVelocity) <= FMath::Square(VelocityTolerance) &&
+		FVector::DistSquared(StartLocation, ArcStartLocation) <= FMath::Square(LocationTolerance))
+	{
+		return false;
+	}
+
+	ArcStartLocation = StartLocation;
+	ArcVelocity = ThrowVelocity;
+	SimulateArc();
+	bHasArc = true;
+	return true;
+}
+
+void UThrowTrajectoryPreviewComponent::InvalidatePreview()
+{
+	bHasArc = false;
+}
+
+bool UThrowTrajectoryPreviewComponent::GetArcHit(FHitResult& OutHit) const
+{
+	if (bArcHit)
+	{
+		OutHit = ArcHit;
+	}
+	return bArcHit;
+}
+
+void UThrowTrajectoryPreviewComponent::SimulateArc()
+{
+	auto const* const World = GetWorld();
+	auto const Gravity = FVector(0, 0, World->GetGravityZ());
+	auto const Step = FMath::Max(TimeStep, 0.005f);
+	auto const NumSteps = FMath::CeilToInt(MaxSimulationTime / Step);
+
+	ArcPoints.Reset(NumSteps + 1);
+	ArcPoints.Add(ArcStartLocation);
+	bArcHit = false;
+
+	FCollisionQueryParams QueryParams(SCENE_QUERY_STAT(ThrowTrajectoryPreview), false, GetOwner());
+	auto const Shape = TraceRadius > 0 ? FCollisionShape::MakeSphere(TraceRadius) : FCollisionShape();
+
+	// the ballistic step is exact under constant gravity, so the step length only sets the point spacing
+	auto Location = ArcStartLocation;
+	auto Velocity = ArcVelocity;
+	for (auto i = 0; i < NumSteps; ++i)
+	{
+		auto const NextLocation = Location + Velocity * Step + Gravity * (Step * Step / 2);
+		Velocity += Gravity * Step;
+
+		if (bTraceAgainstWorld &&
+			World->SweepSingleByChannel(ArcHit, Location, NextLocation, FQuat::Identity, TraceChannel, Shape, QueryParams))
+		{
+			bArcHit = true;
+			ArcPoints.Add(ArcHit.Location);
+			return;
+		}
+
+		ArcPoints.Add(NextLocation);
+		Location = NextLocation;
+	}
+}
@@ -4,14 +4,7 @@
 
 #include "UObject/UObjectGlobals.h"
 #include "Engine/World.h"
-#include "DrawDebugHelpers.h"
-#include "TransformBufferComponent.h"
-
-static TAutoConsoleVariable<int> CVarDebugDrawThrowingVector(
-	TEXT("throw.DebugDrawThrowingVector"),
-	0,
-	TEXT("Shows throwing vector for camera-tracked hands. 1- draw when throwing. 2- draw always"),
-	ECVF_Cheat);
+#include "Components/PrimitiveComponent.h"
 
 UThrowingComponent::UThrowingComponent()
 {
@@ -20,179 +13,113 @@ UThrowingComponent::UThrowingComponent()
 
 void UThrowingComponent::Initialize(USceneComponent* AttachParent)
 {
-	auto const UniqueName = [&](auto&& Base) { return MakeUniqueObjectName(GetOwner(), UTransformBufferComponent::StaticClass(), Base); };
-	
-	HighConfidenceTransformBuffer = NewObject<UTransformBufferComponent>(GetOwner(), UniqueName(TEXT("HandHighConfidenceTransformBuffer")));
-	HighConfidenceTransformBuffer->RegisterComponent();
-	HighConfidenceTransformBuffer->AttachToComponent(AttachParent, FAttachmentTransformRules::KeepRelativeTransform);
-	HighConfidenceTransformBuffer->UpdateMode = ETransformBufferUpdateMode::Manual;
-	HighConfidenceTransformBuffer->MaxBufferTimeSeconds = 1.f;
-	GetOwner()->AddInstanceComponent(HighConfidenceTransformBuffer);
-	
-	AllTransformsTransformBuffer = NewObject<UTransformBufferComponent>(GetOwner(), UniqueName(TEXT("HandAllTransformsTransformBuffer")));
-	AllTransformsTransformBuffer->RegisterComponent();
-	AllTransformsTransformBuffer->AttachToComponent(AttachParent, FAttachmentTransformRules::KeepRelativeTransform);
-	AllTransformsTransformBuffer->UpdateMode = ETransformBufferUpdateMode::Manual;
-	AllTransformsTransformBuffer->MaxBufferTimeSeconds = 1.f;
-	GetOwner()->AddInstanceComponent(AllTransformsTransformBuffer);
+	TrackedComponent = AttachParent;
+	LastBufferedSampleSequence = INDEX_NONE;
+	ThrowSolver.Reset(VelocityFitWindow, VelocityFitOrder);
+	ThrowSolver.DebugDrawWorld = GetWorld();
 }
 
 void UThrowingComponent::Update(bool IsTracked)
 {
-	if (!HighConfidenceTransformBuffer || !AllTransformsTransformBuffer)
+	if (!TrackedComponent.IsValid())
 	{
 		return;
 	}
 
-	if (IsTracked)
+	SyncSolverSettings();
+	BufferSample(IsTracked);
+	ThrowSolver.UpdateTrackingState(GetWorld()->GetTimeSeconds(), IsTracked);
+}
+
+void UThrowingComponent::UpdateWithTrackingSample(bool IsTracked, int32 SampleSequence)
+{
+	if (!TrackedComponent.IsValid())
 	{
-		HighConfidenceTransformBuffer->BufferCurrentData();
+		return;
 	}
-	AllTransformsTransformBuffer->BufferCurrentData();
 
-	FTransformBufferData TransformBufferDataNow;
-	AllTransformsTransformBuffer->GetBufferData(0, TransformBufferDataNow);
-	if (IsTracked != WasTrackedLastFrame)
+	SyncSolverSettings();
+	if (SampleSequence != LastBufferedSampleSequence)
 	{
-		auto const TimeNow = GetWorld()->GetTimeSeconds();
-
-		if (IsTracked)
-		{
-			MostRecentTrackingGainTime = TimeNow;
-			MostRecentTrackingGainTransform = TransformBufferDataNow.Transform;
-			MostRecentTrackingGainVelocity = TransformBufferDataNow.Velocity;
-		}
-		else
-		{
-			MostRecentTrackingLossTime = TimeNow;
-			MostRecentTrackingLossTransform = TransformBufferDataNow.Transform;
-			MostRecentTrackingLossVelocity = TransformBufferDataNow.Velocity;
-		}
-
-		WasTrackedLastFrame = IsTracked;
+		LastBufferedSampleSequence = SampleSequence;
+		BufferSample(IsTracked);
 	}
+
+	ThrowSolver.UpdateTrackingState(GetWorld()->GetTimeSeconds(), IsTracked);
 }
 
-FVector UThrowingComponent::GetThrowVector(FVector LookDirection) const
+void UThrowingComponent::BufferSample(bool IsTracked)
 {
-	if (bSelectBestThrowVectorFromPast)
-	{
-		auto BestThrowVector = FVector::ZeroVector;
-		auto BestThrowVectorScore = FLT_MIN;
-		check(NumThrowVectorSamples > 0);
-		auto const TimeStep = OldestPossibleThrowVectorSeconds / NumThrowVectorSamples;
-		for (auto i = 0; i < NumThrowVectorSamples; ++i)
-		{
-			auto const TimeInPast = i * TimeStep;
-			auto const ThrowVector = GetThrowVectorInPast(TimeInPast, LookDirection);
-			auto const Score = GetScoreForThrowVector(ThrowVector, LookDirection, i / (float)NumThrowVectorSamples);
-			if (Score > BestThrowVectorScore)
-			{
-				BestThrowVector = ThrowVector;
-				BestThrowVectorScore = Score;
-			}
-		}
-
-		return BestThrowVector;
-	}
-	return GetThrowVectorInPast(ThrowLatencyAdjustmentTimeSeconds, LookDirection);
+	ThrowSolver.AddSample(GetWorld()->GetTimeSeconds(), TrackedComponent->GetComponentTransform(), IsTracked);
+	ThrowSolver.GetSamples().DebugDraw(GetWorld(), ETransformSampleView::All);
 }
 
-FVector UThrowingComponent::GetThrowVectorInPast(float SecondsAgo, FVector LookDirection) const
+FThrowSolverSettings UThrowingComponent::GetSolverSettings() const
 {
-#if !UE_BUILD_SHIPPING
-	auto ArrowColor = FColor::Green;
-#endif
-
-	FVector ThrowVector;
-	FTransformBufferData TransformBufferData;
-
-	auto const TimeWithGoodTracking = GetTimeWithGoodTracking();
+	FThrowSolverSettings Settings;
+	Settings.ThrowLatencyAdjustmentTimeSeconds = ThrowLatencyAdjustmentTimeSeconds;
+	Settings.HighConfidenceThrowMinTrackingTime = HighConfidenceThrowMinTrackingTime;
+	Settings.LowConfidenceThrowMinSpeed = LowConfidenceThrowMinSpeed;
+	Settings.LowConfidenceHeadForwardFactor = LowConfidenceHeadForwardFactor;
+	Settings.VeryLowConfidenceSpeedFactor = VeryLowConfidenceSpeedFactor;
+	Settings.VeryLowConfidenceVectorFactor = VeryLowConfidenceVectorFactor;
+	Settings.VeryLowConfidenceHeadForwardFactor = VeryLowConfidenceHeadForwardFactor;
+	Settings.bSelectBestThrowVectorFromPast = bSelectBestThrowVectorFromPast;
+	Settings.OldestPossibleThrowVectorSeconds = OldestPossibleThrowVectorSeconds;
+	Settings.NumThrowVectorSamples = NumThrowVectorSamples;
+	Settings.ThrowVectorSelectionRecencyScoring = ThrowVectorSelectionRecencyScoring;
+	Settings.ThrowVectorSelectionDirectionScoring = ThrowVectorSelectionDirectionScoring;
+	Settings.ThrowVectorSelectionSpeedScoring = ThrowVectorSelectionSpeedScoring;
+	return Settings;
+}
 
-	// High confidence throwing
-	if (TimeWithGoodTracking >= HighConfidenceThrowMinTrackingTime)
-	{
-		HighConfidenceTransformBuffer->GetBufferData(SecondsAgo, TransformBufferData);
-		ThrowVector = TransformBufferData.Velocity;
-	}
-	else
-	{
-		// check whether we can get a decent vector from the all transforms buffer
-		AllTransformsTransformBuffer->GetBufferData(SecondsAgo, TransformBufferData);
-
-		// Low confidence throwing
-		if (TransformBufferData.Velocity.Size() > LowConfidenceThrowMinSpeed &&
-			FVector::DotProduct(TransformBufferData.Velocity, LookDirection) > 0)
-		{
-			auto const ThrowSpeed = TransformBufferData.Velocity.Size();
-			ThrowVector = TransformBufferData.Velocity.GetSafeNormal() * (1 - LowConfidenceHeadForwardFactor) +
-				LookDirection * LowConfidenceHeadForwardFactor;
-			ThrowVector *= ThrowSpeed;
-
-#if !UE_BUILD_SHIPPING
-			ArrowColor = FColor::Yellow;
-#endif
-		}
-		// Very low confidence throwing
-		else
-		{
-			auto const TrackingLossVector = TransformBufferData.Transform.GetLocation() -
-				MostRecentTrackingLossTransform.GetLocation();
-			ThrowVector = TrackingLossVector.GetSafeNormal() * VeryLowConfidenceVectorFactor +
-				LookDirection * VeryLowConfidenceHeadForwardFactor;
-			ThrowVector *= TrackingLossVector.Size() * VeryLowConfidenceSpeedFactor;
-
-#if !UE_BUILD_SHIPPING
-			ArrowColor = FColor::Red;
-#endif
-		}
-	}
+void UThrowingComponent::SyncSolverSettings() const
+{
+	ThrowSolver.SetSettings(GetSolverSettings());
+}
 
-#if !UE_BUILD_SHIPPING
+FThrowVelocity UThrowingComponent::GetTrackedThrowVelocity(FVector LookDirection, FVector GripLocation,
+	float LookDirectionTolerance, float GripTolerance)
+{
+	SyncSolverSettings();
+	return ThrowSolver.GetTrackedThrowVelocity(LookDirection, GripLocation, LookDirectionTolerance, GripTolerance);
+}
 
-	if (CVarDebugDrawThrowingVector.GetValueOnAnyThread() > 0)
-	{
-		DrawDebugDirectionalArrow(
-			GetWorld(),
-			TransformBufferData.Transform.GetLocation(),
-			TransformBufferData.Transform.GetLocation() + ThrowVector * 0.2f,
-			1.0f,
-			ArrowColor,
-			false,
-			4.0f,
-			0,
-			1.f);
-	}
+FVector UThrowingComponent::GetThrowVector(FVector LookDirection) const
+{
+	SyncSolverSettings();
+	return ThrowSolver.Solve(LookDirection, nullptr, -1).LinearVelocity;
+}
 
-#endif
+FVector UThrowingComponent::GetThrowVectorAtTime(FVector LookDirection, double ReleaseTime) const
+{
+	SyncSolverSettings();
+	return ThrowSolver.Solve(LookDirection, nullptr, ReleaseTime).LinearVelocity;
+}
 
-	return ThrowVector;
+FThrowVelocity UThrowingComponent::GetThrowVelocityAtLocation(FVector LookDirection, FVector GripLocation, double ReleaseTime) const
+{
+	SyncSolverSettings();
+	auto const GripOffset = ThrowSolver.ToGripOffset(GripLocation);
+	return ThrowSolver.Solve(LookDirection, &GripOffset, ReleaseTime);
 }
 
-float UThrowingComponent::GetTimeWithGoodTracking() const
+bool UThrowingComponent::ApplyThrowToComponent(UPrimitiveComponent* Component, FVector LookDirection, FName BoneName,
+	double ReleaseTime) const
 {
-	if (!WasTrackedLastFrame)
+	if (!Component || !Component->IsSimulatingPhysics(BoneName))
 	{
-		return 0.f;
+		return false;
 	}
 
-	auto const TimeNow = GetWorld()->GetTimeSeconds();
-	return TimeNow - MostRecentTrackingGainTime;
+	auto const ThrowVelocity = GetThrowVelocityAtLocation(LookDirection, Component->GetCenterOfMass(BoneName), ReleaseTime);
+	Component->SetPhysicsLinearVelocity(ThrowVelocity.LinearVelocity, false, BoneName);
+	Component->SetPhysicsAngularVelocityInRadians(ThrowVelocity.AngularVelocity, false, BoneName);
+	return true;
 }
 
-float UThrowingComponent::GetScoreForThrowVector(FVector ThrowVector, FVector LookDirection, float TimeInPastNormalized) const
+int32 UThrowingComponent::GetThrowVectorCandidates(FVector LookDirection, TArray<FThrowVectorCandidate>& OutCandidates) const
 {
-	// recency
-	auto const RecencyScore = (1 - TimeInPastNormalized) * ThrowVectorSelectionRecencyScoring;
-
-	// direction
-	auto DirectionScore = FVector::DotProduct(LookDirection, ThrowVector.GetSafeNormal()) / 2.f + 0.5f;
-	DirectionScore *= ThrowVectorSelectionDirectionScoring;
-
-	// speed
-	auto SpeedScore = FMath::GetMappedRangeValueClamped(FVector2D(0, 200), FVector2D(0, 1), ThrowVector.Size());
-	SpeedScore *= ThrowVectorSelectionSpeedScoring;
-
-	return RecencyScore + DirectionScore + SpeedScore;
+	SyncSolverSettings();
+	return ThrowSolver.GetThrowVectorCandidates(LookDirection, nullptr, -1, OutCandidates);
 }
-
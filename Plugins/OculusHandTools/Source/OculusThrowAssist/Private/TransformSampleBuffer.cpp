@@ -0,0 +1,334 @@
+// Copyright (c) Meta Platforms, Inc. and affiliates.
+
+#include "TransformSampleBuffer.h"
+#include "Algo/Reverse.h"
+#include "DrawDebugHelpers.h"
+#include "Engine/World.h"
+#include "Kismet/KismetMathLibrary.h"
+#include "OculusThrowAssistModule.h"
+
+static TAutoConsoleVariable<int> CVarDebugDrawTransformBuffer(
+	TEXT("mnux.DebugDrawTransformBuffer"),
+	0,
+	TEXT("Draws all transforms in the transform buffer"),
+	ECVF_Cheat);
+
+void FTransformSampleBuffer::ConfigureVelocityFit(int32 Window, int32 Order)
+{
+	if (Window != ConfiguredFitWindow || Order != ConfiguredFitOrder)
+	{
+		VelocityFit.Configure(Window, Order);
+		ConfiguredFitWindow = Window;
+		ConfiguredFitOrder = Order;
+	}
+}
+
+bool FTransformSampleBuffer::AddSample(double Timestamp, FTransform const& Transform, bool bHighConfidence)
+{
+	if (NumSamples > 0 && Timestamp <= Timestamps[ToBufferIndex(NumSamples - 1)])
+	{
+		return false;
+	}
+
+	FVector Velocity[static_cast<int32>(ETransformSampleView::Num)];
+	FVector Acceleration[static_cast<int32>(ETransformSampleView::Num)];
+	FVector AngularVelocity[static_cast<int32>(ETransformSampleView::Num)];
+	EstimateMotion(ETransformSampleView::All, Timestamp, Transform, Velocity[0], Acceleration[0], AngularVelocity[0]);
+	Velocity[1] = FVector::ZeroVector;
+	Acceleration[1] = FVector::ZeroVector;
+	AngularVelocity[1] = FVector::ZeroVector;
+	if (bHighConfidence)
+	{
+		EstimateMotion(ETransformSampleView::HighConfidence, Timestamp, Transform, Velocity[1], Acceleration[1], AngularVelocity[1]);
+	}
+
+	// only overwrite the oldest sample once it has fallen out of the buffered time range, so the buffer adapts
+	// to whatever rate samples arrive at
+	if (NumSamples == Timestamps.Num() &&
+		(NumSamples == 0 || Timestamp - Timestamps[ToBufferIndex(0)] <= MaxBufferTimeSeconds))
+	{
+		Grow();
+	}
+
+	Timestamps[NextIndex] = Timestamp;
+	Transforms[NextIndex] = Transform;
+	HighConfidence[NextIndex] = bHighConfidence;
+	for (auto View = 0; View < static_cast<int32>(ETransformSampleView::Num); ++View)
+	{
+		Velocities[View][NextIndex] = Velocity[View];
+		Accelerations[View][NextIndex] = Acceleration[View];
+		AngularVelocities[View][NextIndex] = AngularVelocity[View];
+	}
+	NextIndex = (NextIndex + 1) % Timestamps.Num();
+	NumSamples = FMath::Min(NumSamples + 1, Timestamps.Num());
+	return true;
+}
+
+void FTransformSampleBuffer::Reset()
+{
+	NextIndex = 0;
+	NumSamples = 0;
+}
+
+void FTransformSampleBuffer::EstimateMotion(ETransformSampleView View, double Timestamp, FTransform const& Transform,
+	FVector& OutVelocity, FVector& OutAcceleration, FVector& OutAngularVelocity) const
+{
+	OutVelocity = FVector::ZeroVector;
+	OutAcceleration = FVector::ZeroVector;
+	OutAngularVelocity = FVector::ZeroVector;
+
+	auto const Previous = FindInViewBackward(View, NumSamples - 1);
+	if (Previous == INDEX_NONE)
+	{
+		return;
+	}
+
+	if (VelocityFit.GetWindow() <= 2)
+	{
+		auto const PrevIndex = ToBufferIndex(Previous);
+		auto const Time = Timestamp - Timestamps[PrevIndex];
+		auto const& PrevVelocity = Velocities[static_cast<int32>(View)][PrevIndex];
+		OutVelocity = (Transform.GetLocation() - Transforms[PrevIndex].GetLocation()) / Time;
+		OutAcceleration = FindInViewBackward(View, Previous - 1) != INDEX_NONE ? (OutVelocity - PrevVelocity) / Time : FVector::ZeroVector;
+		OutAngularVelocity = ToRotationVector(Transforms[PrevIndex].GetRotation(), Transform.GetRotation()) / -Time;
+		return;
+	}
+
+	// the fit needs the window as contiguous arrays, oldest first and the new sample last
+	TArray<double, TInlineAllocator<FPolynomialVelocityFit::MaxWindow>> FitTimes;
+	TArray<FVector, TInlineAllocator<FPolynomialVelocityFit::MaxWindow>> FitLocations;
+	TArray<FVector, TInlineAllocator<FPolynomialVelocityFit::MaxWindow>> FitRotations;
+	FitTimes.Add(Timestamp);
+	FitLocations.Add(Transform.GetLocation());
+	FitRotations.Add(FVector::ZeroVector);
+	for (auto Index = Previous; Index != INDEX_NONE && FitTimes.Num() < VelocityFit.GetWindow();
+		Index = FindInViewBackward(View, Index - 1))
+	{
+		auto const BufferIndex = ToBufferIndex(Index);
+		FitTimes.Add(Timestamps[BufferIndex]);
+		FitLocations.Add(Transforms[BufferIndex].GetLocation());
+		FitRotations.Add(ToRotationVector(Transforms[BufferIndex].GetRotation(), Transform.GetRotation()));
+	}
+	Algo::Reverse(FitTimes);
+	Algo::Reverse(FitLocations);
+	Algo::Reverse(FitRotations);
+	VelocityFit.Estimate(FitTimes, FitLocations, OutVelocity, OutAcceleration);
+
+	// the rotations are expressed relative to the new sample, so near it their rate of change is the angular velocity
+	FVector AngularAcceleration;
+	VelocityFit.Estimate(FitTimes, FitRotations, OutAngularVelocity, AngularAcceleration);
+}
+
+FVector FTransformSampleBuffer::ToRotationVector(FQuat const& Rotation, FQuat const& Reference)
+{
+	// world-space rotation from Reference to Rotation, as axis * angle (rad) along the shortest arc
+	auto Delta = Rotation * Reference.Inverse();
+	if (Delta.W < 0)
+	{
+		Delta = -Delta;
+	}
+	return Delta.ToRotationVector();
+}
+
+void FTransformSampleBuffer::Grow()
+{
+	// start out sized for the lowest headset refresh rate, then double
+	auto const MinSampleRate = 72.f;
+	auto const NewCapacity = FMath::Max3(Timestamps.Num() * 2, FMath::CeilToInt(MaxBufferTimeSeconds * MinSampleRate), 2);
+
+	// unwrap the ring so the samples are oldest first; ToBufferIndex can't be used once the first array is resized
+	auto const OldCapacity = Timestamps.Num();
+	auto const Start = NumSamples > 0 ? ToBufferIndex(0) : 0;
+	auto const Unwrap = [this, NewCapacity, OldCapacity, Start](auto& Array)
+	{
+		TArray<typename std::decay_t<decltype(Array)>::ElementType> NewArray;
+		NewArray.SetNumUninitialized(NewCapacity);
+		for (auto i = 0; i < NumSamples; ++i)
+		{
+			NewArray[i] = Array[(Start + i) % OldCapacity];
+		}
+		Array = MoveTemp(NewArray);
+	};
+
+	Unwrap(Timestamps);
+	Unwrap(Transforms);
+	Unwrap(HighConfidence);
+	for (auto View = 0; View < static_cast<int32>(ETransformSampleView::Num); ++View)
+	{
+		Unwrap(Velocities[View]);
+		Unwrap(Accelerations[View]);
+		Unwrap(AngularVelocities[View]);
+	}
+	NextIndex = NumSamples;
+}
+
+int32 FTransformSampleBuffer::FindInViewBackward(ETransformSampleView View, int32 Index) const
+{
+	for (; Index >= 0; --Index)
+	{
+		if (IsInView(View, ToBufferIndex(Index)))
+		{
+			return Index;
+		}
+	}
+	return INDEX_NONE;
+}
+
+int32 FTransformSampleBuffer::FindInViewForward(ETransformSampleView View, int32 Index) const
+{
+	for (; Index < NumSamples; ++Index)
+	{
+		if (IsInView(View, ToBufferIndex(Index)))
+		{
+			return Index;
+		}
+	}
+	return INDEX_NONE;
+}
+
+bool FTransformSampleBuffer::GetNewest(ETransformSampleView View, FTransformBufferData& OutBufferData) const
+{
+	auto const Newest = FindInViewBackward(View, NumSamples - 1);
+	OutBufferData = Newest != INDEX_NONE ? GetBufferData(View, ToBufferIndex(Newest)) : FTransformBufferData();
+	return Newest != INDEX_NONE;
+}
+
+FTransformSampleBuffer::ESampleResult FTransformSampleBuffer::Sample(ETransformSampleView View, double LookupTime,
+	FTransformBufferData& OutBufferData) const
+{
+	auto const Newest = FindInViewBackward(View, NumSamples - 1);
+	if (Newest == INDEX_NONE)
+	{
+		OutBufferData = FTransformBufferData();
+		return ESampleResult::Empty;
+	}
+
+	// check for the case that the most recent buffered value is older than the lookup time
+	auto const NewestIndex = ToBufferIndex(Newest);
+	if (Timestamps[NewestIndex] <= LookupTime)
+	{
+		OutBufferData = GetBufferData(View, NewestIndex);
+		return ESampleResult::TooRecent;
+	}
+
+	// binary search for the oldest sample newer than the lookup time
+	auto First = 0;
+	auto Count = Newest;
+	while (Count > 0)
+	{
+		auto const Step = Count / 2;
+		if (Timestamps[ToBufferIndex(First + Step)] <= LookupTime)
+		{
+			First += Step + 1;
+			Count -= Step + 1;
+		}
+		else
+		{
+			Count = Step;
+		}
+	}
+
+	// then for the samples of the view around it
+	auto const Newer = FindInViewForward(View, First);
+	auto const Older = FindInViewBackward(View, First - 1);
+	auto const NewerIndex = ToBufferIndex(Newer);
+	if (Older == INDEX_NONE)
+	{
+		// return the oldest
+		OutBufferData = GetBufferData(View, NewerIndex);
+		return ESampleResult::TooOld;
+	}
+
+	// interpolate between the pair of buffer values around the lookup time
+	auto const OlderIndex = ToBufferIndex(Older);
+	auto const ViewIndex = static_cast<int32>(View);
+	auto const BufferTime = Timestamps[OlderIndex];
+	auto const NextElementTime = Timestamps[NewerIndex];
+	auto const t = static_cast<float>((LookupTime - BufferTime) / (NextElementTime - BufferTime));
+	auto const Transform = UKismetMathLibrary::TLerp(Transforms[OlderIndex], Transforms[NewerIndex], t);
+	auto const Velocity = FMath::Lerp(Velocities[ViewIndex][OlderIndex], Velocities[ViewIndex][NewerIndex], t);
+	auto const Acceleration = FMath::Lerp(Accelerations[ViewIndex][OlderIndex], Accelerations[ViewIndex][NewerIndex], t);
+	OutBufferData = FTransformBufferData(Transform, Velocity, Acceleration);
+	OutBufferData.AngularVelocity = FMath::Lerp(AngularVelocities[ViewIndex][OlderIndex], AngularVelocities[ViewIndex][NewerIndex], t);
+
+	auto const MaxPeriodForReliableData = 0.1;
+	return NextElementTime - BufferTime < MaxPeriodForReliableData ? ESampleResult::Reliable : ESampleResult::Unreliable;
+}
+
+int32 FTransformSampleBuffer::SampleBatch(ETransformSampleView View, double TimeNow, TConstArrayView<float> SecondsAgo,
+	TArrayView<FTransformBufferData> OutBufferData, TArrayView<bool> OutReliable) const
+{
+	check(OutBufferData.Num() == SecondsAgo.Num());
+	check(OutReliable.Num() == 0 || OutReliable.Num() == SecondsAgo.Num());
+
+	auto NumReliable = 0;
+	auto NumTooRecent = 0;
+	auto NumTooOld = 0;
+	for (auto i = 0; i < SecondsAgo.Num(); ++i)
+	{
+		auto Result = ESampleResult::Reliable;
+		if (SecondsAgo[i] <= 0)
+		{
+			GetNewest(View, OutBufferData[i]);
+		}
+		else
+		{
+			auto const LookupTime = TimeNow - FMath::Min(SecondsAgo[i], MaxBufferTimeSeconds);
+			Result = Sample(View, LookupTime, OutBufferData[i]);
+		}
+
+		NumReliable += Result == ESampleResult::Reliable;
+		NumTooRecent += Result == ESampleResult::TooRecent;
+		NumTooOld += Result == ESampleResult::TooOld || Result == ESampleResult::Empty;
+		if (OutReliable.Num() > 0)
+		{
+			OutReliable[i] = Result == ESampleResult::Reliable;
+		}
+	}
+
+	if (NumTooRecent > 0)
+	{
+		UE_LOG(LogOculusThrowAssist, Warning,
+			TEXT("FTransformSampleBuffer::SampleBatch: No data recent enough for an accurate result."));
+	}
+	if (NumTooOld > 0)
+	{
+		UE_LOG(LogOculusThrowAssist, Warning,
+			TEXT("FTransformSampleBuffer::SampleBatch: No data old enough for an accurate result."));
+	}
+
+	return NumReliable;
+}
+
+void FTransformSampleBuffer::DebugDraw(UWorld const* World, ETransformSampleView View) const
+{
+#if !UE_BUILD_SHIPPING
+	if (CVarDebugDrawTransformBuffer.GetValueOnAnyThread() <= 0)
+	{
+		return;
+	}
+
+	auto const TimeNow = World->GetTimeSeconds();
+	auto const OldestTime = TimeNow - MaxBufferTimeSeconds;
+	auto const MaxScale = 5.0f;
+
+	for (auto const Sample : Iterate(View))
+	{
+		auto const NormalizedTime = FMath::GetMappedRangeValueClamped(
+			FVector2D(OldestTime, TimeNow), FVector2D(0, 1), Sample.Time);
+		auto const Scale = NormalizedTime * MaxScale;
+		DrawDebugCoordinateSystem(World, Sample.Transform.GetLocation(), Sample.Transform.Rotator(), Scale);
+
+		DrawDebugDirectionalArrow(
+			World,
+			Sample.Transform.GetLocation(),
+			Sample.Transform.GetLocation() + Sample.Velocity * 0.2f,
+			1.f,
+			FColor::Orange,
+			false,
+			-1,
+			0,
+			.3f);
+	}
+#endif
+}
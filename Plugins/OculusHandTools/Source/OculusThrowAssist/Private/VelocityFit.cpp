@@ -0,0 +1,163 @@
+// Copyright (c) Meta Platforms, Inc. and affiliates.
+
+#include "VelocityFit.h"
+
+void FPolynomialVelocityFit::Configure(int32 InWindow, int32 InOrder)
+{
+	Window = FMath::Clamp(InWindow, 2, MaxWindow);
+	Order = FMath::Clamp(InOrder, 1, FMath::Min(MaxOrder, Window - 1));
+
+	TArray<double, TInlineAllocator<MaxWindow>> Offsets;
+	for (auto i = 0; i < Window; ++i)
+	{
+		Offsets.Add(i - (Window - 1));
+	}
+	UniformVelocityWeights.SetNumUninitialized(Window);
+	UniformAccelerationWeights.SetNumUninitialized(Window);
+	verify(ComputeWeights(Offsets, Order, UniformVelocityWeights, UniformAccelerationWeights));
+}
+
+bool FPolynomialVelocityFit::Estimate(TConstArrayView<double> Times, TConstArrayView<FVector> Locations,
+	FVector& OutVelocity, FVector& OutAcceleration) const
+{
+	check(Times.Num() == Locations.Num());
+	OutVelocity = FVector::ZeroVector;
+	OutAcceleration = FVector::ZeroVector;
+
+	auto const NumSamples = FMath::Min(Times.Num(), Window);
+	if (NumSamples < 2)
+	{
+		return false;
+	}
+	auto const First = Times.Num() - NumSamples;
+	auto const Newest = Times.Num() - 1;
+	auto const Period = (Times[Newest] - Times[First]) / (NumSamples - 1);
+	if (Period <= UE_DOUBLE_SMALL_NUMBER)
+	{
+		return false;
+	}
+
+	TArray<double, TInlineAllocator<MaxWindow>> Offsets;
+	auto bUniform = NumSamples == Window;
+	for (auto i = 0; i < NumSamples; ++i)
+	{
+		auto const Offset = (Times[First + i] - Times[Newest]) / Period;
+		bUniform &= FMath::Abs(Offset - (i - (NumSamples - 1))) < 0.1;
+		Offsets.Add(Offset);
+	}
+
+	// unevenly spaced samples, or too few of them yet, need their own weights
+	TArray<double, TInlineAllocator<MaxWindow>> VelocityWeights;
+	TArray<double, TInlineAllocator<MaxWindow>> AccelerationWeights;
+	TConstArrayView<double> VelocityWeightsView = UniformVelocityWeights;
+	TConstArrayView<double> AccelerationWeightsView = UniformAccelerationWeights;
+	if (!bUniform)
+	{
+		VelocityWeights.SetNumUninitialized(NumSamples);
+		AccelerationWeights.SetNumUninitialized(NumSamples);
+		if (!ComputeWeights(Offsets, FMath::Min(Order, NumSamples - 1), VelocityWeights, AccelerationWeights))
+		{
+			return false;
+		}
+		VelocityWeightsView = VelocityWeights;
+		AccelerationWeightsView = AccelerationWeights;
+	}
+
+	for (auto i = 0; i < NumSamples; ++i)
+	{
+		OutVelocity += Locations[First + i] * VelocityWeightsView[i];
+		OutAcceleration += Locations[First + i] * AccelerationWeightsView[i];
+	}
+	OutVelocity /= Period;
+	OutAcceleration /= Period * Period;
+	return true;
+}
+
+bool FPolynomialVelocityFit::ComputeWeights(TConstArrayView<double> Offsets, int32 FitOrder,
+	TArrayView<double> OutVelocityWeights, TArrayView<double> OutAccelerationWeights)
+{
+	auto const Size = FitOrder + 1;
+	check(Size <= MaxOrder + 1 && Offsets.Num() >= Size);
+
+	// normal equations of the fit, M = sum of Phi(u) Phi(u)^T with Phi(u) = (1, u, u^2, ...), next to the identity
+	double M[MaxOrder + 1][MaxOrder + 1] = {};
+	double Inverse[MaxOrder + 1][MaxOrder + 1] = {};
+	for (auto const Offset : Offsets)
+	{
+		double Power[2 * MaxOrder + 1];
+		Power[0] = 1;
+		for (auto k = 1; k < 2 * Size - 1; ++k)
+		{
+			Power[k] = Power[k - 1] * Offset;
+		}
+		for (auto Row = 0; Row < Size; ++Row)
+		{
+			for (auto Column = 0; Column < Size; ++Column)
+			{
+				M[Row][Column] += Power[Row + Column];
+			}
+		}
+	}
+	for (auto Row = 0; Row < Size; ++Row)
+	{
+		Inverse[Row][Row] = 1;
+	}
+
+	// Gauss-Jordan elimination with partial pivoting
+	for (auto Column = 0; Column < Size; ++Column)
+	{
+		auto Pivot = Column;
+		for (auto Row = Column + 1; Row < Size; ++Row)
+		{
+			if (FMath::Abs(M[Row][Column]) > FMath::Abs(M[Pivot][Column]))
+			{
+				Pivot = Row;
+			}
+		}
+		if (FMath::Abs(M[Pivot][Column]) < 1e-12)
+		{
+			return false;
+		}
+		for (auto k = 0; k < Size; ++k)
+		{
+			Swap(M[Column][k], M[Pivot][k]);
+			Swap(Inverse[Column][k], Inverse[Pivot][k]);
+		}
+
+		auto const Scale = 1 / M[Column][Column];
+		for (auto k = 0; k < Size; ++k)
+		{
+			M[Column][k] *= Scale;
+			Inverse[Column][k] *= Scale;
+		}
+		for (auto Row = 0; Row < Size; ++Row)
+		{
+			if (Row != Column)
+			{
+				auto const Factor = M[Row][Column];
+				for (auto k = 0; k < Size; ++k)
+				{
+					M[Row][k] -= Factor * M[Column][k];
+					Inverse[Row][k] -= Factor * Inverse[Column][k];
+				}
+			}
+		}
+	}
+
+	// at the newest sample (u = 0) the first derivative is the linear coefficient, the second twice the quadratic one
+	for (auto i = 0; i < Offsets.Num(); ++i)
+	{
+		auto Velocity = 0.;
+		auto Acceleration = 0.;
+		auto Power = 1.;
+		for (auto k = 0; k < Size; ++k)
+		{
+			Velocity += Inverse[1][k] * Power;
+			Acceleration += Size > 2 ? 2 * Inverse[2][k] * Power : 0.;
+			Power *= Offsets[i];
+		}
+		OutVelocityWeights[i] = Velocity;
+		OutAccelerationWeights[i] = Acceleration;
+	}
+	return true;
+}
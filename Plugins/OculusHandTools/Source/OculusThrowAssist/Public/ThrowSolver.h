@@ -0,0 +1,192 @@
+// Copyright (c) Meta Platforms, Inc. and affiliates.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Containers/Deque.h"
+#include "TransformSampleBuffer.h"
+#include "ThrowSolver.generated.h"
+
+/// Linear and angular velocity to release a thrown object with.
+USTRUCT(BlueprintType)
+struct FThrowVelocity
+{
+	GENERATED_BODY()
+
+	FThrowVelocity() = default;
+
+	FThrowVelocity(FVector InLinearVelocity, FVector InAngularVelocity) :
+		LinearVelocity(InLinearVelocity), AngularVelocity(InAngularVelocity)
+	{
+	}
+
+	UPROPERTY(BlueprintReadOnly, Category = "Throwing")
+	FVector LinearVelocity = FVector::ZeroVector;
+
+	/// world-space axis * angular speed (rad/s)
+	UPROPERTY(BlueprintReadOnly, Category = "Throwing")
+	FVector AngularVelocity = FVector::ZeroVector;
+};
+
+/// A throw vector considered by the throw vector selection, see UThrowingComponent::GetThrowVectorCandidates.
+USTRUCT(BlueprintType)
+struct FThrowVectorCandidate
+{
+	GENERATED_BODY()
+
+	/// How far back the candidate was sampled, from the release or the newest sample.
+	UPROPERTY(BlueprintReadOnly, Category = "Throwing")
+	float SecondsAgo = 0.f;
+
+	UPROPERTY(BlueprintReadOnly, Category = "Throwing")
+	FVector ThrowVector = FVector::ZeroVector;
+
+	/// world-space axis * angular speed (rad/s), zero unless tracking was good enough for a high-confidence throw
+	UPROPERTY(BlueprintReadOnly, Category = "Throwing")
+	FVector AngularVelocity = FVector::ZeroVector;
+
+	UPROPERTY(BlueprintReadOnly, Category = "Throwing")
+	float Score = 0.f;
+
+	/// Whether the candidate was solved with high-confidence tracking.
+	UPROPERTY(BlueprintReadOnly, Category = "Throwing")
+	bool bReliable = false;
+};
+
+/// Settings of a FThrowSolver, see the UThrowingComponent properties of the same names.
+struct FThrowSolverSettings
+{
+	float ThrowLatencyAdjustmentTimeSeconds = 0.04f;
+	float HighConfidenceThrowMinTrackingTime = 0.08f;
+	float LowConfidenceThrowMinSpeed = 50.f;
+	float LowConfidenceHeadForwardFactor = 0.4f;
+	float VeryLowConfidenceSpeedFactor = 5.f;
+	float VeryLowConfidenceVectorFactor = 0.3f;
+	float VeryLowConfidenceHeadForwardFactor = 0.7f;
+	bool bSelectBestThrowVectorFromPast = true;
+	float OldestPossibleThrowVectorSeconds = 1.0f;
+	int32 NumThrowVectorSamples = 10;
+	float ThrowVectorSelectionRecencyScoring = 1.0f;
+	float ThrowVectorSelectionDirectionScoring = 1.0f;
+	float ThrowVectorSelectionSpeedScoring = 1.0f;
+
+	bool operator==(FThrowSolverSettings const& Other) const = default;
+};
+
+/**
+ * Solves throws from the buffered transforms of a hand, without reading the world: every time is passed in, so the
+ * same solver runs in game through UThrowingComponent and offline, eg. in the HandTrackingSweep commandlet.
+ */
+class OCULUSTHROWASSIST_API FThrowSolver
+{
+public:
+	/// Removes every sample and tracking state, and configures the velocity fit of the sample buffer.
+	void Reset(int32 VelocityFitWindow, int32 VelocityFitOrder);
+
+	/// Changes the settings, the tracked throw is evaluated again if they differ.
+	void SetSettings(FThrowSolverSettings const& InSettings);
+	FThrowSolverSettings const& GetSettings() const { return Settings; }
+
+	/**
+	 * @brief Buffers a hand transform, newer than every buffered one.
+	 * @param bTracked Whether the transform is considered high quality.
+	 * @return False if the sample wasn't newer and wasn't buffered.
+	 */
+	bool AddSample(double Time, FTransform const& Transform, bool bTracked);
+
+	/// Records tracking being lost or regained, call after AddSample with the same time.
+	void UpdateTrackingState(double Time, bool bTracked);
+
+	/**
+	 * @brief Solves the throw from the buffered samples. Candidates are the samples spaced OldestPossibleThrowVectorSeconds
+	 * / NumThrowVectorSamples apart plus the newest one, each solved with the tracking confidence it arrived with.
+	 * @param GripOffset The point to solve for relative to the newest hand transform, see ToGripOffset, or null to solve
+	 * for the hand.
+	 * @param ReleaseTime Time of the release if known, negative to solve at the newest sample and, without
+	 * bSelectBestThrowVectorFromPast, look back ThrowLatencyAdjustmentTimeSeconds.
+	 */
+	FThrowVelocity Solve(FVector LookDirection, FVector const* GripOffset, double ReleaseTime) const;
+
+	/**
+	 * @brief Evaluates the throw vector candidates considered by Solve when bSelectBestThrowVectorFromPast is set.
+	 * @param OutCandidates Receives the candidates, from the most recent to the oldest.
+	 * @return The index of the best candidate, or INDEX_NONE if there are no samples.
+	 */
+	int32 GetThrowVectorCandidates(FVector LookDirection, FVector const* GripOffset, double ReleaseTime,
+		TArray<FThrowVectorCandidate>& OutCandidates) const;
+
+	/**
+	 * @brief Solve without a release time, kept up to date as samples are buffered, see
+	 * UThrowingComponent::GetTrackedThrowVelocity. The candidates are only evaluated again when the aim moves past the
+	 * tolerances, and match Solve for the aim they were last evaluated with.
+	 */
+	FThrowVelocity GetTrackedThrowVelocity(FVector LookDirection, FVector GripLocation, float LookDirectionTolerance,
+		float GripTolerance);
+
+	/// A world-space grip location relative to the newest hand transform.
+	FVector ToGripOffset(FVector GripLocation) const;
+
+	/// Incremented whenever the inputs of the throw change, ie. a sample was buffered or tracking was lost or regained.
+	int32 GetInputSequence() const { return InputSequence; }
+
+	FTransformSampleBuffer const& GetSamples() const { return TransformSamples; }
+
+	/// Where throw vectors are drawn when throw.DebugDrawThrowingVector is set, null to never draw them.
+	UWorld const* DebugDrawWorld = nullptr;
+
+private:
+	FThrowVelocity ToThrowVelocity(FTransformBufferData const& TransformBufferData, FVector LookDirection, bool bHighConfidence,
+		FVector const* GripOffset) const;
+	double GetAimScore(FVector ThrowVector, FVector LookDirection) const;
+	float GetTimeWithGoodTracking(double TimeNow) const;
+
+	// a buffered sample, with the tracking confidence it was buffered with and whether it is a throw vector candidate
+	struct FTrackedThrowSample
+	{
+		double Time;
+		FTransformBufferData BufferData;
+		bool bHighConfidence;
+		bool bCandidate;
+	};
+
+	// a sample evaluated for an aim; Score leaves out the part of the recency score that all candidates share
+	struct FTrackedThrowCandidate
+	{
+		double Time;
+		double Score;
+		FThrowVelocity ThrowVelocity;
+	};
+
+	FTrackedThrowCandidate EvaluateCandidate(FTrackedThrowSample const& Sample, FVector LookDirection, FVector const* GripOffset) const;
+	int32 FindReleaseSample(double ReleaseTime) const;
+	int32 FindLookBackSample(int32 Newest) const;
+	void TrackSample(double Time);
+	void AddTrackedCandidate(FTrackedThrowSample const& Sample);
+	void RebuildTrackedCandidates();
+
+	FThrowSolverSettings Settings;
+
+	// transforms of the tracked hand, flagged with whether they were tracked with high confidence
+	FTransformSampleBuffer TransformSamples;
+	int32 InputSequence = 0;
+
+	// samples no older than OldestPossibleThrowVectorSeconds, oldest first, those of their candidates that can still
+	// be the best for the tracked aim, best first, and the newest sample evaluated for the tracked aim
+	TDeque<FTrackedThrowSample> TrackedSamples;
+	TDeque<FTrackedThrowCandidate> TrackedCandidates;
+	FTrackedThrowCandidate TrackedNewest;
+	double LastCandidateTime = TNumericLimits<double>::Lowest();
+	FVector TrackedLookDirection = FVector::ZeroVector;
+	FVector TrackedGripOffset = FVector::ZeroVector;
+	bool bHasTrackedAim = false;
+
+	bool bWasTracked = false;
+
+	double MostRecentTrackingLossTime = 0;
+	FTransform MostRecentTrackingLossTransform;
+	FVector MostRecentTrackingLossVelocity = FVector::ZeroVector;
+
+	double MostRecentTrackingGainTime = 0;
+	FTransform MostRecentTrackingGainTransform;
+	FVector MostRecentTrackingGainVelocity = FVector::ZeroVector;
+};
@@ -0,0 +1,95 @@
+// Copyright (c) Meta Platforms, Inc. and affiliates.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Components/ActorComponent.h"
+#include "Engine/EngineTypes.h"
+#include "ThrowTrajectoryPreviewComponent.generated.h"
+
+class UThrowingComponent;
+
+/**
+ * Previews the arc of a throw while an object is held. The throw is kept up to date by the throwing component as its
+ * samples arrive, see UThrowingComponent::GetTrackedThrowVelocity, and the arc is only simulated again when the throw
+ * or the release location moved past a tolerance, so calling UpdatePreview every frame is cheap.
+ */
+UCLASS(ClassGroup=(Custom), meta=(BlueprintSpawnableComponent))
+class OCULUSTHROWASSIST_API UThrowTrajectoryPreviewComponent : public UActorComponent
+{
+	GENERATED_BODY()
+
+public:
+	UThrowTrajectoryPreviewComponent();
+
+	/// The throwing component whose throw is previewed.
+	UPROPERTY(BlueprintReadWrite, Transient, Category = "Throw Preview")
+	UThrowingComponent* ThrowingComponent = nullptr;
+
+	/// Time between arc points (s).
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "Throw Preview", meta = (ClampMin = "0.005"))
+	float TimeStep = 1.f / 30.f;
+
+	/// How long to follow the arc for (s).
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "Throw Preview")
+	float MaxSimulationTime = 2.f;
+
+	/// How much the throw velocity (cm/s) can change before the arc is simulated again.
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "Throw Preview")
+	float VelocityTolerance = 5.f;
+
+	/// How far the look direction (degrees) can turn before the throw vector candidates are evaluated again.
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "Throw Preview", meta = (ClampMin = "0"))
+	float LookDirectionTolerance = 2.f;
+
+	/// How far the release location (cm) can move before the arc is simulated again.
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "Throw Preview")
+	float LocationTolerance = 0.5f;
+
+	/// Whether to stop the arc where it hits the world.
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "Throw Preview")
+	bool bTraceAgainstWorld = true;
+
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "Throw Preview")
+	TEnumAsByte<ECollisionChannel> TraceChannel = ECC_WorldStatic;
+
+	/// Radius of the thrown object for the world traces, 0 for line traces.
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "Throw Preview")
+	float TraceRadius = 0.f;
+
+	/**
+	 * @brief Brings the preview up to date for an object released now.
+	 * @param StartLocation Where the object would be released, eg. its center of mass.
+	 * @param LookDirection The world-space direction the player is looking in (to assist with aiming).
+	 * @return Whether the arc changed.
+	 */
+	UFUNCTION(BlueprintCallable)
+	bool UpdatePreview(FVector StartLocation, FVector LookDirection);
+
+	/// Forces the next UpdatePreview to simulate the arc again.
+	UFUNCTION(BlueprintCallable)
+	void InvalidatePreview();
+
+	/// Points along the arc, from the release location to the end of the arc or the hit location.
+	UFUNCTION(BlueprintPure)
+	TArray<FVector> const& GetArcPoints() const { return ArcPoints; }
+
+	/// Where the arc hits the world, if it does.
+	UFUNCTION(BlueprintPure)
+	bool GetArcHit(FHitResult& OutHit) const;
+
+	/// The throw velocity the arc was simulated with.
+	UFUNCTION(BlueprintPure)
+	FVector GetArcVelocity() const { return ArcVelocity; }
+
+private:
+	void SimulateArc();
+
+	// inputs and result of the last arc simulation, the points are reused from one simulation to the next
+	bool bHasArc = false;
+	FVector ArcStartLocation = FVector::ZeroVector;
+	FVector ArcVelocity = FVector::ZeroVector;
+	TArray<FVector> ArcPoints;
+	FHitResult ArcHit;
+	bool bArcHit = false;
+};
@@ -5,9 +5,10 @@
 #include "CoreMinimal.h"
 
 #include "Components/ActorComponent.h"
+#include "ThrowSolver.h"
 #include "ThrowingComponent.generated.h"
 
-class UTransformBufferComponent;
+class UPrimitiveComponent;
 
 UCLASS(ClassGroup=(Custom), meta=(BlueprintSpawnableComponent))
 class OCULUSTHROWASSIST_API UThrowingComponent : public UActorComponent
@@ -31,6 +32,63 @@ public:
 	UFUNCTION(BlueprintPure)
 	FVector GetThrowVector(FVector LookDirection) const;
 
+	/**
+	 * @brief GetThrowVector for a known release time instead of looking back ThrowLatencyAdjustmentTimeSeconds.
+	 * @param ReleaseTime World time of the release, eg. from UCameraHandInput::OnReleasePredicted.
+	 */
+	UFUNCTION(BlueprintPure)
+	FVector GetThrowVectorAtTime(FVector LookDirection, double ReleaseTime) const;
+
+	/**
+	 * @brief Solves the throw for a point of the held object rather than for the hand, adding the velocity due to the
+	 * hand's rotation around that point. Spin is only transferred with high-confidence tracking.
+	 * @param LookDirection The world-space direction the player is looking in (to assist with aiming).
+	 * @param GripLocation The world-space point to solve for, usually the held object's center of mass.
+	 * @param ReleaseTime World time of the release if known, see GetThrowVectorAtTime, negative otherwise.
+	 */
+	UFUNCTION(BlueprintPure)
+	FThrowVelocity GetThrowVelocityAtLocation(FVector LookDirection, FVector GripLocation, double ReleaseTime = -1.0) const;
+
+	/**
+	 * @brief Solves the throw at the center of mass of a released object and sets its physics velocities right away.
+	 * @param Component The released object, which must already simulate physics.
+	 * @param LookDirection The world-space direction the player is looking in (to assist with aiming).
+	 * @param BoneName The body to throw, for skeletal meshes.
+	 * @param ReleaseTime World time of the release if known, see GetThrowVectorAtTime, negative otherwise.
+	 * @return False if the object does not simulate physics.
+	 */
+	UFUNCTION(BlueprintCallable)
+	bool ApplyThrowToComponent(UPrimitiveComponent* Component, FVector LookDirection, FName BoneName = NAME_None,
+		double ReleaseTime = -1.0) const;
+
+	/**
+	 * @brief GetThrowVelocityAtLocation without a release time, kept up to date as samples are buffered, for callers that
+	 * need the throw every frame such as UThrowTrajectoryPreviewComponent. Each sample is turned into a throw vector
+	 * candidate once, when it is buffered, and the best candidate is kept as they arrive and expire. The candidates are
+	 * only evaluated again when the aim moves past the tolerances or tracking is lost or regained, so the result is the
+	 * one GetThrowVelocityAtLocation returns for the look direction and grip point they were last evaluated with.
+	 * @param LookDirection The world-space direction the player is looking in (to assist with aiming).
+	 * @param GripLocation The world-space point to solve for, usually the held object's center of mass.
+	 * @param LookDirectionTolerance How far (degrees) the look direction can turn before the candidates are evaluated again.
+	 * @param GripTolerance How far (cm) the grip point can move relative to the hand before the candidates are evaluated again.
+	 */
+	UFUNCTION(BlueprintCallable)
+	FThrowVelocity GetTrackedThrowVelocity(FVector LookDirection, FVector GripLocation, float LookDirectionTolerance = 2.f,
+		float GripTolerance = 0.5f);
+
+	/// Incremented whenever the inputs of the throw change, ie. a sample was buffered or tracking was lost or regained.
+	int32 GetThrowInputSequence() const { return ThrowSolver.GetInputSequence(); }
+
+	/**
+	 * @brief Evaluates every throw vector candidate considered when bSelectBestThrowVectorFromPast is set: the buffered
+	 * samples spaced OldestPossibleThrowVectorSeconds / NumThrowVectorSamples apart, and the newest sample.
+	 * @param LookDirection The world-space direction the player is looking in (to assist with aiming).
+	 * @param OutCandidates Receives the candidates, from the most recent to the oldest.
+	 * @return The index of the best candidate, or INDEX_NONE if none scored.
+	 */
+	UFUNCTION(BlueprintCallable)
+	int32 GetThrowVectorCandidates(FVector LookDirection, TArray<FThrowVectorCandidate>& OutCandidates) const;
+
 	/**
 	 * @brief Tick the throw calculator with new info from its parent transform.
 	 * @param IsTracked Whether or not the current data is considered high quality.
@@ -38,10 +96,27 @@ public:
 	UFUNCTION(BlueprintCallable)
 	void Update(bool IsTracked);
 
+	/**
+	 * @brief Tick the throw calculator, only buffering the parent transform when tracking produced a new sample.
+	 * Velocities are then measured between tracking samples rather than between frames.
+	 * @param IsTracked Whether or not the current data is considered high quality.
+	 * @param SampleSequence Tracking sample counter, eg. from HandTrackingFilterComponent::GetTrackingSampleSequence.
+	 */
+	UFUNCTION(BlueprintCallable)
+	void UpdateWithTrackingSample(bool IsTracked, int32 SampleSequence);
+
 	/// How much time to look back in the past when making a throw to account for input and render latency
 	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "Throwing")
 	float ThrowLatencyAdjustmentTimeSeconds = 0.04f;
 
+	/// how many tracking samples the hand velocity is fitted over, see UTransformBufferComponent::VelocityFitWindow (applied on Initialize)
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "Throwing", meta = (ClampMin = 2, ClampMax = 32))
+	int32 VelocityFitWindow = 7;
+
+	/// degree of the polynomial fitted to the hand trajectory, see UTransformBufferComponent::VelocityFitOrder (applied on Initialize)
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "Throwing", meta = (ClampMin = 1, ClampMax = 3))
+	int32 VelocityFitOrder = 2;
+
 	/// minimum amount of time with uninterrupted tracking needed in order to make a high-confidence throw
 	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "Throwing: High Confidence")
 	float HighConfidenceThrowMinTrackingTime = 0.08f;
@@ -67,14 +142,6 @@ public:
 	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "Throwing: Very Low Confidence")
 	float VeryLowConfidenceHeadForwardFactor = 0.7f;
 
-	/// High-confidence transform buffer for the hands
-	UPROPERTY(Transient)
-	UTransformBufferComponent* HighConfidenceTransformBuffer;
-
-	/// Transform buffer for the hands
-	UPROPERTY(Transient)
-	UTransformBufferComponent* AllTransformsTransformBuffer;
-
 	/// Whether to choose the "best" throw vector or just a simple look back.
 	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "Throwing: Throw Vector Selection")
 	bool bSelectBestThrowVectorFromPast = true;
@@ -83,7 +150,7 @@ public:
 	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "Throwing: Throw Vector Selection")
 	float OldestPossibleThrowVectorSeconds = 1.0f;
 
-	/// How many throw vector samples to track.
+	/// How many throw vector samples to track, spread over OldestPossibleThrowVectorSeconds.
 	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "Throwing: Throw Vector Selection")
 	int NumThrowVectorSamples = 10;
 
@@ -99,18 +166,16 @@ public:
 	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "Throwing: Throw Vector Selection")
 	float ThrowVectorSelectionSpeedScoring = 1.0f;
 
-private:
-	FVector GetThrowVectorInPast(float SecondsAgo, FVector LookDirection) const;
-	float GetScoreForThrowVector(FVector ThrowVector, FVector LookDirection, float TimeInPastNormalized) const;
-	float GetTimeWithGoodTracking() const;
+	/// The throw vector selection and confidence properties, as used by the solver.
+	FThrowSolverSettings GetSolverSettings() const;
 
-	bool WasTrackedLastFrame = false;
+private:
+	void SyncSolverSettings() const;
+	void BufferSample(bool IsTracked);
 
-	float MostRecentTrackingLossTime;
-	FTransform MostRecentTrackingLossTransform;
-	FVector MostRecentTrackingLossVelocity;
+	TWeakObjectPtr<USceneComponent> TrackedComponent;
+	int32 LastBufferedSampleSequence = INDEX_NONE;
 
-	float MostRecentTrackingGainTime;
-	FTransform MostRecentTrackingGainTransform;
-	FVector MostRecentTrackingGainVelocity;
+	// the properties are copied into the solver before every use, so that they can be changed at any time
+	mutable FThrowSolver ThrowSolver;
 };
@@ -4,7 +4,7 @@
 
 #include "CoreMinimal.h"
 #include "Components/SceneComponent.h"
-#include "Containers/CircularBuffer.h"
+#include "TransformSampleBuffer.h"
 #include "TransformBufferComponent.generated.h"
 
 UENUM()
@@ -14,25 +14,6 @@ enum class ETransformBufferUpdateMode : uint8
 	EveryFrame
 };
 
-USTRUCT(BlueprintType)
-struct FTransformBufferData
-{
-	GENERATED_BODY()
-
-	FTransformBufferData() :
-		Transform(FTransform::Identity), Velocity(FVector::ZeroVector)
-	{
-	}
-
-	FTransformBufferData(FTransform InTransform, FVector InVelocity) :
-		Transform(InTransform), Velocity(InVelocity)
-	{
-	}
-
-	FTransform Transform;
-	FVector Velocity;
-};
-
 UCLASS(ClassGroup=(Custom), meta=(BlueprintSpawnableComponent))
 class OCULUSTHROWASSIST_API UTransformBufferComponent : public USceneComponent
 {
@@ -49,20 +30,44 @@ public:
 	UPROPERTY(EditAnywhere, Category = "Transform Buffer")
 	float MaxBufferTimeSeconds = 1.0f;
 
+	/// How many of the most recent samples to fit a polynomial to when estimating velocity and acceleration.
+	/// 2 uses the difference between the last two samples, more samples trade latency for less jitter.
+	UPROPERTY(EditAnywhere, Category = "Transform Buffer", meta = (ClampMin = 2, ClampMax = 32))
+	int32 VelocityFitWindow = 2;
+
+	/// Degree of the polynomial fitted over VelocityFitWindow samples, 2 or more also estimates acceleration.
+	UPROPERTY(EditAnywhere, Category = "Transform Buffer", meta = (ClampMin = 1, ClampMax = 3))
+	int32 VelocityFitOrder = 2;
+
 	/// Force an update to the buffer with new data.
 	UFUNCTION(BlueprintCallable)
 	void BufferCurrentData();
 
+	/// Update the buffer only if SampleSequence identifies a tracking sample that hasn't been buffered yet, so that
+	/// velocities are measured between actual tracking samples. Returns true if the sample was buffered.
+	UFUNCTION(BlueprintCallable)
+	bool BufferTrackingSample(int32 SampleSequence);
+
 	virtual void TickComponent(float DeltaTime, enum ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction) override;
 
 	/// Get transform data from the buffer. Returns true if the data can be considered reliable, otherwise false.
 	UFUNCTION(BlueprintCallable)
-	bool GetBufferData(float SecondsAgo, FTransformBufferData& OutBufferData);
+	bool GetBufferData(float SecondsAgo, FTransformBufferData& OutBufferData) const;
 
-private:
-	// buffer size assumes max FPS at 90
-	TCircularBuffer<TTuple<float, FTransformBufferData>> Buffer{(uint32)FMath::CeilToInt(MaxBufferTimeSeconds * 90)};
-	int BufferPosition = 0;
+	/**
+	 * @brief Get transform data for many points in the past at once, sharing a single lookup of the current time.
+	 * @param SecondsAgo How far back to sample, one entry per query.
+	 * @param OutBufferData Receives the sampled data, must be as long as SecondsAgo.
+	 * @param OutReliable Optionally receives whether each sample can be considered reliable.
+	 * @return The number of reliable samples.
+	 */
+	int32 GetBufferDataBatch(TConstArrayView<float> SecondsAgo, TArrayView<FTransformBufferData> OutBufferData,
+		TArrayView<bool> OutReliable = {}) const;
+
+	/// Number of samples currently held in the buffer.
+	int32 GetNumSamples() const { return Samples.Num(); }
 
-	void DebugDrawBuffer() const;
+private:
+	FTransformSampleBuffer Samples;
+	int32 LastBufferedSampleSequence = INDEX_NONE;
 };
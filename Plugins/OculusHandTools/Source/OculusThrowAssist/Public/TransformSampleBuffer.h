@@ -0,0 +1,203 @@
+// Copyright (c) Meta Platforms, Inc. and affiliates.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "VelocityFit.h"
+#include "TransformSampleBuffer.generated.h"
+
+USTRUCT(BlueprintType)
+struct FTransformBufferData
+{
+	GENERATED_BODY()
+
+	FTransformBufferData() :
+		Transform(FTransform::Identity), Velocity(FVector::ZeroVector), Acceleration(FVector::ZeroVector),
+		AngularVelocity(FVector::ZeroVector)
+	{
+	}
+
+	FTransformBufferData(FTransform InTransform, FVector InVelocity, FVector InAcceleration = FVector::ZeroVector,
+		FVector InAngularVelocity = FVector::ZeroVector) :
+		Transform(InTransform), Velocity(InVelocity), Acceleration(InAcceleration), AngularVelocity(InAngularVelocity)
+	{
+	}
+
+	FTransform Transform;
+	FVector Velocity;
+	FVector Acceleration;
+	/// world-space axis * angular speed (rad/s)
+	FVector AngularVelocity;
+};
+
+/// Which samples of a FTransformSampleBuffer to look at.
+enum class ETransformSampleView : uint8
+{
+	/// every sample, with velocities measured between consecutive samples
+	All,
+	/// only samples buffered with high tracking confidence, with velocities measured between those samples
+	HighConfidence,
+	Num
+};
+
+/**
+ * Time-indexed ring buffer of transforms, each tagged with whether it was tracked with high confidence. Every sample is
+ * stored once, and linear and angular velocities are kept for both views so the high-confidence view can skip the
+ * other samples.
+ * The samples are stored as parallel arrays so that time lookups only touch the timestamps. The capacity starts at a
+ * low sample rate and grows whenever it can't hold MaxBufferTimeSeconds of samples.
+ */
+class OCULUSTHROWASSIST_API FTransformSampleBuffer
+{
+public:
+	enum class ESampleResult : uint8
+	{
+		Reliable,
+		Unreliable,
+		TooRecent,
+		TooOld,
+		Empty
+	};
+
+	/// One buffered sample, as returned by the iterators.
+	struct FSample
+	{
+		double Time;
+		FTransform const& Transform;
+		FVector const& Velocity;
+		FVector const& Acceleration;
+		FVector const& AngularVelocity;
+		bool bHighConfidence;
+	};
+
+	/// Iterates the samples of a view from the oldest to the most recent.
+	class FConstIterator
+	{
+	public:
+		FConstIterator(FTransformSampleBuffer const& InBuffer, ETransformSampleView InView, int32 InIndex) :
+			Buffer(InBuffer), View(InView), Index(InIndex)
+		{
+			SkipExcluded();
+		}
+
+		FConstIterator& operator++()
+		{
+			++Index;
+			SkipExcluded();
+			return *this;
+		}
+
+		FSample operator*() const { return Buffer.GetSample(View, Index); }
+		bool operator!=(FConstIterator const& Other) const { return Index != Other.Index; }
+
+	private:
+		void SkipExcluded()
+		{
+			while (Index < Buffer.NumSamples && !Buffer.IsInView(View, Buffer.ToBufferIndex(Index)))
+			{
+				++Index;
+			}
+		}
+
+		FTransformSampleBuffer const& Buffer;
+		ETransformSampleView View;
+		int32 Index;
+	};
+
+	struct FFilteredView
+	{
+		FTransformSampleBuffer const& Buffer;
+		ETransformSampleView View;
+
+		FConstIterator begin() const { return FConstIterator(Buffer, View, 0); }
+		FConstIterator end() const { return FConstIterator(Buffer, View, Buffer.NumSamples); }
+	};
+
+	/// How long to buffer data.
+	float MaxBufferTimeSeconds = 1.f;
+
+	/// See UTransformBufferComponent::VelocityFitWindow and VelocityFitOrder.
+	void ConfigureVelocityFit(int32 Window, int32 Order);
+
+	/// Adds a sample newer than every buffered one. Returns false, without buffering, if Timestamp isn't newer.
+	bool AddSample(double Timestamp, FTransform const& Transform, bool bHighConfidence);
+
+	void Reset();
+
+	/// Samples the view at LookupTime, interpolating between the samples around it.
+	ESampleResult Sample(ETransformSampleView View, double LookupTime, FTransformBufferData& OutBufferData) const;
+
+	/**
+	 * @brief Samples the view at many points in the past at once, logging a single warning for missing data.
+	 * @param TimeNow The time SecondsAgo is relative to. SecondsAgo is clamped to MaxBufferTimeSeconds.
+	 * @param OutBufferData Receives the sampled data, must be as long as SecondsAgo.
+	 * @param OutReliable Optionally receives whether each sample can be considered reliable.
+	 * @return The number of reliable samples.
+	 */
+	int32 SampleBatch(ETransformSampleView View, double TimeNow, TConstArrayView<float> SecondsAgo,
+		TArrayView<FTransformBufferData> OutBufferData, TArrayView<bool> OutReliable = {}) const;
+
+	/// The most recent sample of the view. Returns false if the view has no samples.
+	bool GetNewest(ETransformSampleView View, FTransformBufferData& OutBufferData) const;
+
+	/// The samples in the view, eg. `for (auto const Sample : Buffer.Iterate(ETransformSampleView::HighConfidence))`.
+	FFilteredView Iterate(ETransformSampleView View) const { return FFilteredView{*this, View}; }
+
+	/// Number of samples in the buffer, in any view.
+	int32 Num() const { return NumSamples; }
+
+	/// Draws every sample of the view when mnux.DebugDrawTransformBuffer is set.
+	void DebugDraw(UWorld const* World, ETransformSampleView View) const;
+
+private:
+	friend class FConstIterator;
+
+	bool IsInView(ETransformSampleView View, int32 BufferIndex) const
+	{
+		return View == ETransformSampleView::All || HighConfidence[BufferIndex];
+	}
+
+	FSample GetSample(ETransformSampleView View, int32 Index) const
+	{
+		auto const BufferIndex = ToBufferIndex(Index);
+		auto const ViewIndex = static_cast<int32>(View);
+		return FSample{Timestamps[BufferIndex], Transforms[BufferIndex], Velocities[ViewIndex][BufferIndex],
+			Accelerations[ViewIndex][BufferIndex], AngularVelocities[ViewIndex][BufferIndex], HighConfidence[BufferIndex] != 0};
+	}
+
+	FTransformBufferData GetBufferData(ETransformSampleView View, int32 BufferIndex) const
+	{
+		auto const ViewIndex = static_cast<int32>(View);
+		return FTransformBufferData(Transforms[BufferIndex], Velocities[ViewIndex][BufferIndex], Accelerations[ViewIndex][BufferIndex],
+			AngularVelocities[ViewIndex][BufferIndex]);
+	}
+
+	// ring buffer position of the Index-th oldest sample
+	int32 ToBufferIndex(int32 Index) const
+	{
+		auto const BufferIndex = NextIndex - NumSamples + Index;
+		return BufferIndex < 0 ? BufferIndex + Timestamps.Num() : BufferIndex;
+	}
+
+	// the closest sample in the view at or before, or at or after, the Index-th oldest sample, or INDEX_NONE
+	int32 FindInViewBackward(ETransformSampleView View, int32 Index) const;
+	int32 FindInViewForward(ETransformSampleView View, int32 Index) const;
+
+	void EstimateMotion(ETransformSampleView View, double Timestamp, FTransform const& Transform, FVector& OutVelocity,
+		FVector& OutAcceleration, FVector& OutAngularVelocity) const;
+	static FVector ToRotationVector(FQuat const& Rotation, FQuat const& Reference);
+	void Grow();
+
+	TArray<double> Timestamps;
+	TArray<FTransform> Transforms;
+	TArray<uint8> HighConfidence;
+	TArray<FVector> Velocities[static_cast<int32>(ETransformSampleView::Num)];
+	TArray<FVector> Accelerations[static_cast<int32>(ETransformSampleView::Num)];
+	TArray<FVector> AngularVelocities[static_cast<int32>(ETransformSampleView::Num)];
+	int32 NextIndex = 0;
+	int32 NumSamples = 0;
+
+	FPolynomialVelocityFit VelocityFit;
+	int32 ConfiguredFitWindow = 0;
+	int32 ConfiguredFitOrder = 0;
+};
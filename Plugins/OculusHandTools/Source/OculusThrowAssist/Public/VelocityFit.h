@@ -0,0 +1,41 @@
+// Copyright (c) Meta Platforms, Inc. and affiliates.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+/**
+ * Estimates the velocity and acceleration at the newest of a window of samples by fitting a polynomial to them with
+ * least squares, ie. a causal Savitzky-Golay filter. The fit weights for evenly spaced samples are computed once per
+ * window and order, unevenly spaced samples are fitted directly.
+ */
+class OCULUSTHROWASSIST_API FPolynomialVelocityFit
+{
+public:
+	static constexpr int32 MaxWindow = 32;
+	static constexpr int32 MaxOrder = 3;
+
+	/// Window is the number of samples fitted, Order the degree of the fitted polynomial. Both are clamped to what fits.
+	void Configure(int32 InWindow, int32 InOrder);
+
+	int32 GetWindow() const { return Window; }
+	int32 GetOrder() const { return Order; }
+
+	/**
+	 * @param Times Sample times, oldest first. Only the last GetWindow() samples are used.
+	 * @param Locations Sample locations, matching Times.
+	 * @return False if there are fewer than two distinct samples.
+	 */
+	bool Estimate(TConstArrayView<double> Times, TConstArrayView<FVector> Locations, FVector& OutVelocity,
+		FVector& OutAcceleration) const;
+
+private:
+	// Offsets are sample times relative to the newest sample, in units of the mean sample period
+	static bool ComputeWeights(TConstArrayView<double> Offsets, int32 FitOrder, TArrayView<double> OutVelocityWeights,
+		TArrayView<double> OutAccelerationWeights);
+
+	int32 Window = 2;
+	int32 Order = 1;
+	TArray<double> UniformVelocityWeights;
+	TArray<double> UniformAccelerationWeights;
+};